@@ -0,0 +1,102 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "network.h"
+
+// ============================================================================
+// Capture — Record and Replay Poll Responses
+// ============================================================================
+//
+// CAPTURE_MODE 1 (record) appends every source's raw response of every poll
+// to an append-only log on LittleFS: a fixed header (boot, cycle, time,
+// fetch duration, HTTP code, error, format, encoding, 304 flag) followed by
+// the body as received. A poll that could not start at all (no WiFi, no
+// URL) is kept as a single body-less record. When the log would pass
+// CAPTURE_MAX_BYTES it is rotated, so at most two files (the current one
+// and CAPTURE_PATH_OLD) are kept.
+//
+// The log spans reboots. Each boot takes the next number from a counter
+// file, and cycles are numbered within a boot, so cycles never merge
+// across boots and replay restarts its pacing at every boot boundary
+// (or wherever the recorded clock runs backwards).
+//
+// CAPTURE_MODE 2 (replay) turns the meter into a player: WiFi stays off
+// and the log is fed cycle by cycle through the same parse-and-display
+// path as live polls, at the original pace divided by
+// CAPTURE_REPLAY_SPEED (0 = back to back). Parse and display timings are
+// logged as usual, so a field incident becomes a repeatable run.
+//
+// Sending 'D' over serial in record mode dumps the log as hex between
+// marker lines; `xxd -r -p` turns it back into a file for the data/
+// directory (`pio run -t uploadfs`) of the unit that should replay it.
+
+class Capture {
+public:
+    Capture();
+
+    // Mount LittleFS (formatting it if needed). In record mode this also
+    // counts the boot.
+    bool begin();
+
+    // Append every source result of a poll cycle that began at startedMs
+    void record(const PollResult& result, unsigned long startedMs);
+
+    // Start replaying from the oldest record
+    bool beginReplay();
+
+    // Fill result with the next cycle once it is due. Payloads point into
+    // the capture's buffers and stay valid until the next call.
+    bool nextCycle(PollResult& result);
+
+    // Hex dump of both log files for transfer to a host
+    void dump(Print& out);
+
+    // Delete the log (factory reset)
+    void clear();
+
+private:
+    struct Record {
+        uint32_t magic;
+        uint32_t boot;        // Boot counter at the time of recording
+        uint32_t cycle;       // Poll cycle within that boot
+        uint32_t startedMs;   // millis() when the poll cycle began
+        uint32_t elapsedMs;   // This source's fetch time
+        int16_t httpCode;
+        uint8_t source;
+        uint8_t sourceCount;  // 0 = the poll never started
+        uint8_t format;       // PayloadFormat
+        uint8_t encoding;     // PayloadEncoding
+        uint8_t notModified;
+        uint8_t failedPhase;  // FetchPhase
+        char error[8];        // ERR_* code, "" on success
+        uint32_t length;      // Body bytes that follow
+    } __attribute__((packed));
+
+    bool _mounted;
+    uint32_t _boot;
+    uint32_t _cycle;
+
+    // Replay state
+    File _file;
+    uint8_t _fileIndex;       // 0 = CAPTURE_PATH_OLD, 1 = CAPTURE_PATH
+    Record _pending;
+    bool _hasPending;
+    uint32_t _segmentBoot;    // Pacing restarts when the boot changes...
+    uint32_t _lastStartedMs;  // ...or the recorded clock runs backwards
+    uint32_t _segmentBaseMs;  // Recorded start of the segment's first cycle
+    unsigned long _segmentStart;
+    unsigned long _replayStart;
+    uint32_t _cycles;
+#if CAPTURE_MODE == 2
+    char _payloads[MAX_SOURCES][HTTP_PAYLOAD_MAX + 1];
+    char _errors[MAX_SOURCES][8];
+#endif
+
+    bool _readPending();
+    void _dumpFile(Print& out, const char* path);
+};
+
+#endif // CAPTURE_H
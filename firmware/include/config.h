@@ -29,18 +29,49 @@
 // ---------------------------------------------------------------------------
 // MAX7219 Display Configuration
 // ---------------------------------------------------------------------------
-#define DISPLAY_NUM_DEVICES   4    // 4-in-1 dot matrix module
+// Modules in the chain. 4 = one 4-in-1 module; longer chains (8/12/16,
+// set with -DDISPLAY_NUM_DEVICES=N) switch to the multi-zone layout.
+#ifndef DISPLAY_NUM_DEVICES
+#define DISPLAY_NUM_DEVICES   4
+#endif
+
+// Chains at least this long show cost, tokens, trend (and, from 12
+// modules, a sparkline) side by side in separate zones
+#define DISPLAY_ZONED_MIN_DEVICES  8
 #define HARDWARE_TYPE         MD_MAX72XX::FC16_HW  // Common FC-16 module type
 
 // Display brightness 0–15
 #define DISPLAY_BRIGHTNESS    4
 
+// Brightness while showing a value restored from before the last reboot,
+// until the first fresh poll lands (staleness indicator)
+#define DISPLAY_BRIGHTNESS_STALE  1
+
 // Scroll speed (ms per frame). Lower = faster.
 #define SCROLL_SPEED_MS       35
 
 // Pause time (ms) between scroll cycles
 #define SCROLL_PAUSE_MS       2000
 
+// Carousel page time (ms) on chains shorter than DISPLAY_ZONED_MIN_DEVICES:
+// cost, tokens, input, output, cache and trend take turns, starting with
+// the configured display mode. 0 = off (show only the configured mode).
+#ifndef DISPLAY_PAGE_MS
+#define DISPLAY_PAGE_MS       0
+#endif
+
+// Display diagnostics over serial, off by default (enable with build flags).
+// DISPLAY_FRAME_STATS logs frames/s, SPI bytes per frame and update() CPU
+// time every DISPLAY_STATS_INTERVAL_MS. DISPLAY_FRAME_DUMP also prints every
+// changed frame as ASCII art (one line per LED row), for diffing captures.
+#ifndef DISPLAY_FRAME_STATS
+#define DISPLAY_FRAME_STATS   0
+#endif
+#ifndef DISPLAY_FRAME_DUMP
+#define DISPLAY_FRAME_DUMP    0
+#endif
+#define DISPLAY_STATS_INTERVAL_MS  10000
+
 // ---------------------------------------------------------------------------
 // Network Configuration
 // ---------------------------------------------------------------------------
@@ -52,12 +83,70 @@
 // Polling interval in milliseconds (how often to fetch cost data)
 #define POLL_INTERVAL_MS  60000   // 60 seconds
 
-// HTTP timeout for webhook/API requests (ms)
+// Polls run on a fixed grid of POLL_INTERVAL_MS ticks. Connection setup
+// starts ahead of each tick by the running average of DNS + connect + TLS
+// time plus this margin (ms), so the request itself goes out on the tick.
+#define POLL_WARMUP_MARGIN_MS  200
+#define POLL_WARMUP_MAX_MS     5000
+
+// Weight of each new sample in the phase latency averages: 1 / 2^n
+#define PHASE_EWMA_SHIFT       2
+
+// HTTP timeout for a whole poll cycle (ms)
 #define HTTP_TIMEOUT_MS   10000
 
+// Budget of each phase of a fetch (ms), within HTTP_TIMEOUT_MS. A fetch
+// stops in the first phase that runs out, and its result names that phase.
+#define HTTP_DNS_TIMEOUT_MS         2000   // Name lookup
+#define HTTP_CONNECT_TIMEOUT_MS     2000   // TCP connect (http)
+#define HTTP_TLS_TIMEOUT_MS         4000   // TCP connect + handshake (https)
+#define HTTP_FIRST_BYTE_TIMEOUT_MS  5000   // Request sent to status line
+#define HTTP_BODY_TIMEOUT_MS        5000   // Headers and body
+
+// A fetch stuck in a library call (DNS, TLS) past HTTP_TIMEOUT_MS gets this
+// much longer before the poll completes without it (ms)
+#define HTTP_ABANDON_GRACE_MS       500
+
+// How long a fast reconnect (cached BSSID/channel/IP lease) may take before
+// falling back to a full scan + DHCP via WiFiManager (ms)
+#define FAST_CONNECT_TIMEOUT_MS  3000
+
+// A resolved webhook address (including one cached across reboots) is
+// looked up again once it is this old, so a moved endpoint is followed
+// even while the old address still accepts connections (ms)
+#define HOST_IP_MAX_AGE_MS  3600000UL
+
 // Maximum consecutive network failures before showing E-WIFI
 #define MAX_NET_FAILURES  5
 
+// Maximum response body held in RAM per source (bytes). The buffers are
+// statically allocated; larger responses fail with E-JSON instead of
+// growing the heap.
+#define HTTP_PAYLOAD_MAX  8192
+
+// Offer MessagePack before JSON in the Accept header. Servers that can
+// encode it reply in it (smaller, faster to decode); others send JSON,
+// which is always accepted.
+#define HTTP_ACCEPT_MSGPACK  1
+
+// Offer gzip/deflate in Accept-Encoding (opt-in). Usage reports shrink
+// ~10x on the wire; HTTP_PAYLOAD_MAX then bounds the compressed size. The
+// body is inflated while it is parsed through a 32 KB window, which with
+// the decoder state costs ~43 KB of static RAM when enabled.
+#ifndef HTTP_ACCEPT_GZIP
+#define HTTP_ACCEPT_GZIP     0
+#endif
+
+// Upper bound on the inflated size of a compressed body (bytes), so a
+// hostile or broken server cannot keep the parser busy indefinitely
+#define HTTP_INFLATE_MAX     (512UL * 1024UL)
+
+// Static arena backing every ArduinoJson document (bytes). Filtered usage
+// reports and webhook replies fit comfortably; overflow fails with E-JSON.
+#ifndef JSON_ARENA_SIZE
+#define JSON_ARENA_SIZE   8192
+#endif
+
 // ---------------------------------------------------------------------------
 // n8n Webhook Configuration
 // ---------------------------------------------------------------------------
@@ -66,6 +155,104 @@
 #define PREF_NAMESPACE       "claude_meter"
 #define PREF_KEY_WEBHOOK     "webhook_url"
 #define PREF_KEY_MODE        "display_mode"  // "cost" or "tokens"
+#define PREF_KEY_NET_CACHE   "net_cache"     // Fast-reconnect record (blob)
+#define PREF_KEY_LAST_VALUE  "last_value"    // Last good MeterData (blob)
+
+// Maximum stored webhook URL length (per URL in the captive portal field)
+#define WEBHOOK_URL_MAX      256
+
+// Maximum number of webhooks polled and summed into one reading. Each
+// costs HTTP_PAYLOAD_MAX of RAM, and each distinct host a worker task and
+// a concurrent TLS session while polling.
+#define MAX_SOURCES          4
+
+// ---------------------------------------------------------------------------
+// Last-Known Value
+// ---------------------------------------------------------------------------
+
+// Minimum time between flash writes of the last good reading (ms). RTC
+// memory is updated on every poll regardless.
+#define STORE_FLASH_INTERVAL_MS  (15UL * 60UL * 1000UL)   // 15 minutes
+
+// Restored values older than this are not shown at boot (seconds). Only
+// enforced when the clock survived the reset (soft reset, not power loss).
+#define STORE_MAX_AGE_S          (24UL * 60UL * 60UL)     // 24 hours
+
+// NTP server used to timestamp stored readings
+#define NTP_SERVER               "pool.ntp.org"
+
+// ---------------------------------------------------------------------------
+// Usage Windows
+// ---------------------------------------------------------------------------
+
+// Hours of usage history behind the 1H / DAY / 7D / MTD totals, filled from
+// usage reports with bucket_width=1h. Must cover a month (744); each hour
+// costs 24 bytes of RAM. History starts empty at boot and only fills from
+// the buckets reports bring in: an HTTP_PAYLOAD_MAX body holds a few dozen
+// hourly buckets, not 168 or 744, so 7D and MTD count only the hours seen
+// since boot.
+#define ROLLUP_HOURS         744
+
+// Cycle through the windows automatically every N ms (0 = only when the
+// BOOT button is tapped)
+#define ROLLUP_CYCLE_MS      0
+
+// How long a window's name is shown before its value (ms)
+#define ROLLUP_LABEL_MS      800
+
+// ---------------------------------------------------------------------------
+// LAN Relay
+// ---------------------------------------------------------------------------
+
+// Share one meter's polls with every meter on the LAN configured with the
+// same webhook URLs (see relay.h). Off by default.
+#ifndef RELAY_ENABLED
+#define RELAY_ENABLED          0
+#endif
+
+// Multicast group and port (site-local scope)
+#define RELAY_GROUP            IPAddress(239, 255, 77, 77)
+#define RELAY_PORT             47877
+
+// Leader heartbeat period, and how long followers wait without one before
+// electing a new leader (ms)
+#define RELAY_HEARTBEAT_MS     5000
+#define RELAY_LEADER_TIMEOUT_MS  20000
+
+// Bytes of HMAC-SHA256 kept per datagram
+#define RELAY_MAC_LENGTH       16
+
+// Datagrams stamped further than this from our clock are dropped (seconds)
+#define RELAY_MAX_SKEW_S       120
+
+// ---------------------------------------------------------------------------
+// Diagnostics
+// ---------------------------------------------------------------------------
+
+// Interval between poll statistics reports on serial (ms): latency
+// percentiles, heap drift and time to recovery per error code. Counters run
+// from boot, so a long soak shows its whole history in the last report.
+#define STATS_REPORT_INTERVAL_MS  (60UL * 60UL * 1000UL)   // 1 hour
+
+// ---------------------------------------------------------------------------
+// Capture (record / replay of poll responses, see capture.h)
+// ---------------------------------------------------------------------------
+
+// 0 = off, 1 = record every response to LittleFS, 2 = replay the recording
+// offline through the parser and display instead of polling
+#ifndef CAPTURE_MODE
+#define CAPTURE_MODE         0
+#endif
+
+#define CAPTURE_PATH         "/capture.log"
+#define CAPTURE_PATH_OLD     "/capture.1.log"   // Previous log after rotation
+#define CAPTURE_MAX_BYTES    (256UL * 1024UL)   // Per file; two files at most
+#define CAPTURE_BOOT_PATH    "/capture.boot"    // Boot counter tagging records
+
+// Replay pace as a multiple of the recorded one (0 = no delay between cycles)
+#ifndef CAPTURE_REPLAY_SPEED
+#define CAPTURE_REPLAY_SPEED 1
+#endif
 
 // ---------------------------------------------------------------------------
 // Cost Display
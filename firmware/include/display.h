@@ -5,13 +5,50 @@
 #include <MD_MAX72XX.h>
 #include <SPI.h>
 #include "config.h"
+#include "parser.h"
 
 // ============================================================================
-// Display Manager — MAX7219 4-in-1 Dot Matrix via MD_Parola
+// Display Manager — MAX7219 Dot Matrix Chain via MD_Parola
 // ============================================================================
 //
 // Handles text scrolling, static display, and error code presentation.
 // Uses MD_Parola for smooth text animation and sprite effects.
+//
+// Chains of DISPLAY_ZONED_MIN_DEVICES or more modules are split into
+// MD_Parola zones so one reading can be shown whole (module 0 is the
+// rightmost):
+//
+//   [ cost | tokens | trend arrow | sparkline ]
+//
+// Each zone has its own text and animation state. Only zones whose content
+// changed are re-rendered, and only scrolling zones are restarted when
+// their animation ends, so static zones cost nothing per frame. The
+// sparkline is drawn straight into the column buffer and is not a Parola
+// zone. Status text and errors use the cost zone and blank the rest.
+// Shorter chains use a single zone showing cost or tokens, or, with
+// DISPLAY_PAGE_MS set, a carousel of pages (cost, tokens, input, output,
+// cache, trend). A reading's pages are formatted and rasterized into
+// column buffers once, when it arrives; a page switch then copies one
+// buffer to the matrix and bypasses Parola entirely.
+
+// Parola zones in the multi-zone layout
+enum DisplayZone : uint8_t {
+    ZONE_COST,
+    ZONE_TOKENS,
+    ZONE_TREND,
+    ZONE_COUNT
+};
+
+// Carousel pages in rotation order
+enum CarouselPage : uint8_t {
+    PAGE_COST,
+    PAGE_TOKENS,
+    PAGE_INPUT,
+    PAGE_OUTPUT,
+    PAGE_CACHE,    // Cache creation + cache read tokens
+    PAGE_TREND,
+    PAGE_COUNT
+};
 
 class DisplayManager {
 public:
@@ -38,19 +75,99 @@ public:
     // Show token count with K/M suffix (e.g. "1.2M")
     void showTokens(uint64_t tokens);
 
-    // Show a brief startup animation
+    // Show a full reading across all zones. Only meaningful when
+    // isMultiZone().
+    void showMeter(const MeterData& data);
+
+    // Rotate through every page of a reading, one per DISPLAY_PAGE_MS,
+    // starting at first unless the carousel is already running. Any other
+    // show*() call stops it.
+    void showCarousel(const MeterData& data, CarouselPage first = PAGE_COST);
+
+    // Append a fresh cost to the sparkline (no-op without one). It appears
+    // with the next showMeter().
+    void addSparklinePoint(float costUsd);
+
+    // True if the chain is long enough for the multi-zone layout
+    bool isMultiZone() const;
+
+    // Start a brief startup animation. Non-blocking: update() advances it,
+    // and any other show*() call cuts it short.
     void showBootAnimation();
 
+    // Print the current frame as ASCII art: 8 lines of '#' (lit) and '.'
+    // (dark), leftmost module first
+    void dumpFrame(Print& out);
+
     // Set brightness (0–15)
     void setBrightness(uint8_t level);
 
+    // Mark the shown value as stale (restored from before a reboot).
+    // Stale values are dimmed to DISPLAY_BRIGHTNESS_STALE; status text and
+    // errors always clear the flag.
+    void setStale(bool stale);
+
 private:
     MD_Parola _parola;
-    char _scrollBuf[128];  // Buffer for scrolling text
-    char _staticBuf[32];   // Buffer for static text
+    char _scrollBuf[128];  // Buffer for scrolling text (cost zone)
+    char _staticBuf[32];   // Buffer for static text (cost zone)
+    char _zoneBuf[ZONE_COUNT][24];   // Text of the other zones
     bool _isError;
     unsigned long _errorBlinkTimer;
     bool _errorVisible;
+    bool _stale;
+    uint8_t _bootPhase;            // 0 = idle, 1 = "CLAUDE", 2 = "METER"
+    unsigned long _bootTimer;
+
+    // Zone layout, fixed at construction from DISPLAY_NUM_DEVICES
+    uint8_t _zoneCount;                   // 1, or ZONE_COUNT when zoned
+    uint8_t _zoneModules[ZONE_COUNT];     // Width of each zone in modules
+    uint8_t _sparkModules;                // Rightmost modules (0 = none)
+    bool _zoneScrolls[ZONE_COUNT];        // Restart when animation ends
+
+    // Carousel: every page prerendered, leftmost column first
+    uint8_t _pageFrames[PAGE_COUNT][DISPLAY_NUM_DEVICES * 8];
+    bool _carousel;
+    uint8_t _page;
+    unsigned long _pageTimer;
+
+    // Sparkline: ring buffer of recent costs, one per column
+    float _sparkHistory[DISPLAY_NUM_DEVICES * 8];
+    uint8_t _sparkCount;
+    uint8_t _sparkHead;
+
+    // Put text in a zone: printed if it fits, scrolled otherwise.
+    // scroll forces scrolling. Unchanged text is left alone (not dirty).
+    void _setZoneText(uint8_t zone, const char* text, bool scroll);
+
+    // Blank every zone except the cost zone (status and error text)
+    void _clearSecondaryZones();
+
+    void _drawSparkline();
+
+    // Carousel helpers: stop (blanking the cost zone so Parola and the
+    // screen agree), rasterize text into a page, and show a page
+    void _stopCarousel();
+    void _renderPage(uint8_t* frame, const char* label, const char* value);
+    uint16_t _rasterize(const char* text, uint8_t* cols, uint16_t maxCols);
+    void _showPage();
+
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+    // Frame diagnostics: a frame is any change of the column buffer
+    uint8_t _lastFrame[DISPLAY_NUM_DEVICES * 8];
+    uint32_t _statFrames;
+    uint32_t _statSpiBytes;
+    uint32_t _statUpdateUs;
+    uint32_t _statUpdates;
+    uint32_t _statPageUs;
+    uint32_t _statPageSwitches;
+    unsigned long _statTimer;
+
+    void _update();
+    void _trackFrame(uint32_t updateUs);
+#endif
+
+    void _formatCost(float costUsd, char* buf, size_t bufSize);
 
     // Format large numbers with K/M suffix
     void _formatCompact(uint64_t value, char* buf, size_t bufSize);
@@ -0,0 +1,69 @@
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include <Arduino.h>
+#include "config.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include <esp32s3/rom/miniz.h>
+#else
+#include <esp32/rom/miniz.h>
+#endif
+
+// ============================================================================
+// Inflate Reader — Streaming gzip / deflate Decoder
+// ============================================================================
+//
+// Decompresses a body held in memory on demand, as ArduinoJson pulls bytes
+// through read()/readBytes() (the library's custom reader interface). The
+// decompressed text is never stored whole: output goes round a ring buffer
+// the size of the deflate window, which tinfl (in the ESP32 ROM) also uses
+// as its back-reference dictionary. RAM use is the window plus the decoder
+// state, whatever the inflated size.
+//
+// Accepts gzip (RFC 1952) and "deflate" bodies; the latter are zlib-wrapped
+// per RFC 9110, but raw deflate streams from misbehaving servers are
+// detected and handled too. Checksums are not verified; a corrupt stream
+// fails to inflate or to parse.
+
+class InflateReader {
+public:
+    InflateReader();
+
+    // Start decoding src. gzip selects RFC 1952 framing, otherwise zlib or
+    // raw deflate. Returns false if the header is malformed.
+    bool begin(const uint8_t* src, size_t length, bool gzip);
+
+    // ArduinoJson reader interface: next byte or -1 at the end / on error
+    int read();
+    size_t readBytes(char* buffer, size_t length);
+
+    // True if decoding stopped on corrupt or truncated input, or on
+    // exceeding HTTP_INFLATE_MAX
+    bool failed() const;
+
+    // Decompressed bytes produced so far
+    size_t inflatedBytes() const;
+
+private:
+    tinfl_decompressor _inflator;
+    uint8_t _window[TINFL_LZ_DICT_SIZE];
+
+    const uint8_t* _src;
+    size_t _srcLeft;
+    int _flags;
+
+    size_t _windowOfs;     // Where tinfl writes next
+    size_t _readPos;       // Unread output is [_readPos, _readEnd)
+    size_t _readEnd;
+    size_t _inflated;
+    bool _done;
+    bool _failed;
+
+    // Inflate the next run into the window. False at the end of the stream.
+    bool _fill();
+
+    static size_t _gzipHeaderLength(const uint8_t* src, size_t length);
+};
+
+#endif // INFLATE_H
@@ -4,10 +4,11 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WiFiManager.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
+#include "source.h"
 
 // ============================================================================
 // Network Manager — WiFi Provisioning, TLS, Webhook Polling
@@ -15,21 +16,53 @@
 //
 // Handles:
 //   1. WiFi provisioning via captive portal (WiFiManager)
-//   2. Persistent storage of webhook URL and display mode
-//   3. HTTPS polling of n8n webhook (or direct API)
+//   2. Persistent storage of webhook URLs and display mode
+//   3. HTTPS polling of up to MAX_SOURCES n8n webhooks (or direct API)
 //   4. TLS with root CA validation
+//   5. Fast reconnect after reboot from a cached BSSID, channel, IP lease
+//      and resolved webhook addresses (skips scan, DHCP and DNS)
+//
+// Sources on the same host share one pipelined connection (see source.h).
+// Distinct hosts are fetched concurrently on worker tasks that are created
+// once and parked between polls. A poll cycle therefore takes as long as
+// the slowest host, not the sum of all of them.
+//
+// Polling is asynchronous: startPoll() hands the groups to the workers and
+// returns, and the caller checks pollDone() from its loop while the
+// display keeps running. Every fetch phase has its own budget (see
+// source.h). The poll deadline is HTTP_TIMEOUT_MS after the send time, so
+// a poll completes at most warm-up (up to POLL_WARMUP_MAX_MS, see below)
+// plus HTTP_TIMEOUT_MS plus HTTP_ABANDON_GRACE_MS after startPoll(). A
+// worker still inside a library call by then is reported as timed out in
+// its current phase, and later polls fail until it returns. cancelPoll()
+// stops a poll early.
+//
+// A running average of each source's phase times gives warmupMs(), the
+// expected DNS + connect + TLS time. A caller can start a poll that much
+// before its tick, with the tick as send time, so the requests go out on
+// time on connections that are already open.
+//
+// The poll path is allocation-free; only the TLS stack allocates.
 //
 // Security Model:
 //   - The ESP32 never stores the sk-ant-admin key.
 //   - Credentials are managed by the n8n middleware.
 //   - TLS 1.2+ is enforced for all connections.
 
-// Response from a webhook poll
+// Display mode selected in the captive portal
+enum DisplayMode : uint8_t {
+    MODE_COST,
+    MODE_TOKENS
+};
+
+// Response from a poll of every configured source
 struct PollResult {
-    bool success;
-    int httpCode;
-    String payload;    // Raw JSON body on success
-    String errorMsg;   // Human-readable error on failure
+    bool success;             // True only if every source succeeded
+    int httpCode;             // First failing source's code (0 on success)
+    const char* errorMsg;     // First failing source's ERR_* code
+    uint8_t sourceCount;
+    FetchResult sources[MAX_SOURCES];
+    unsigned long elapsedMs;  // Whole cycle
 };
 
 class NetworkManager {
@@ -40,29 +73,104 @@ public:
     // Returns true if connected to WiFi.
     bool begin();
 
+    // Start a fast reconnect from the cached network record. Non-blocking:
+    // returns true if an attempt was started. Poll isConnected() and fall
+    // back to begin() if it has not connected within FAST_CONNECT_TIMEOUT_MS
+    // or fastConnectFailed() reports an error.
+    bool beginFast();
+
+    // True once the fast-reconnect attempt has been rejected by the AP
+    bool fastConnectFailed();
+
     // Check if WiFi is currently connected
     bool isConnected();
 
-    // Poll the configured webhook URL and return the result.
-    PollResult poll();
+    // Start polling every configured source in the background. Connections
+    // open right away; requests are held until sendAt (0 = now). False if
+    // no poll could be started; pollResult() then holds the reason.
+    bool startPoll(unsigned long sendAt = 0);
+
+    // How long before its send time a poll should start: the slowest
+    // endpoint's average setup time plus POLL_WARMUP_MARGIN_MS
+    unsigned long warmupMs() const;
+
+    // True once the poll started by startPoll() has completed (or none is
+    // running). The first true fills pollResult().
+    bool pollDone();
+
+    // Stop the running poll; pending fetches end as cancelled
+    void cancelPoll();
+
+    // Outcome of the last poll, valid once pollDone()
+    const PollResult& pollResult() const;
+
+    // Number of configured webhook URLs
+    uint8_t getSourceCount() const;
 
-    // Get the stored webhook URL
-    String getWebhookUrl();
+    // Get a stored webhook URL
+    const char* getWebhookUrl(uint8_t source = 0) const;
 
-    // Get the stored display mode ("cost" or "tokens")
-    String getDisplayMode();
+    // Make the next poll of a source fetch a full body (e.g. after the
+    // last one failed to parse)
+    void forgetValidator(uint8_t source);
+
+    // Get the stored display mode
+    DisplayMode getDisplayMode() const;
 
     // Reset stored WiFi credentials and webhook config (factory reset)
     void resetConfig();
 
 private:
+    // Persisted in NVS (survives power cuts, unlike RTC memory). Addresses
+    // are stored as raw uint32_t in network byte order.
+    struct NetCache {
+        uint32_t magic;
+        uint8_t bssid[6];
+        uint8_t channel;
+        uint32_t localIp;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+        uint32_t hostHash[MAX_SOURCES];  // FNV-1a of the host hostIp is for
+        uint32_t hostIp[MAX_SOURCES];
+    };
+
+    // Fetches one endpoint group on its own task
+    struct Worker {
+        TaskHandle_t task;
+        SemaphoreHandle_t start;
+        Source* group[MAX_SOURCES];
+        uint8_t count;
+        unsigned long sendAt;
+        unsigned long deadline;
+        volatile bool busy;     // Set when dispatched, cleared by the task
+    };
+
     WiFiManager _wifiManager;
     Preferences _preferences;
-    WiFiClientSecure _secureClient;
-    WiFiClient _plainClient;
 
-    String _webhookUrl;
-    String _displayMode;
+    Source _sources[MAX_SOURCES];
+    uint8_t _sourceCount;
+    DisplayMode _displayMode;
+    bool _configLoaded;
+    bool _fastAttempted;        // Cached lease is applied statically until
+                                // the first good poll hands it to DHCP
+
+    NetCache _netCache;         // As last loaded from / saved to NVS
+
+    Worker _workers[MAX_SOURCES];
+
+    // Poll in flight
+    PollResult _pollResult;
+    bool _polling;
+    volatile bool _cancel;
+    unsigned long _pollStarted;
+    unsigned long _pollDeadline;
+    uint8_t _groupCount;
+
+    // Running average of each source's phase times (ms)
+    uint16_t _phaseEwmaMs[MAX_SOURCES][PHASE_COUNT];
+    uint8_t _phaseEwmaSeeded;   // Bit per source: averages hold a sample
 
     // Custom WiFiManager parameters
     WiFiManagerParameter* _paramWebhook;
@@ -72,9 +180,29 @@ private:
     static void _saveConfigCallback();
     static NetworkManager* _instance;  // For static callback access
 
+    static void _workerTask(void* arg);
+
     void _loadPreferences();
     void _savePreferences();
-    void _setupTLS();
+    void _loadNetCache();
+    void _updateNetCache();
+
+    // Leave the cached static lease for DHCP after a fast reconnect
+    void _renewLease();
+
+    // Configure sources from a whitespace/comma separated URL list
+    void _setSources(const char* urls);
+
+    // Partition sources into endpoint groups (one per worker slot).
+    // Returns the number of groups.
+    uint8_t _groupSources(unsigned long deadline);
+    bool _ensureWorker(uint8_t index);
+
+    // Collect every source's result into _pollResult
+    void _completePoll();
+
+    // Fold a successful fetch's phase times into the averages
+    void _updatePhaseAverages(uint8_t source, const FetchResult& fetched);
 };
 
 #endif // NETWORK_H
@@ -5,11 +5,13 @@
 #include <ArduinoJson.h>
 #include "config.h"
 
+class Rollup;
+
 // ============================================================================
 // JSON Parser — ArduinoJson Stream Filtering for ESP32 Memory Constraints
 // ============================================================================
 //
-// Two parsing modes:
+// Two response shapes:
 //
 // 1. n8n Webhook Response (lightweight):
 //    {"cost_usd": 12.50, "trend": "up", "tokens_total": 1234567}
@@ -17,8 +19,23 @@
 // 2. Direct Anthropic API Response (heavy, requires filtering):
 //    {"data": [{"results": {"uncached_input_tokens": N, "output_tokens": N, ...}}]}
 //
+// Either shape may arrive as JSON or as MessagePack (same keys, binary
+// encoding). MessagePack is about half the size on the wire and decodes
+// without converting decimal digits; the format follows the response's
+// Content-Type. Bodies sent with Content-Encoding gzip or deflate are
+// inflated on the fly as they are parsed (see inflate.h).
+//
 // The filter-based approach discards ~90% of the raw API payload before
 // deserialization, keeping heap usage well within ESP32 limits.
+//
+// All documents are carved from a static arena that is rewound at the start
+// of every parse, so steady-state parsing never touches the heap. As a
+// consequence the parse functions are not reentrant.
+//
+// Payloads are untrusted. Anything that is not the documented shape (wrong
+// types, negative or fractional counts, a negative or non-finite cost)
+// yields valid = false and thus E-JSON instead of a wrong total. Token sums
+// saturate at UINT64_MAX rather than wrapping.
 
 // Token usage breakdown from the Anthropic API
 struct TokenUsage {
@@ -29,23 +46,45 @@ struct TokenUsage {
     uint64_t totalTokens;  // Computed sum
 };
 
+// Wire encoding of a response body
+enum PayloadFormat : uint8_t {
+    FORMAT_JSON,
+    FORMAT_MSGPACK
+};
+
+// Content-Encoding of a response body
+enum PayloadEncoding : uint8_t {
+    ENCODING_IDENTITY,
+    ENCODING_GZIP,
+    ENCODING_DEFLATE
+};
+
+// Usage trend reported by the webhook
+enum Trend : uint8_t {
+    TREND_FLAT,
+    TREND_UP,
+    TREND_DOWN
+};
+
 // Parsed meter data (common format for both data sources)
 struct MeterData {
     bool valid;
     float costUsd;         // Total cost in USD
-    String trend;          // "up", "down", "flat"
+    Trend trend;
     TokenUsage tokens;
+    uint8_t sourceCount;                // Set by combine()
+    float sourceCostUsd[MAX_SOURCES];   // Per-source breakdown
 };
 
 class Parser {
 public:
-    // Parse a lightweight n8n webhook response
-    // Expected: {"cost_usd": 12.50, "trend": "up", "tokens_total": 1234567}
-    static MeterData parseWebhookResponse(const String& json);
-
-    // Parse a direct Anthropic API usage report response
-    // Uses ArduinoJson filter to minimize RAM usage
-    static MeterData parseAnthropicUsage(const String& json);
+    // Parse either response shape; a top-level "data" array marks a usage
+    // report. Logs the payload size and decode time. If rollup is given,
+    // hourly buckets of a usage report are recorded into it.
+    static MeterData parse(const char* payload, size_t length,
+                           PayloadFormat format = FORMAT_JSON,
+                           PayloadEncoding encoding = ENCODING_IDENTITY,
+                           Rollup* rollup = nullptr);
 
     // Compute cost from token counts using current model rates
     // Rates (per 1M tokens, as of 2025):
@@ -53,9 +92,35 @@ public:
     //   Sonnet: input=$3,   output=$15
     static float computeCost(const TokenUsage& usage, const char* model = "sonnet");
 
+    // Sum readings from several sources into one, keeping each source's
+    // cost as a breakdown. The trend is up/down only if no source disagrees.
+    static MeterData combine(const MeterData* parts, uint8_t count);
+
+    // Name of a trend value ("up", "down", "flat") for logging
+    static const char* trendName(Trend trend);
+
+    // Name of a wire format ("JSON", "MessagePack") for logging
+    static const char* formatName(PayloadFormat format);
+
 private:
-    // Aggregate token fields across all data entries
-    static TokenUsage _sumTokens(JsonArray dataArray);
+    static MeterData _fromWebhook(JsonObjectConst root);
+    static MeterData _fromUsageReport(JsonObjectConst root, Rollup* rollup);
+
+    // Map a webhook "trend" string to its enum value (unknown -> flat)
+    static Trend _parseTrend(const char* text);
+
+    // Aggregate token fields across all data entries, recording hour-wide
+    // entries into rollup if given. False if an entry is malformed.
+    static bool _sumTokens(JsonArrayConst dataArray, TokenUsage& total, Rollup* rollup);
+
+    // Read an optional token count (absent = 0). False if the field is
+    // present but not a non-negative integer.
+    static bool _readCount(JsonObjectConst object, const char* key, uint64_t& out);
+
+    // Overflow-safe token arithmetic
+    static uint64_t _addSaturating(uint64_t a, uint64_t b);
+    static void _accumulate(TokenUsage& total, const TokenUsage& part);
+    static uint64_t _totalOf(const TokenUsage& usage);
 };
 
 #endif // PARSER_H
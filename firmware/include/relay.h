@@ -0,0 +1,114 @@
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "config.h"
+#include "parser.h"
+
+// ============================================================================
+// Relay — Share One Meter's Readings With Its LAN Peers
+// ============================================================================
+//
+// With RELAY_ENABLED, meters configured with the same webhook URLs form a
+// group on the LAN. One of them, the leader, polls upstream and multicasts
+// each reading; the rest (followers) render those and never poll, so a floor
+// of N meters costs upstream one request per interval instead of N.
+//
+// Every datagram carries the leader's latest reading, so a heartbeat every
+// RELAY_HEARTBEAT_MS also brings late joiners up to date. A new leader
+// announces itself at once, flagged as having no reading yet, so the others
+// stop their takeover timers while its first poll is still in flight.
+//
+// Election: the meter with the lowest node ID (from the eFuse MAC) leads.
+// A follower that hears no leader for RELAY_LEADER_TIMEOUT_MS (plus a
+// per-node stagger) promotes itself; a leader that hears a lower ID steps
+// down. Split brain after a partition resolves at the next heartbeat.
+//
+// Authenticity: datagrams are signed with a truncated HMAC-SHA256. The key
+// is derived from the webhook URLs, which already act as the shared secret
+// for upstream access, so only meters that could poll themselves can
+// inject readings. Replays are rejected by a per-boot sequence number and,
+// once both clocks are synced, a timestamp window.
+
+enum RelayEvent : uint8_t {
+    RELAY_IDLE,
+    RELAY_READING,        // A new reading from the leader
+    RELAY_LEADER_ERROR,   // The leader is showing an error (leaderError())
+    RELAY_PROMOTED        // This meter just became leader: poll now
+};
+
+class Relay {
+public:
+    Relay();
+
+    // Derive the group key from the configured webhook URLs
+    void configure(const char* const urls[], uint8_t count);
+
+    // Receive datagrams, run the election and send heartbeats. Call every
+    // loop() while running; joins the multicast group once WiFi is up.
+    // reading is filled in on RELAY_READING.
+    RelayEvent update(MeterData& reading);
+
+    // True if this meter should poll upstream
+    bool isLeader() const;
+
+    // Leader only: multicast a fresh reading / the error being shown
+    void publish(const MeterData& reading);
+    void publishError(const char* errorCode);
+
+    // ERR_* code of the last RELAY_LEADER_ERROR
+    const char* leaderError() const;
+
+private:
+    struct Packet {
+        uint32_t magic;
+        uint32_t group;       // Derived from the key; filters other groups
+        uint32_t nodeId;
+        uint32_t bootId;      // Random per boot, scopes seq
+        uint32_t seq;         // Per datagram
+        uint32_t readingId;   // Per published reading or error
+        uint32_t timestamp;   // Unix time, 0 if the clock is not synced
+        uint8_t error;        // 0 = reading, else 1 + index of the ERR_* code
+        uint8_t trend;
+        uint8_t sourceCount;
+        uint8_t flags;        // RELAY_FLAG_*
+        float costUsd;
+        uint64_t tokens[5];   // Uncached, output, cache write, cache read, total
+        uint8_t mac[RELAY_MAC_LENGTH];
+    } __attribute__((packed));
+
+    WiFiUDP _udp;
+    bool _joined;
+    bool _configured;
+    uint8_t _key[32];
+    uint32_t _group;
+
+    uint32_t _nodeId;
+    uint32_t _bootId;
+    uint32_t _seq;
+    bool _leading;
+    unsigned long _lastHeartbeat;
+
+    // Our latest reading (leader) or the one last received (follower)
+    Packet _current;
+
+    // Leader we follow, and how far into its stream we are
+    uint32_t _leaderId;
+    uint32_t _leaderBoot;
+    uint32_t _leaderSeq;
+    uint32_t _leaderReading;
+    unsigned long _leaderSeen;
+    const char* _leaderError;
+
+    void _announce();
+    void _send();
+    bool _receive(Packet& packet);
+    void _sign(const Packet& packet, uint8_t mac[RELAY_MAC_LENGTH]) const;
+    bool _fresh(const Packet& packet) const;
+
+    static uint8_t _errorIndex(const char* errorCode);
+};
+
+#endif // RELAY_H
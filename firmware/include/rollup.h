@@ -0,0 +1,95 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "parser.h"
+
+// ============================================================================
+// Rollup — Hourly Usage History and Rolling Window Totals
+// ============================================================================
+//
+// Keeps one TokenUsage bucket per UTC hour, filled from usage reports with
+// bucket_width=1h, and the totals of four windows derived from them:
+//
+//   1H   the current hour          DAY  since 00:00 UTC
+//   7D   the last 168 hours        MTD  since the 1st of the month, UTC
+//
+// Totals are maintained incrementally. Recording an hour applies the
+// difference to every window containing it; moving the clock forward
+// subtracts the hours that fall out of the rolling windows and zeroes the
+// calendar windows at their boundaries. Nothing is ever re-summed, so
+// switching windows is free and costs no network traffic.
+//
+// Buckets sit in a ring indexed by hour, ROLLUP_HOURS deep, with 32-bit
+// counters (saturating). History lives in RAM only; after a reboot it is
+// rebuilt from the next usage reports.
+//
+// With several sources, every poll cycle is bracketed by beginCycle(): the
+// first report of an hour in a cycle replaces the bucket, later ones (other
+// sources) add to it.
+
+enum RollupWindow : uint8_t {
+    WINDOW_HOUR,
+    WINDOW_TODAY,
+    WINDOW_WEEK,
+    WINDOW_MONTH,
+    WINDOW_COUNT
+};
+
+class Rollup {
+public:
+    Rollup();
+
+    // Start a poll cycle (see above)
+    void beginCycle();
+
+    // Record usage for the hour starting at hourStart (Unix seconds).
+    // Hours older than the ring are ignored; newer ones advance the clock.
+    void record(uint32_t hourStart, const TokenUsage& usage);
+
+    // Move the clock to now (Unix seconds), evicting expired hours.
+    // Going backwards, or an unsynced clock, is ignored.
+    void advance(uint32_t now);
+
+    // Token totals of a window (totalTokens filled in)
+    TokenUsage total(RollupWindow window) const;
+
+    // True once any hour has been recorded
+    bool hasData() const;
+
+    // Short display name of a window ("1H", "DAY", "7D", "MTD")
+    static const char* windowName(RollupWindow window);
+
+    // Parse the hour of an ISO 8601 UTC timestamp ("2025-06-01T13:00:00Z")
+    // into Unix seconds. False if it is not one.
+    static bool parseTime(const char* text, uint32_t& unixTime);
+
+private:
+    struct Bucket {
+        uint32_t hour;       // Hours since the epoch (0 = empty)
+        uint16_t cycle;      // beginCycle() count when last written
+        uint32_t uncachedInputTokens;
+        uint32_t outputTokens;
+        uint32_t cacheCreationTokens;
+        uint32_t cacheReadTokens;
+    };
+
+    Bucket _buckets[ROLLUP_HOURS];
+    TokenUsage _totals[WINDOW_COUNT];
+    uint32_t _hour;          // Current hour since the epoch
+    uint32_t _dayStart;      // First hour of DAY / MTD
+    uint32_t _monthStart;
+    uint16_t _cycle;
+    bool _hasData;
+
+    bool _inWindow(RollupWindow window, uint32_t hour) const;
+    // Drop hours leaving a rolling window of span hours as the clock moves
+    // to newHour
+    void _evict(RollupWindow window, uint32_t span, uint32_t newHour);
+
+    static void _apply(TokenUsage& total, const Bucket& bucket, bool add);
+    static uint32_t _monthStartHour(uint32_t hour);
+};
+
+#endif // ROLLUP_H
@@ -0,0 +1,198 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include "config.h"
+#include "parser.h"
+
+// ============================================================================
+// Source — One Webhook Endpoint: Connection, Validator State, Buffers
+// ============================================================================
+//
+// Each configured webhook URL is a Source with its own parsed URL, resolved
+// address, TLS client, ETag and fixed request/response buffers.
+//
+// Sources sharing scheme, host and port are fetched as one group over a
+// single connection using HTTP/1.1 pipelining: every request is written
+// back-to-back, then the responses are read in order. One handshake and
+// one round trip cover the whole group. If the server closes early, the
+// remaining requests go out again on a fresh connection.
+//
+// The HTTP client is deliberately small and allocation-free: requests are
+// written from, and responses read into, member buffers. It understands
+// Content-Length, chunked and read-to-close bodies, and conditional GETs
+// (If-None-Match / 304). When HTTP_ACCEPT_MSGPACK is set, requests offer
+// MessagePack ahead of JSON and the body's format follows Content-Type.
+// With HTTP_ACCEPT_GZIP, gzip/deflate are offered too; compressed bodies are
+// stored as received and inflated by the parser.
+//
+// A fetch runs through DNS, connect (or TLS), first byte and body phases,
+// each with its own budget from config.h and all within the group's
+// deadline. Read loops also watch a cancel flag. Lookups and handshakes
+// are single library calls that cannot be interrupted; when one overruns,
+// the fetch stops as soon as it returns. The result records the time spent
+// in each phase and the phase a failed fetch stopped in.
+//
+// A group can be pre-warmed: the connection is set up right away, but the
+// requests are held until a given send time.
+
+// Transport-level failures reported as negative httpCode values
+// (numbering follows HTTPClient's HTTPC_ERROR_* codes)
+#define HTTP_ERR_CONNECT    -1   // TCP connect or TLS handshake failed
+#define HTTP_ERR_SEND       -2   // Request could not be written
+#define HTTP_ERR_CONNECTION_LOST -5   // Peer closed or reset mid-response
+#define HTTP_ERR_PROTOCOL   -7   // Malformed status line, headers or chunking
+#define HTTP_ERR_TOO_LARGE  -8   // Body exceeds HTTP_PAYLOAD_MAX
+#define HTTP_ERR_TIMEOUT   -11   // A phase ran out of budget
+#define HTTP_ERR_CANCELLED -12   // Cancelled by the caller (no HTTPClient equivalent)
+
+// Phases of a fetch, in order
+enum FetchPhase : uint8_t {
+    PHASE_DNS,
+    PHASE_CONNECT,
+    PHASE_TLS,          // https: the TCP connect is part of the handshake call
+    PHASE_FIRST_BYTE,   // Request sent until the status line arrives
+    PHASE_BODY,         // Headers and body
+    PHASE_COUNT         // Also "none": the fetch did not fail
+};
+
+// WiFiClientSecure::connect(ip, port, host, ...) runs its TCP connect with
+// the protected _timeout (30 s by default in core 2.x), which no public
+// setter reaches; the handshake timeout only covers what follows
+class SecureClient : public WiFiClientSecure {
+public:
+    void setConnectTimeout(int ms) { _timeout = ms; }
+};
+
+// Outcome of fetching one source
+struct FetchResult {
+    bool success;
+    bool notModified;         // 304: body unchanged since the last 200
+    int httpCode;
+    const char* payload;      // NUL-terminated body on 200 (owned by the
+                              // Source, valid until its next fetch)
+    size_t payloadLength;
+    PayloadFormat format;     // Encoding of payload, from Content-Type
+    PayloadEncoding encoding; // Compression of payload, from Content-Encoding
+    const char* errorMsg;     // ERR_* code on failure
+    unsigned long elapsedMs;  // From group start to this response, not
+                              // counting a pre-warmed connection's hold
+    FetchPhase failedPhase;   // Phase a failed fetch stopped in, else PHASE_COUNT
+    uint16_t phaseMs[PHASE_COUNT];  // Time spent in each phase
+};
+
+class Source {
+public:
+    Source();
+
+    // Adopt a webhook URL. rootCa is used for https:// endpoints. The URL is
+    // kept even if unusable; isUsable() reports whether it parsed.
+    void configure(const char* url, const char* rootCa);
+
+    // Forget the URL and all connection state
+    void clear();
+
+    const char* url() const;
+    const char* host() const;
+    bool isUsable() const;
+
+    // True if both sources can share one connection
+    bool sameEndpoint(const Source& other) const;
+
+    // Resolved address of host() (0 = resolve on next connect). An address
+    // counts as resolved when set and is re-resolved after HOST_IP_MAX_AGE_MS.
+    IPAddress hostIp() const;
+    void setHostIp(IPAddress ip);
+
+    // Drop the ETag so the next fetch returns a full body
+    void forgetValidator();
+
+    const FetchResult& result() const;
+
+    // Phase of the fetch in progress. Safe to read from another task.
+    FetchPhase phase() const;
+
+    // Fetch a group of sources sharing one endpoint over a single pipelined
+    // connection owned by group[0]. Fills every member's result(). The
+    // requests go out no earlier than sendAt. Stops early once *cancel is
+    // set.
+    static void fetchGroup(Source* group[], size_t count, unsigned long sendAt,
+                           unsigned long deadline, const volatile bool* cancel = nullptr);
+
+    // Name of a phase ("DNS", "connect", ...) for logging
+    static const char* phaseName(FetchPhase phase);
+
+private:
+    char _url[WEBHOOK_URL_MAX + 1];
+    bool _useTls;
+    char _host[128];
+    uint16_t _port;
+    const char* _path;        // Points into _url
+    const char* _rootCa;
+    IPAddress _hostIp;
+    unsigned long _hostIpAt;  // millis() when _hostIp was set
+    char _etag[72];           // Validator from the last 200 ("" = none)
+    char _newEtag[72];        // Validator of the response being read; it
+                              // replaces _etag only once the body is in
+    PayloadFormat _format;    // Body encoding of the response being read
+    PayloadEncoding _encoding;
+
+    SecureClient _secureClient;
+    WiFiClient _plainClient;
+
+    char _requestBuf[WEBHOOK_URL_MAX + 256];
+    char _lineBuf[256];                       // Status line / one header
+    char _payloadBuf[HTTP_PAYLOAD_MAX + 1];   // Response body + NUL
+
+    FetchResult _result;
+
+    // Phase tracking; _phase is PHASE_COUNT between fetches
+    volatile FetchPhase _phase;
+    unsigned long _phaseStarted;
+    uint16_t _phaseMs[PHASE_COUNT];
+    const volatile bool* _cancel;
+
+    Client& _client();
+
+    // Close the current phase's timer and start the next
+    void _enterPhase(FetchPhase phase);
+
+    // When the current phase runs out: its budget, capped by the group's
+    unsigned long _phaseDeadline(unsigned long groupDeadline) const;
+
+    // True once deadline has passed or the fetch was cancelled
+    bool _expired(unsigned long deadline) const;
+
+    // HTTP_ERR_CANCELLED or HTTP_ERR_TIMEOUT, whichever stopped the fetch
+    int _stopCode() const;
+
+    // Connect to host(), preferring the cached address and re-resolving
+    // once if that fails. Returns 0 or an HTTP_ERR_* code.
+    int _connect(unsigned long deadline);
+
+    // Open the connection to _hostIp (TCP, plus TLS for https)
+    int _open(unsigned long deadline);
+
+    bool _sendRequest(Client& client, bool keepAlive);
+
+    // Read one response. Returns the HTTP status or an HTTP_ERR_* code;
+    // keepAlive reports whether the connection can carry the next response.
+    int _readResponse(Client& client, unsigned long deadline, bool& keepAlive);
+
+    void _finish(int httpCode, size_t bodyLength, unsigned long started);
+
+    // The readers stop with HTTP_ERR_CONNECTION_LOST if the peer goes away
+    // first, else with _stopCode() at the deadline
+
+    // One header line into _lineBuf. Returns its length or an HTTP_ERR_* code.
+    int _readLine(Client& client, unsigned long deadline);
+    // Returns 200 once the body is in _payloadBuf, else an HTTP_ERR_* code
+    int _readBody(Client& client, size_t contentLength, bool chunked,
+                  unsigned long deadline, size_t& bodyLength);
+    // Returns 0 once len bytes are in dst, else an HTTP_ERR_* code
+    int _readExact(Client& client, char* dst, size_t len, unsigned long deadline);
+};
+
+#endif // SOURCE_H
@@ -0,0 +1,92 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================================================
+// Poll Stats — Field Diagnostics
+// ============================================================================
+//
+// Tracks, from boot:
+//   1. Poll-cycle latency in a fixed histogram (p50/p90/p99 are read off
+//      the bucket edges, so they are upper bounds)
+//   2. Free heap against the first poll, plus the low-water mark and the
+//      largest free block, to spot leaks and fragmentation
+//   3. Outages per ERR_* code: how often each starts one, and how long
+//      until the next successful poll (time to recovery)
+//   4. Tick-to-display latency: from the poll tick a reading belongs to
+//      until it is on screen, in a histogram like (1)
+//   5. Flash writes of the last-value store, scaled to a daily rate
+//
+// A summary is logged every STATS_REPORT_INTERVAL_MS. Everything is
+// statically sized; recording never allocates.
+
+// Latency histogram bucket upper edges (ms); the last bucket is open-ended
+#define STATS_LATENCY_BUCKETS  14
+
+// ERR_* codes tracked for time to recovery; anything else counts as E-HTTP
+#define STATS_ERROR_CODES      5
+
+class PollStats {
+public:
+    PollStats();
+
+    // Record a finished poll cycle. errorCode is the ERR_* code it failed
+    // with, or nullptr on success.
+    void recordPoll(unsigned long elapsedMs, const char* errorCode);
+
+    // Record a failure detected outside a poll (e.g. WiFi loss)
+    void recordError(const char* errorCode);
+
+    // Record how long after its poll tick a reading reached the display
+    void recordDisplayLatency(unsigned long latencyMs);
+
+    // Record the store's flash write count since boot
+    void recordFlashWrites(uint32_t writes);
+
+    // Log a report when STATS_REPORT_INTERVAL_MS has elapsed
+    void update();
+
+    // Log a report now
+    void report();
+
+private:
+    struct ErrorStats {
+        uint32_t failures;        // Failed polls / events with this code
+        uint32_t outages;         // Outages this code started
+        uint32_t recovered;       // ... of which have recovered
+        uint32_t totalRecoveryMs;
+        uint32_t maxRecoveryMs;
+    };
+
+    uint32_t _latency[STATS_LATENCY_BUCKETS];
+    uint32_t _polls;
+    uint32_t _failedPolls;
+    unsigned long _maxLatencyMs;
+
+    uint32_t _displayLatency[STATS_LATENCY_BUCKETS];
+    uint32_t _displays;
+    unsigned long _maxDisplayMs;
+
+    uint32_t _flashWrites;
+
+    uint32_t _heapBaseline;          // Free heap at the first poll
+    uint32_t _minLargestBlock;
+
+    ErrorStats _errors[STATS_ERROR_CODES];
+    int8_t _outageCode;              // Index of the code that began the outage, -1 if none
+    unsigned long _outageStart;
+
+    unsigned long _lastReport;
+
+    void _recordFailure(const char* errorCode);
+    void _sampleHeap();
+
+    static uint8_t _bucket(unsigned long ms);
+    static unsigned long _percentile(const uint32_t* histogram, uint32_t count,
+                                     unsigned long maxMs, uint8_t pct);
+    static int8_t _errorIndex(const char* errorCode);
+};
+
+#endif // STATS_H
@@ -0,0 +1,54 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config.h"
+#include "parser.h"
+
+// ============================================================================
+// Meter Store — Last-Known Value Persistence
+// ============================================================================
+//
+// Keeps the last good MeterData so it can be shown the moment the device
+// boots, before WiFi or the first poll completes.
+//
+// Two copies are kept:
+//   1. RTC memory — rewritten on every poll, free of flash wear, survives
+//      software resets and crashes but not power loss.
+//   2. NVS — survives power cuts. Writes are coalesced: at most one per
+//      STORE_FLASH_INTERVAL_MS, and only when the value changed.
+//
+// NVS is log-structured: each write appends a new entry and retires the old
+// one, spreading erases across every page of the partition. At the default
+// 15-minute interval that is at most 96 writes/day. A ~64-byte blob takes
+// 3 of a page's 126 entries, so a 5-page partition sees about 0.5 erases per
+// page per day, far inside the 100k-cycle rating.
+
+class MeterStore {
+public:
+    MeterStore();
+
+    // Load the newest valid record (RTC copy first, then NVS).
+    // timestamp is the Unix time of the reading, or 0 if the clock was not
+    // yet synced when it was taken. Returns false if nothing is stored.
+    bool load(MeterData& data, uint32_t& timestamp);
+
+    // Record a fresh reading
+    void save(const MeterData& data);
+
+    // Forget the stored value (factory reset)
+    void clear();
+
+    // Flash writes since boot (for diagnostics)
+    uint32_t flashWrites() const;
+
+private:
+    Preferences _preferences;
+    MeterData _flashData;            // What NVS currently holds
+    bool _flashValid;
+    unsigned long _lastFlashWrite;
+    uint32_t _flashWrites;
+};
+
+#endif // STORE_H
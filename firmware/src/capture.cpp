@@ -0,0 +1,273 @@
+#include "capture.h"
+
+// ============================================================================
+// Capture Implementation
+// ============================================================================
+
+#define CAPTURE_MAGIC  0x32504143   // "CAP2"
+
+Capture::Capture()
+    : _mounted(false)
+    , _boot(0)
+    , _cycle(0)
+    , _fileIndex(0)
+    , _hasPending(false)
+    , _segmentBoot(0)
+    , _lastStartedMs(0)
+    , _segmentBaseMs(0)
+    , _segmentStart(0)
+    , _replayStart(0)
+    , _cycles(0)
+{
+    memset(&_pending, 0, sizeof(_pending));
+}
+
+bool Capture::begin() {
+    _mounted = LittleFS.begin(true);
+    if (!_mounted) {
+        log_e("Capture: LittleFS mount failed");
+        return false;
+    }
+
+#if CAPTURE_MODE == 1
+    File counter = LittleFS.open(CAPTURE_BOOT_PATH, FILE_READ);
+    if (counter) {
+        if (counter.read((uint8_t*)&_boot, sizeof(_boot)) != sizeof(_boot)) {
+            _boot = 0;
+        }
+        counter.close();
+    }
+    _boot++;
+    counter = LittleFS.open(CAPTURE_BOOT_PATH, FILE_WRITE);
+    if (counter) {
+        counter.write((const uint8_t*)&_boot, sizeof(_boot));
+        counter.close();
+    }
+    log_i("Capture: recording boot %u", _boot);
+#endif
+    return true;
+}
+
+void Capture::record(const PollResult& result, unsigned long startedMs) {
+    if (!_mounted) return;
+
+    // A poll that never started still leaves one record with its reason
+    uint8_t records = result.sourceCount > 0 ? result.sourceCount : 1;
+    _cycle++;
+
+    // Rotate rather than grow past the budget
+    size_t cycleBytes = 0;
+    for (uint8_t i = 0; i < records; i++) {
+        cycleBytes += sizeof(Record) + result.sources[i].payloadLength;
+    }
+    File file = LittleFS.open(CAPTURE_PATH, FILE_APPEND);
+    if (!file) {
+        log_e("Capture: cannot open %s", CAPTURE_PATH);
+        return;
+    }
+    if (file.size() > 0 && file.size() + cycleBytes > CAPTURE_MAX_BYTES) {
+        file.close();
+        LittleFS.remove(CAPTURE_PATH_OLD);
+        LittleFS.rename(CAPTURE_PATH, CAPTURE_PATH_OLD);
+        file = LittleFS.open(CAPTURE_PATH, FILE_APPEND);
+        if (!file) return;
+    }
+
+    for (uint8_t i = 0; i < records; i++) {
+        const FetchResult& fetched = result.sources[i];
+        Record rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.magic = CAPTURE_MAGIC;
+        rec.boot = _boot;
+        rec.cycle = _cycle;
+        rec.startedMs = startedMs;
+        rec.elapsedMs = fetched.elapsedMs;
+        rec.httpCode = (int16_t)fetched.httpCode;
+        rec.source = i;
+        rec.sourceCount = result.sourceCount;
+        rec.format = fetched.format;
+        rec.encoding = fetched.encoding;
+        rec.notModified = fetched.notModified;
+        rec.failedPhase = fetched.failedPhase;
+        if (fetched.errorMsg != nullptr) {
+            strlcpy(rec.error, fetched.errorMsg, sizeof(rec.error));
+        }
+        rec.length = fetched.payload != nullptr ? fetched.payloadLength : 0;
+        if (result.sourceCount == 0) {
+            rec.httpCode = (int16_t)result.httpCode;
+            rec.failedPhase = PHASE_COUNT;
+            strlcpy(rec.error, result.errorMsg != nullptr ? result.errorMsg : ERR_HTTP,
+                    sizeof(rec.error));
+            rec.length = 0;
+        }
+
+        file.write((const uint8_t*)&rec, sizeof(rec));
+        if (rec.length > 0) {
+            file.write((const uint8_t*)fetched.payload, rec.length);
+        }
+    }
+    file.close();
+}
+
+bool Capture::beginReplay() {
+    _fileIndex = 0;
+    _hasPending = false;
+    _cycles = 0;
+    _replayStart = millis();
+
+    if (!_mounted || !_readPending()) {
+        log_e("Capture: nothing to replay");
+        return false;
+    }
+
+    _segmentBoot = _pending.boot;
+    _lastStartedMs = _pending.startedMs;
+    _segmentBaseMs = _pending.startedMs;
+    _segmentStart = _replayStart;
+    log_i("Capture: replaying at %ux (0 = no delay)", CAPTURE_REPLAY_SPEED);
+    return true;
+}
+
+bool Capture::nextCycle(PollResult& result) {
+#if CAPTURE_MODE == 2
+    if (!_hasPending) return false;
+
+    // millis() restarts with every boot: pace each boot's cycles (or each
+    // run of them with a steady clock) from its own first cycle
+    if (_pending.boot != _segmentBoot || _pending.startedMs < _lastStartedMs) {
+        _segmentBoot = _pending.boot;
+        _segmentBaseMs = _pending.startedMs;
+        _segmentStart = millis();
+    }
+    _lastStartedMs = _pending.startedMs;
+
+    // Hold each cycle back to its original offset, scaled by the speed
+    if (CAPTURE_REPLAY_SPEED > 0) {
+        uint32_t offset = (_pending.startedMs - _segmentBaseMs) / CAPTURE_REPLAY_SPEED;
+        if (millis() - _segmentStart < offset) return false;
+    }
+
+    memset(&result, 0, sizeof(result));
+    result.success = true;
+    uint32_t boot = _pending.boot;
+    uint32_t cycle = _pending.cycle;
+
+    if (_pending.sourceCount == 0) {
+        // The recorded poll never started: replay its failure as is
+        strlcpy(_errors[0], _pending.error, sizeof(_errors[0]));
+        result.success = false;
+        result.httpCode = _pending.httpCode;
+        result.errorMsg = _errors[0];
+        _readPending();
+    }
+
+    // One cycle = consecutive records of the same boot and cycle number
+    while (_hasPending && _pending.boot == boot && _pending.cycle == cycle &&
+           _pending.sourceCount > 0 && result.sourceCount < MAX_SOURCES) {
+        uint8_t i = result.sourceCount++;
+        FetchResult& fetched = result.sources[i];
+        size_t length = _pending.length;
+
+        if (length > HTTP_PAYLOAD_MAX ||
+            _file.read((uint8_t*)_payloads[i], length) != length) {
+            log_e("Capture: truncated record");
+            result.sourceCount--;
+            _hasPending = false;
+            break;
+        }
+        _payloads[i][length] = '\0';
+        strlcpy(_errors[i], _pending.error, sizeof(_errors[i]));
+
+        fetched.httpCode = _pending.httpCode;
+        fetched.notModified = _pending.notModified != 0;
+        fetched.success = _errors[i][0] == '\0';
+        fetched.payload = length > 0 ? _payloads[i] : nullptr;
+        fetched.payloadLength = length;
+        fetched.format = (PayloadFormat)_pending.format;
+        fetched.encoding = (PayloadEncoding)_pending.encoding;
+        fetched.errorMsg = fetched.success ? nullptr : _errors[i];
+        fetched.elapsedMs = _pending.elapsedMs;
+        fetched.failedPhase = (FetchPhase)_pending.failedPhase;
+
+        if (fetched.elapsedMs > result.elapsedMs) {
+            result.elapsedMs = fetched.elapsedMs;
+        }
+        if (!fetched.success && result.success) {
+            result.success = false;
+            result.httpCode = fetched.httpCode;
+            result.errorMsg = fetched.errorMsg;
+        }
+
+        _readPending();
+    }
+
+    _cycles++;
+    if (!_hasPending) {
+        log_i("Capture: replay finished, %u cycles in %lu ms",
+              _cycles, millis() - _replayStart);
+    }
+    return result.sourceCount > 0 || !result.success;
+#else
+    return false;
+#endif
+}
+
+void Capture::dump(Print& out) {
+    if (!_mounted) return;
+
+    out.println("-----BEGIN CAPTURE-----");
+    _dumpFile(out, CAPTURE_PATH_OLD);
+    _dumpFile(out, CAPTURE_PATH);
+    out.println("-----END CAPTURE-----");
+}
+
+void Capture::clear() {
+    if (!_mounted) return;
+    LittleFS.remove(CAPTURE_PATH_OLD);
+    LittleFS.remove(CAPTURE_PATH);
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+bool Capture::_readPending() {
+    static const char* const paths[] = { CAPTURE_PATH_OLD, CAPTURE_PATH };
+    _hasPending = false;
+
+    while (_fileIndex < 2) {
+        if (!_file) {
+            _file = LittleFS.open(paths[_fileIndex], FILE_READ);
+            if (!_file) {
+                _fileIndex++;
+                continue;
+            }
+        }
+
+        if (_file.read((uint8_t*)&_pending, sizeof(_pending)) == sizeof(_pending) &&
+            _pending.magic == CAPTURE_MAGIC) {
+            _hasPending = true;
+            return true;
+        }
+
+        // End of this file (or a torn write at its tail): next file
+        _file.close();
+        _fileIndex++;
+    }
+    return false;
+}
+
+void Capture::_dumpFile(Print& out, const char* path) {
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) return;
+
+    uint8_t chunk[32];
+    size_t got;
+    while ((got = file.read(chunk, sizeof(chunk))) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            out.printf("%02x", chunk[i]);
+        }
+        out.println();
+    }
+    file.close();
+}
@@ -4,18 +4,82 @@
 // Display Manager Implementation
 // ============================================================================
 
+// Trend arrow glyphs, installed over unused control codes of the trend
+// zone's font. Format: width, then one byte per column (bit 0 = top row).
+#define GLYPH_TREND_UP    '\x01'
+#define GLYPH_TREND_DOWN  '\x02'
+#define GLYPH_TREND_FLAT  '\x03'
+
+static uint8_t glyphTrendUp[]   = { 5, 0x04, 0x02, 0x7F, 0x02, 0x04 };
+static uint8_t glyphTrendDown[] = { 5, 0x10, 0x20, 0x7F, 0x20, 0x10 };
+static uint8_t glyphTrendFlat[] = { 5, 0x08, 0x08, 0x2A, 0x1C, 0x08 };
+
 DisplayManager::DisplayManager()
     : _parola(HARDWARE_TYPE, PIN_SPI_CS, DISPLAY_NUM_DEVICES),
       _isError(false),
       _errorBlinkTimer(0),
-      _errorVisible(true)
+      _errorVisible(true),
+      _stale(false),
+      _bootPhase(0),
+      _bootTimer(0),
+      _zoneCount(1),
+      _sparkModules(0),
+      _carousel(false),
+      _page(0),
+      _pageTimer(0),
+      _sparkCount(0),
+      _sparkHead(0)
 {
     memset(_scrollBuf, 0, sizeof(_scrollBuf));
     memset(_staticBuf, 0, sizeof(_staticBuf));
+    memset(_zoneBuf, 0, sizeof(_zoneBuf));
+    memset(_zoneModules, 0, sizeof(_zoneModules));
+    memset(_zoneScrolls, 0, sizeof(_zoneScrolls));
+    memset(_pageFrames, 0, sizeof(_pageFrames));
+
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+    memset(_lastFrame, 0, sizeof(_lastFrame));
+    _statFrames = 0;
+    _statSpiBytes = 0;
+    _statUpdateUs = 0;
+    _statUpdates = 0;
+    _statPageUs = 0;
+    _statPageSwitches = 0;
+    _statTimer = 0;
+#endif
+
+    _zoneModules[ZONE_COST] = DISPLAY_NUM_DEVICES;
+
+    if (DISPLAY_NUM_DEVICES >= DISPLAY_ZONED_MIN_DEVICES) {
+        // One module for the arrow, a third of the rest for the sparkline
+        // from 12 modules up, and cost/tokens split what remains
+        // (8 → 4|3|1, 12 → 4|4|1|3, 16 → 5|5|1|5)
+        _zoneCount = ZONE_COUNT;
+        _sparkModules = DISPLAY_NUM_DEVICES >= 12 ? (DISPLAY_NUM_DEVICES - 1) / 3 : 0;
+        uint8_t rest = DISPLAY_NUM_DEVICES - 1 - _sparkModules;
+        _zoneModules[ZONE_TREND] = 1;
+        _zoneModules[ZONE_TOKENS] = rest / 2;
+        _zoneModules[ZONE_COST] = rest - rest / 2;
+    }
 }
 
 void DisplayManager::begin() {
-    _parola.begin();
+    _parola.begin(_zoneCount);
+
+    if (isMultiZone()) {
+        // Zones are laid out from module 0 (rightmost) leftwards
+        uint8_t module = _sparkModules;
+        const uint8_t order[] = { ZONE_TREND, ZONE_TOKENS, ZONE_COST };
+        for (uint8_t zone : order) {
+            _parola.setZone(zone, module, module + _zoneModules[zone] - 1);
+            module += _zoneModules[zone];
+        }
+
+        _parola.addChar(ZONE_TREND, GLYPH_TREND_UP, glyphTrendUp);
+        _parola.addChar(ZONE_TREND, GLYPH_TREND_DOWN, glyphTrendDown);
+        _parola.addChar(ZONE_TREND, GLYPH_TREND_FLAT, glyphTrendFlat);
+    }
+
     _parola.setIntensity(DISPLAY_BRIGHTNESS);
     _parola.setTextAlignment(PA_CENTER);
     _parola.setSpeed(SCROLL_SPEED_MS);
@@ -24,108 +88,227 @@ void DisplayManager::begin() {
 }
 
 void DisplayManager::update() {
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+    unsigned long started = micros();
+    _update();
+    _trackFrame(micros() - started);
+}
+
+void DisplayManager::_update() {
+#endif
+    // Boot animation: "CLAUDE" for 1.2 s, then "METER" for 0.8 s
+    if (_bootPhase != 0) {
+        unsigned long elapsed = millis() - _bootTimer;
+        if (_bootPhase == 1 && elapsed >= 1200) {
+            _bootPhase = 2;
+            _bootTimer = millis();
+            _setZoneText(ZONE_COST, "METER", false);
+        } else if (_bootPhase == 2 && elapsed >= 800) {
+            _bootPhase = 0;
+            _setZoneText(ZONE_COST, "", false);
+        }
+        // No return: a name wider than the zone scrolls, so keep animating
+    }
+
     // Handle error blink state
     if (_isError) {
         unsigned long now = millis();
         if (now - _errorBlinkTimer >= 500) {
             _errorBlinkTimer = now;
             _errorVisible = !_errorVisible;
+            _parola.displayClear(ZONE_COST);
             if (_errorVisible) {
-                _parola.setTextAlignment(PA_CENTER);
-                _parola.print(_staticBuf);
-            } else {
-                _parola.displayClear();
+                _parola.displayZoneText(ZONE_COST, _staticBuf, PA_CENTER,
+                                        SCROLL_SPEED_MS, 0, PA_PRINT, PA_NO_EFFECT);
+                _parola.displayAnimate();
             }
         }
         return;
     }
 
-    // Normal Parola animation tick
-    if (_parola.displayAnimate()) {
-        _parola.displayReset();
+    // Carousel: Parola is idle, pages are swapped in whole
+    if (_carousel) {
+#if DISPLAY_PAGE_MS > 0
+        if (millis() - _pageTimer >= DISPLAY_PAGE_MS) {
+            _page = (_page + 1) % PAGE_COUNT;
+            _showPage();
+        }
+#endif
+        return;
+    }
+
+    // Normal Parola animation tick. Static zones sit finished and are not
+    // redrawn; only scrolling zones are restarted after each pass.
+    _parola.displayAnimate();
+    for (uint8_t zone = 0; zone < _zoneCount; zone++) {
+        if (_zoneScrolls[zone] && _parola.getZoneStatus(zone)) {
+            _parola.displayReset(zone);
+        }
     }
 }
 
 void DisplayManager::showStatic(const char* text) {
+    _stopCarousel();
     _isError = false;
-    strncpy(_staticBuf, text, sizeof(_staticBuf) - 1);
-    _staticBuf[sizeof(_staticBuf) - 1] = '\0';
-    _parola.displayClear();
-    _parola.setTextAlignment(PA_CENTER);
-    _parola.print(_staticBuf);
+    _bootPhase = 0;
+    setStale(false);
+    _clearSecondaryZones();
+    _setZoneText(ZONE_COST, text, false);
 }
 
 void DisplayManager::showScrolling(const char* text) {
+    _stopCarousel();
     _isError = false;
-    strncpy(_scrollBuf, text, sizeof(_scrollBuf) - 1);
-    _scrollBuf[sizeof(_scrollBuf) - 1] = '\0';
-    _parola.displayClear();
-    _parola.displayText(_scrollBuf, PA_LEFT, SCROLL_SPEED_MS, SCROLL_PAUSE_MS,
-                        PA_SCROLL_LEFT, PA_SCROLL_LEFT);
+    _bootPhase = 0;
+    setStale(false);
+    _clearSecondaryZones();
+    _setZoneText(ZONE_COST, text, true);
 }
 
 void DisplayManager::showError(const char* errorCode) {
+    _stopCarousel();
     _isError = true;
+    _bootPhase = 0;
+    setStale(false);
     _errorVisible = true;
     _errorBlinkTimer = millis();
+    _clearSecondaryZones();
+
     strncpy(_staticBuf, errorCode, sizeof(_staticBuf) - 1);
     _staticBuf[sizeof(_staticBuf) - 1] = '\0';
-    _parola.displayClear();
-    _parola.setTextAlignment(PA_CENTER);
-    _parola.print(_staticBuf);
+    _zoneScrolls[ZONE_COST] = false;
+    _parola.displayClear(ZONE_COST);
+    _parola.displayZoneText(ZONE_COST, _staticBuf, PA_CENTER,
+                            SCROLL_SPEED_MS, 0, PA_PRINT, PA_NO_EFFECT);
+    _parola.displayAnimate();
 }
 
 void DisplayManager::showCost(float costUsd) {
+    _stopCarousel();
     _isError = false;
-    // Format as "$XX.XX" — fits on 4-module display for values under $1000
-    if (costUsd < 100.0f) {
-        snprintf(_staticBuf, sizeof(_staticBuf), "%s%.2f", COST_PREFIX, costUsd);
-        _parola.displayClear();
-        _parola.setTextAlignment(PA_CENTER);
-        _parola.print(_staticBuf);
-    } else if (costUsd < 10000.0f) {
-        // For larger values, drop decimals
-        snprintf(_staticBuf, sizeof(_staticBuf), "%s%.0f", COST_PREFIX, costUsd);
-        _parola.displayClear();
-        _parola.setTextAlignment(PA_CENTER);
-        _parola.print(_staticBuf);
-    } else {
-        // Scroll very large values
-        snprintf(_scrollBuf, sizeof(_scrollBuf), "%s%.0f", COST_PREFIX, costUsd);
-        _parola.displayClear();
-        _parola.displayText(_scrollBuf, PA_LEFT, SCROLL_SPEED_MS, SCROLL_PAUSE_MS,
-                            PA_SCROLL_LEFT, PA_SCROLL_LEFT);
-    }
+    _bootPhase = 0;
+
+    char text[24];
+    _formatCost(costUsd, text, sizeof(text));
+    _setZoneText(ZONE_COST, text, false);
 }
 
 void DisplayManager::showTokens(uint64_t tokens) {
+    _stopCarousel();
     _isError = false;
-    _formatCompact(tokens, _staticBuf, sizeof(_staticBuf));
+    _bootPhase = 0;
 
-    // Short enough to display statically
-    if (strlen(_staticBuf) <= 8) {
-        _parola.displayClear();
-        _parola.setTextAlignment(PA_CENTER);
-        _parola.print(_staticBuf);
-    } else {
-        strncpy(_scrollBuf, _staticBuf, sizeof(_scrollBuf) - 1);
-        _scrollBuf[sizeof(_scrollBuf) - 1] = '\0';
-        _parola.displayClear();
-        _parola.displayText(_scrollBuf, PA_LEFT, SCROLL_SPEED_MS, SCROLL_PAUSE_MS,
-                            PA_SCROLL_LEFT, PA_SCROLL_LEFT);
+    char text[24];
+    _formatCompact(tokens, text, sizeof(text));
+    _setZoneText(ZONE_COST, text, false);
+}
+
+void DisplayManager::showMeter(const MeterData& data) {
+    _stopCarousel();
+    _isError = false;
+    _bootPhase = 0;
+
+    char text[24];
+    _formatCost(data.costUsd, text, sizeof(text));
+    _setZoneText(ZONE_COST, text, false);
+
+    if (!isMultiZone()) {
+        return;
+    }
+
+    _formatCompact(data.tokens.totalTokens, text, sizeof(text));
+    _setZoneText(ZONE_TOKENS, text, false);
+
+    text[0] = data.trend == TREND_UP   ? GLYPH_TREND_UP
+            : data.trend == TREND_DOWN ? GLYPH_TREND_DOWN
+            : GLYPH_TREND_FLAT;
+    text[1] = '\0';
+    _setZoneText(ZONE_TREND, text, false);
+
+    // Status text may have blanked it
+    if (_sparkModules > 0) {
+        _drawSparkline();
     }
 }
 
+void DisplayManager::showCarousel(const MeterData& data, CarouselPage first) {
+    if (isMultiZone()) {
+        // Everything is on screen already
+        showMeter(data);
+        return;
+    }
+
+    _isError = false;
+    _bootPhase = 0;
+
+    // All formatting and layout happens here, once per reading
+    char text[24];
+    _formatCost(data.costUsd, text, sizeof(text));
+    _renderPage(_pageFrames[PAGE_COST], nullptr, text);
+    _formatCompact(data.tokens.totalTokens, text, sizeof(text));
+    _renderPage(_pageFrames[PAGE_TOKENS], nullptr, text);
+    _formatCompact(data.tokens.uncachedInputTokens, text, sizeof(text));
+    _renderPage(_pageFrames[PAGE_INPUT], "I", text);
+    _formatCompact(data.tokens.outputTokens, text, sizeof(text));
+    _renderPage(_pageFrames[PAGE_OUTPUT], "O", text);
+    _formatCompact(data.tokens.cacheCreationTokens + data.tokens.cacheReadTokens,
+                   text, sizeof(text));
+    _renderPage(_pageFrames[PAGE_CACHE], "C", text);
+
+    const char arrow[] = {
+        data.trend == TREND_UP   ? GLYPH_TREND_UP
+      : data.trend == TREND_DOWN ? GLYPH_TREND_DOWN
+      : GLYPH_TREND_FLAT, '\0' };
+    _renderPage(_pageFrames[PAGE_TREND], arrow,
+                data.trend == TREND_UP ? "UP" : data.trend == TREND_DOWN ? "DOWN" : "FLAT");
+
+    // A new reading refreshes the page on screen without restarting the
+    // rotation
+    if (!_carousel) {
+        _carousel = true;
+        _page = first < PAGE_COUNT ? first : PAGE_COST;
+    }
+    _showPage();
+}
+
+void DisplayManager::addSparklinePoint(float costUsd) {
+    if (_sparkModules == 0) {
+        return;
+    }
+
+    uint8_t capacity = _sparkModules * 8;
+    _sparkHistory[_sparkHead] = costUsd;
+    _sparkHead = (_sparkHead + 1) % capacity;
+    if (_sparkCount < capacity) _sparkCount++;
+}
+
+bool DisplayManager::isMultiZone() const {
+    return _zoneCount > 1;
+}
+
 void DisplayManager::showBootAnimation() {
-    // Simple sweep animation: light each column left-to-right then display name
-    _parola.displayClear();
-    _parola.setTextAlignment(PA_CENTER);
-    _parola.print("CLAUDE");
-    delay(1200);
-    _parola.displayClear();
-    _parola.print("METER");
-    delay(800);
-    _parola.displayClear();
+    // Shows the name while WiFi connects; update() steps through the frames
+    _stopCarousel();
+    _isError = false;
+    _clearSecondaryZones();
+    _setZoneText(ZONE_COST, "CLAUDE", false);
+    _bootPhase = 1;
+    _bootTimer = millis();
+}
+
+void DisplayManager::dumpFrame(Print& out) {
+    MD_MAX72XX* mx = _parola.getGraphicObject();
+    char line[DISPLAY_NUM_DEVICES * 8 + 1];
+
+    // Column 0 is the rightmost, so walk columns high to low
+    for (uint8_t row = 0; row < 8; row++) {
+        for (uint16_t i = 0; i < DISPLAY_NUM_DEVICES * 8; i++) {
+            uint8_t bits = mx->getColumn(DISPLAY_NUM_DEVICES * 8 - 1 - i);
+            line[i] = (bits & (1 << row)) ? '#' : '.';
+        }
+        line[sizeof(line) - 1] = '\0';
+        out.println(line);
+    }
 }
 
 void DisplayManager::setBrightness(uint8_t level) {
@@ -133,6 +316,227 @@ void DisplayManager::setBrightness(uint8_t level) {
     _parola.setIntensity(level);
 }
 
+void DisplayManager::setStale(bool stale) {
+    if (stale == _stale) return;
+    _stale = stale;
+    _parola.setIntensity(stale ? DISPLAY_BRIGHTNESS_STALE : DISPLAY_BRIGHTNESS);
+}
+
+// --- Private Methods ---
+
+void DisplayManager::_setZoneText(uint8_t zone, const char* text, bool scroll) {
+    bool scrolls = scroll ||
+        _parola.getTextColumns(zone, text) > _zoneModules[zone] * 8;
+
+    // The cost zone doubles as the status line, so it has a long scroll buffer
+    char* buf = _zoneBuf[zone];
+    size_t size = sizeof(_zoneBuf[zone]);
+    if (zone == ZONE_COST) {
+        buf = scrolls ? _scrollBuf : _staticBuf;
+        size = scrolls ? sizeof(_scrollBuf) : sizeof(_staticBuf);
+    }
+
+    // Not dirty: leave the zone and its animation alone
+    if (scrolls == _zoneScrolls[zone] && strcmp(buf, text) == 0) {
+        return;
+    }
+
+    strlcpy(buf, text, size);
+    _zoneScrolls[zone] = scrolls;
+    _parola.displayClear(zone);
+
+    if (scrolls) {
+        _parola.displayZoneText(zone, buf, PA_LEFT, SCROLL_SPEED_MS, SCROLL_PAUSE_MS,
+                                PA_SCROLL_LEFT, PA_SCROLL_LEFT);
+    } else {
+        _parola.displayZoneText(zone, buf, PA_CENTER, SCROLL_SPEED_MS, 0,
+                                PA_PRINT, PA_NO_EFFECT);
+        _parola.displayAnimate();
+    }
+}
+
+void DisplayManager::_clearSecondaryZones() {
+    for (uint8_t zone = 1; zone < _zoneCount; zone++) {
+        _setZoneText(zone, "", false);
+    }
+    if (_sparkModules > 0) {
+        _parola.getGraphicObject()->clear(0, _sparkModules - 1);
+    }
+}
+
+void DisplayManager::_drawSparkline() {
+    MD_MAX72XX* mx = _parola.getGraphicObject();
+    uint8_t capacity = _sparkModules * 8;
+
+    float lo = _sparkHistory[0];
+    float hi = lo;
+    for (uint8_t i = 0; i < _sparkCount; i++) {
+        if (_sparkHistory[i] < lo) lo = _sparkHistory[i];
+        if (_sparkHistory[i] > hi) hi = _sparkHistory[i];
+    }
+
+    // Column 0 (rightmost) holds the newest sample; bars grow from the
+    // bottom row (bit 7) and span 1–8 rows across the min–max range
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+    for (uint8_t col = 0; col < capacity; col++) {
+        uint8_t bits = 0;
+        if (col < _sparkCount) {
+            float value = _sparkHistory[(_sparkHead + capacity - 1 - col) % capacity];
+            uint8_t height = 1;
+            if (hi > lo) {
+                height += (uint8_t)((value - lo) * 7.0f / (hi - lo) + 0.5f);
+            }
+            bits = (uint8_t)(0xFF << (8 - height));
+        }
+        mx->setColumn(col, bits);
+    }
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::ON);
+}
+
+void DisplayManager::_stopCarousel() {
+    if (!_carousel) return;
+    _carousel = false;
+
+    // The matrix holds a page Parola never drew. Blank both, so whatever
+    // text comes next counts as changed.
+    _staticBuf[0] = '\0';
+    _scrollBuf[0] = '\0';
+    _zoneScrolls[ZONE_COST] = false;
+    _parola.displayClear(ZONE_COST);
+}
+
+void DisplayManager::_renderPage(uint8_t* frame, const char* label, const char* value) {
+    const uint16_t width = DISPLAY_NUM_DEVICES * 8;
+    uint8_t cols[width];
+    uint16_t used = width + 1;
+
+    if (label != nullptr) {
+        char text[32];
+        snprintf(text, sizeof(text), "%s %s", label, value);
+        used = _rasterize(text, cols, width);
+    }
+    // Drop the label if the page is too narrow for it
+    if (used > width) {
+        used = _rasterize(value, cols, width);
+    }
+    if (used > width) {
+        used = width;   // Clipped on the right
+    }
+
+    // Centered, like PA_CENTER text
+    memset(frame, 0, width);
+    memcpy(frame + (width - used) / 2, cols, used);
+}
+
+uint16_t DisplayManager::_rasterize(const char* text, uint8_t* cols, uint16_t maxCols) {
+    MD_MAX72XX* mx = _parola.getGraphicObject();
+    uint8_t glyph[8];
+    uint16_t used = 0;
+
+    // Returns the full width; columns past maxCols are measured, not stored
+    for (const char* p = text; *p != '\0'; p++) {
+        const uint8_t* bits = glyph;
+        uint8_t glyphWidth;
+        if (*p == GLYPH_TREND_UP || *p == GLYPH_TREND_DOWN || *p == GLYPH_TREND_FLAT) {
+            const uint8_t* custom = *p == GLYPH_TREND_UP   ? glyphTrendUp
+                                  : *p == GLYPH_TREND_DOWN ? glyphTrendDown
+                                  : glyphTrendFlat;
+            glyphWidth = custom[0];
+            bits = custom + 1;
+        } else {
+            glyphWidth = mx->getChar((uint8_t)*p, sizeof(glyph), glyph);
+        }
+
+        // One blank column between characters, as Parola spaces them
+        if (used > 0) {
+            if (used < maxCols) cols[used] = 0;
+            used++;
+        }
+        for (uint8_t i = 0; i < glyphWidth; i++) {
+            if (used < maxCols) cols[used] = bits[i];
+            used++;
+        }
+    }
+    return used;
+}
+
+void DisplayManager::_showPage() {
+    MD_MAX72XX* mx = _parola.getGraphicObject();
+    const uint16_t width = DISPLAY_NUM_DEVICES * 8;
+
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+    unsigned long started = micros();
+#endif
+    // One buffer copy and one flush; setBuffer fills leftwards from col
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+    mx->setBuffer(width - 1, width, _pageFrames[_page]);
+    mx->control(MD_MAX72XX::UPDATE, MD_MAX72XX::ON);
+    _pageTimer = millis();
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+    _statPageUs += micros() - started;
+    _statPageSwitches++;
+#endif
+}
+
+#if DISPLAY_FRAME_STATS || DISPLAY_FRAME_DUMP
+void DisplayManager::_trackFrame(uint32_t updateUs) {
+    MD_MAX72XX* mx = _parola.getGraphicObject();
+
+    // MD_MAX72XX flushes per row, and a row write shifts 2 bytes through
+    // every device in the chain, so SPI traffic is changed rows × 2 × N
+    uint8_t changedRows = 0;
+    for (uint16_t col = 0; col < DISPLAY_NUM_DEVICES * 8; col++) {
+        uint8_t bits = mx->getColumn(col);
+        changedRows |= bits ^ _lastFrame[col];
+        _lastFrame[col] = bits;
+    }
+
+    _statUpdates++;
+    _statUpdateUs += updateUs;
+
+    if (changedRows) {
+        _statFrames++;
+        _statSpiBytes += __builtin_popcount(changedRows) * 2 * DISPLAY_NUM_DEVICES;
+#if DISPLAY_FRAME_DUMP
+        Serial.printf("-- frame %u (+%lu ms)\n", _statFrames, millis());
+        dumpFrame(Serial);
+#endif
+    }
+
+#if DISPLAY_FRAME_STATS
+    unsigned long elapsed = millis() - _statTimer;
+    if (elapsed >= DISPLAY_STATS_INTERVAL_MS) {
+        log_i("Display: %.1f fps, %u SPI bytes/frame, %u us/update (%u modules)",
+              _statFrames * 1000.0f / elapsed,
+              _statFrames ? _statSpiBytes / _statFrames : 0,
+              _statUpdates ? _statUpdateUs / _statUpdates : 0,
+              DISPLAY_NUM_DEVICES);
+        if (_statPageSwitches > 0) {
+            log_i("Display: %u page switches, %u us/switch (%u pages)",
+                  _statPageSwitches, _statPageUs / _statPageSwitches, PAGE_COUNT);
+        }
+        _statFrames = 0;
+        _statSpiBytes = 0;
+        _statUpdateUs = 0;
+        _statUpdates = 0;
+        _statPageUs = 0;
+        _statPageSwitches = 0;
+        _statTimer = millis();
+    }
+#endif
+}
+#endif
+
+void DisplayManager::_formatCost(float costUsd, char* buf, size_t bufSize) {
+    // "$XX.XX" below $100; whole dollars above. Text wider than its zone
+    // scrolls.
+    if (costUsd < 100.0f) {
+        snprintf(buf, bufSize, "%s%.2f", COST_PREFIX, costUsd);
+    } else {
+        snprintf(buf, bufSize, "%s%.0f", COST_PREFIX, costUsd);
+    }
+}
+
 void DisplayManager::_formatCompact(uint64_t value, char* buf, size_t bufSize) {
     if (value >= 1000000000ULL) {
         snprintf(buf, bufSize, "%.1fB", (double)value / 1000000000.0);
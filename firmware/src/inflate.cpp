@@ -0,0 +1,150 @@
+#include "inflate.h"
+
+// ============================================================================
+// Inflate Reader Implementation
+// ============================================================================
+
+// gzip header flags (RFC 1952, section 2.3.1)
+#define GZIP_FHCRC     0x02
+#define GZIP_FEXTRA    0x04
+#define GZIP_FNAME     0x08
+#define GZIP_FCOMMENT  0x10
+
+InflateReader::InflateReader()
+    : _src(nullptr),
+      _srcLeft(0),
+      _flags(0),
+      _windowOfs(0),
+      _readPos(0),
+      _readEnd(0),
+      _inflated(0),
+      _done(true),
+      _failed(false)
+{
+}
+
+bool InflateReader::begin(const uint8_t* src, size_t length, bool gzip) {
+    _windowOfs = 0;
+    _readPos = 0;
+    _readEnd = 0;
+    _inflated = 0;
+    _done = false;
+    _failed = false;
+    _flags = 0;
+
+    if (gzip) {
+        size_t header = _gzipHeaderLength(src, length);
+        if (header == 0) {
+            _done = _failed = true;
+            return false;
+        }
+        src += header;
+        length -= header;
+    } else if (length >= 2 && (src[0] & 0x0F) == 8 &&
+               ((src[0] << 8) | src[1]) % 31 == 0) {
+        // zlib header: CM = 8 (deflate) and a valid FCHECK
+        _flags = TINFL_FLAG_PARSE_ZLIB_HEADER;
+    }
+
+    _src = src;
+    _srcLeft = length;
+    tinfl_init(&_inflator);
+    return true;
+}
+
+int InflateReader::read() {
+    if (_readPos == _readEnd && !_fill()) {
+        return -1;
+    }
+    return _window[_readPos++];
+}
+
+size_t InflateReader::readBytes(char* buffer, size_t length) {
+    size_t copied = 0;
+
+    while (copied < length) {
+        if (_readPos == _readEnd && !_fill()) {
+            break;
+        }
+        size_t n = _readEnd - _readPos;
+        if (n > length - copied) n = length - copied;
+        memcpy(buffer + copied, _window + _readPos, n);
+        _readPos += n;
+        copied += n;
+    }
+
+    return copied;
+}
+
+bool InflateReader::failed() const {
+    return _failed;
+}
+
+size_t InflateReader::inflatedBytes() const {
+    return _inflated;
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+bool InflateReader::_fill() {
+    while (!_done) {
+        size_t inBytes = _srcLeft;
+        size_t outBytes = TINFL_LZ_DICT_SIZE - _windowOfs;
+
+        // The whole compressed body is in memory, so HAS_MORE_INPUT is never
+        // set: running out of input means the stream was truncated
+        tinfl_status status = tinfl_decompress(&_inflator, _src, &inBytes,
+            _window, _window + _windowOfs, &outBytes, _flags);
+
+        _src += inBytes;
+        _srcLeft -= inBytes;
+        _readPos = _windowOfs;
+        _readEnd = _windowOfs + outBytes;
+        _windowOfs = (_windowOfs + outBytes) & (TINFL_LZ_DICT_SIZE - 1);
+        _inflated += outBytes;
+
+        if (status == TINFL_STATUS_DONE) {
+            _done = true;
+        } else if (status != TINFL_STATUS_HAS_MORE_OUTPUT || _inflated > HTTP_INFLATE_MAX) {
+            log_e("Inflate failed (status %d, %u bytes out)", (int)status, (unsigned)_inflated);
+            _done = _failed = true;
+            _readEnd = _readPos;
+            return false;
+        }
+
+        if (outBytes > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t InflateReader::_gzipHeaderLength(const uint8_t* src, size_t length) {
+    // ID1 ID2 CM FLG MTIME(4) XFL OS
+    if (length < 10 || src[0] != 0x1F || src[1] != 0x8B || src[2] != 8) {
+        return 0;
+    }
+
+    uint8_t flags = src[3];
+    size_t pos = 10;
+
+    if (flags & GZIP_FEXTRA) {
+        if (pos + 2 > length) return 0;
+        pos += 2 + (src[pos] | (src[pos + 1] << 8));
+    }
+    if (flags & GZIP_FNAME) {
+        while (pos < length && src[pos] != 0) pos++;
+        pos++;
+    }
+    if (flags & GZIP_FCOMMENT) {
+        while (pos < length && src[pos] != 0) pos++;
+        pos++;
+    }
+    if (flags & GZIP_FHCRC) {
+        pos += 2;
+    }
+
+    return pos < length ? pos : 0;
+}
@@ -9,10 +9,12 @@
 //   → displays real-time cost or token count on desk-mounted display.
 //
 // Data Flow:
-//   1. Boot → WiFi provisioning via captive portal (WiFiManager)
+//   1. Boot → fast reconnect from cached BSSID/channel/IP (boot animation
+//      runs meanwhile), else WiFi provisioning via captive portal (WiFiManager)
 //   2. Run  → Poll n8n webhook every POLL_INTERVAL_MS
-//   3. Parse JSON → extract cost_usd or token counts
+//   3. Parse JSON / MessagePack → extract cost_usd or token counts
 //   4. Render on MAX7219 via MD_Parola
+//   5. Persist the reading; at next boot it is shown (dimmed) immediately
 //
 // Error Codes (shown on display):
 //   E-WIFI  — WiFi disconnected
@@ -21,16 +23,22 @@
 //   E-JSON  — JSON parse error
 //   E-HTTP  — Other HTTP error
 //
-// Factory Reset:
-//   Hold GPIO 0 (BOOT button) for 5 seconds during operation.
+// BOOT Button (GPIO 0):
+//   Tap to cycle usage windows (reported / 1H / DAY / 7D / MTD).
+//   Hold for 5 seconds during operation for a factory reset.
 //
 // ============================================================================
 
 #include <Arduino.h>
 #include "config.h"
+#include "capture.h"
 #include "display.h"
 #include "network.h"
 #include "parser.h"
+#include "relay.h"
+#include "rollup.h"
+#include "stats.h"
+#include "store.h"
 
 // ---------------------------------------------------------------------------
 // State Machine
@@ -48,21 +56,50 @@ enum DeviceState {
 // ---------------------------------------------------------------------------
 static DisplayManager display;
 static NetworkManager network;
+static MeterStore store;
+static PollStats stats;
+static Rollup rollup;
+#if RELAY_ENABLED
+static Relay relay;
+#endif
+#if CAPTURE_MODE
+static Capture capture;
+#endif
 static DeviceState state = STATE_BOOT;
 
-static unsigned long lastPollTime = 0;
+// Polls run on a fixed grid of ticks; 0 = poll right away
+static unsigned long nextPollTick = 0;
+static unsigned long pollTick = 0;       // Tick of the poll in flight
+static bool polling = false;             // A poll is in flight
 static unsigned long lastWifiCheck = 0;
 static int consecutiveFailures = 0;
 
-// Factory reset: hold BOOT button (GPIO 0) for 5 seconds
+// Boot timing: fast reconnect runs alongside the boot animation
+static unsigned long connectStartTime = 0;
+static bool fastConnecting = false;
+static bool firstValueShown = false;
+static bool restoredValueShown = false;  // Stale value from before reboot on screen
+
+// BOOT button (GPIO 0): tap to cycle windows, hold 5 seconds to reset
 #define RESET_BUTTON_PIN  0
 #define RESET_HOLD_MS     5000
+#define BUTTON_TAP_MS     600     // Longer presses are not taps
+#define BUTTON_DEBOUNCE_MS 30
 static unsigned long resetButtonDown = 0;
 static bool resetButtonActive = false;
 
+// Usage window on screen; WINDOW_COUNT = the reading as reported
+static uint8_t selectedWindow = WINDOW_COUNT;
+static unsigned long windowLabelUntil = 0;   // Window name shown until then
+static unsigned long lastWindowCycle = 0;
+static MeterData lastReading = {};
+
 // Last displayed data (for trend comparison)
 static float lastCostUsd = 0.0f;
 
+// Last good reading per source, reused when a source answers 304
+static MeterData sourceData[MAX_SOURCES];
+
 // ---------------------------------------------------------------------------
 // Forward Declarations
 // ---------------------------------------------------------------------------
@@ -70,15 +107,21 @@ void handleBoot();
 void handleConnecting();
 void handleRunning();
 void handleError(const char* errorCode);
-void checkFactoryReset();
-void pollAndDisplay();
+void checkButton();
+void beginPoll(unsigned long tick);
+void completePoll();
+bool processPoll(const PollResult& result);
+void acceptReading(const MeterData& data);
+void showData(const MeterData& data);
+void showCurrent();
+void cycleWindow();
+bool restoreLastValue();
 
 // ---------------------------------------------------------------------------
 // Setup
 // ---------------------------------------------------------------------------
 void setup() {
     Serial.begin(115200);
-    delay(500);
 
     log_i("=== Claude Code Meter v1.0 ===");
     log_i("Heap free: %u bytes", ESP.getFreeHeap());
@@ -89,6 +132,10 @@ void setup() {
 
     // Factory reset button
     pinMode(RESET_BUTTON_PIN, INPUT_PULLUP);
+
+#if CAPTURE_MODE
+    capture.begin();
+#endif
 }
 
 // ---------------------------------------------------------------------------
@@ -98,8 +145,31 @@ void loop() {
     // Always tick the display animation
     display.update();
 
-    // Check for factory reset hold
-    checkFactoryReset();
+    // Window taps and factory reset hold
+    checkButton();
+
+    // After a window's name, show its value
+    if (windowLabelUntil != 0 && (long)(millis() - windowLabelUntil) >= 0) {
+        windowLabelUntil = 0;
+        showCurrent();
+    }
+
+#if ROLLUP_CYCLE_MS > 0
+    if (state == STATE_RUNNING && rollup.hasData() &&
+        millis() - lastWindowCycle >= ROLLUP_CYCLE_MS) {
+        cycleWindow();
+    }
+#endif
+
+    // Periodic diagnostics report on serial
+    stats.update();
+
+#if CAPTURE_MODE == 1
+    // 'D' on serial dumps the recording as hex
+    if (Serial.available() > 0 && Serial.read() == 'D') {
+        capture.dump(Serial);
+    }
+#endif
 
     switch (state) {
         case STATE_BOOT:
@@ -118,7 +188,7 @@ void loop() {
             // Errors auto-recover: retry WiFi check periodically
             if (millis() - lastWifiCheck > 10000) {
                 lastWifiCheck = millis();
-                if (network.isConnected()) {
+                if (CAPTURE_MODE == 2 || network.isConnected()) {
                     state = STATE_RUNNING;
                     consecutiveFailures = 0;
                 }
@@ -131,7 +201,7 @@ void loop() {
                 display.showStatic("OK");
                 delay(500);
                 state = STATE_RUNNING;
-                lastPollTime = 0;  // Force immediate poll
+                nextPollTick = 0;  // Force immediate poll
             }
             break;
     }
@@ -142,22 +212,70 @@ void loop() {
 // ---------------------------------------------------------------------------
 
 void handleBoot() {
+#if CAPTURE_MODE == 2
+    // Replay runs offline: no WiFi, the recording stands in for the network
     display.showBootAnimation();
-    log_i("Boot animation complete");
+    capture.beginReplay();
+    state = STATE_RUNNING;
+    return;
+#endif
+
+    // Loads config too, so it must precede restoreLastValue()
+    fastConnecting = network.beginFast();
+    connectStartTime = millis();
+
+    // Show the last reading right away; otherwise animate while WiFi comes
+    // up (the animation is driven by display.update())
+    restoredValueShown = restoreLastValue();
+    if (!restoredValueShown) {
+        display.showBootAnimation();
+    }
+
+#if RELAY_ENABLED
+    // Meters polling the same webhooks form one relay group
+    const char* urls[MAX_SOURCES];
+    for (uint8_t i = 0; i < network.getSourceCount(); i++) {
+        urls[i] = network.getWebhookUrl(i);
+    }
+    relay.configure(urls, network.getSourceCount());
+#endif
+
     state = STATE_CONNECTING;
 }
 
 void handleConnecting() {
-    display.showStatic("WiFi");
+    if (fastConnecting) {
+        if (network.isConnected()) {
+            log_i("Fast reconnect in %lu ms", millis() - connectStartTime);
+            configTime(0, 0, NTP_SERVER);
+            fastConnecting = false;
+            state = STATE_RUNNING;
+            nextPollTick = 0;  // Force immediate first poll
+            return;
+        }
+        if (millis() - connectStartTime < FAST_CONNECT_TIMEOUT_MS &&
+            !network.fastConnectFailed()) {
+            return;  // Keep animating
+        }
+        log_w("Fast reconnect failed, falling back to full connect");
+        fastConnecting = false;
+    }
+
+    // Keep a restored reading on screen rather than status text
+    if (!restoredValueShown) {
+        display.showStatic("WiFi");
+    }
 
     bool connected = network.begin();
 
     if (connected) {
         log_i("WiFi connected, entering run mode");
-        display.showStatic("OK");
-        delay(500);
+        configTime(0, 0, NTP_SERVER);
+        if (!restoredValueShown) {
+            display.showStatic("OK");
+        }
         state = STATE_RUNNING;
-        lastPollTime = 0;  // Force immediate first poll
+        nextPollTick = 0;  // Force immediate first poll
     } else {
         log_w("WiFi not connected — captive portal may be active");
         display.showScrolling("Setup: Connect to ClaudeMeter_Setup WiFi");
@@ -166,26 +284,85 @@ void handleConnecting() {
 }
 
 void handleRunning() {
+#if CAPTURE_MODE == 2
+    PollResult replayed;
+    if (capture.nextCycle(replayed)) {
+        processPoll(replayed);
+    }
+    return;
+#endif
+
     // Periodic WiFi health check
     if (millis() - lastWifiCheck > 30000) {
         lastWifiCheck = millis();
         if (!network.isConnected()) {
             log_w("WiFi connection lost");
+            stats.recordError(ERR_WIFI);
             handleError(ERR_WIFI);
             return;
         }
     }
 
-    // Poll webhook at configured interval
-    if (millis() - lastPollTime >= POLL_INTERVAL_MS || lastPollTime == 0) {
-        lastPollTime = millis();
-        pollAndDisplay();
+#if RELAY_ENABLED
+    MeterData relayed;
+    switch (relay.update(relayed)) {
+        case RELAY_READING:
+            acceptReading(relayed);
+            break;
+        case RELAY_LEADER_ERROR:
+            display.showError(relay.leaderError());
+            break;
+        case RELAY_PROMOTED:
+            nextPollTick = 0;  // Poll right away for the group
+            break;
+        default:
+            break;
+    }
+
+    // Followers render what the leader multicasts and never poll. A leader
+    // that just stepped down drops its poll, so a late result cannot be
+    // taken for the group's after a later promotion.
+    if (!relay.isLeader()) {
+        if (polling) {
+            network.cancelPoll();
+            polling = false;
+        }
+        return;
+    }
+#endif
+
+    // A poll in flight: the display keeps animating until it lands
+    if (polling) {
+        if (network.pollDone()) {
+            polling = false;
+            completePoll();
+        }
+        return;
+    }
+
+    // Poll on the tick grid. Connection setup starts early by the expected
+    // DNS + connect + TLS time, so the request itself goes out on the tick.
+    unsigned long now = millis();
+    if (nextPollTick == 0) {
+        nextPollTick = now;
+    }
+    if ((long)(now + network.warmupMs() - nextPollTick) >= 0) {
+        pollTick = nextPollTick;
+        nextPollTick += POLL_INTERVAL_MS;
+        // Behind by a whole interval (outage, portal): skip, don't burst
+        if ((long)(now - nextPollTick) >= 0) {
+            nextPollTick = now + POLL_INTERVAL_MS;
+        }
+        beginPoll(pollTick);
     }
 }
 
 void handleError(const char* errorCode) {
     log_e("Error state: %s", errorCode);
     display.showError(errorCode);
+#if RELAY_ENABLED
+    relay.publishError(errorCode);
+#endif
     state = STATE_ERROR;
     lastWifiCheck = millis();
 }
@@ -194,62 +371,206 @@ void handleError(const char* errorCode) {
 // Core Logic: Poll webhook and update display
 // ---------------------------------------------------------------------------
 
-void pollAndDisplay() {
-    log_i("Polling webhook... (heap: %u)", ESP.getFreeHeap());
+void beginPoll(unsigned long tick) {
+    log_i("Polling webhook... (heap: %u, largest block: %u, warm-up %ld ms)",
+          ESP.getFreeHeap(), ESP.getMaxAllocHeap(), (long)(tick - millis()));
 
-    PollResult result = network.poll();
+    // A 304 carries no hourly buckets, so with several sources feeding the
+    // window history every poll must return full bodies to be re-summed
+    if (rollup.hasData() && network.getSourceCount() > 1) {
+        for (uint8_t i = 0; i < network.getSourceCount(); i++) {
+            network.forgetValidator(i);
+        }
+    }
+
+    polling = network.startPoll(tick);
+    if (!polling) {
+        completePoll();
+    }
+}
 
+void completePoll() {
+    const PollResult& result = network.pollResult();
+#if CAPTURE_MODE == 1
+    capture.record(result, millis() - result.elapsedMs);
+#endif
+
+    if (processPoll(result)) {
+        unsigned long latency = millis() - pollTick;
+        log_i("Tick to display: %lu ms", latency);
+        stats.recordDisplayLatency(latency);
+    }
+}
+
+// Turn a poll cycle's responses into a reading, live or replayed. True if
+// a fresh reading was shown.
+bool processPoll(const PollResult& result) {
     if (!result.success) {
+        stats.recordPoll(result.elapsedMs, result.errorMsg);
         consecutiveFailures++;
         log_w("Poll failed (%d/%d): %s (HTTP %d)",
               consecutiveFailures, MAX_NET_FAILURES,
-              result.errorMsg.c_str(), result.httpCode);
+              result.errorMsg, result.httpCode);
+        for (uint8_t i = 0; i < result.sourceCount; i++) {
+            const FetchResult& fetched = result.sources[i];
+            if (fetched.failedPhase < PHASE_COUNT) {
+                log_w("Source %u stopped in %s phase after %lu ms (HTTP %d)", i,
+                      Source::phaseName(fetched.failedPhase), fetched.elapsedMs,
+                      fetched.httpCode);
+            }
+        }
 
         if (consecutiveFailures >= MAX_NET_FAILURES) {
-            handleError(result.errorMsg.c_str());
+            handleError(result.errorMsg);
         }
-        return;
+        return false;
     }
 
     // Reset failure counter on success
     consecutiveFailures = 0;
 
-    // Parse response based on content
-    MeterData data;
+    rollup.advance(time(nullptr));
+    rollup.beginCycle();
 
-    // Detect response format: if it contains "data" array, it's direct API
-    if (result.payload.indexOf("\"data\"") >= 0) {
-        data = Parser::parseAnthropicUsage(result.payload);
-    } else {
-        data = Parser::parseWebhookResponse(result.payload);
-    }
+    for (uint8_t i = 0; i < result.sourceCount; i++) {
+        const FetchResult& fetched = result.sources[i];
 
-    if (!data.valid) {
-        handleError(ERR_JSON);
-        return;
+        // 304 Not Modified: keep the previous reading for this source
+        if (!fetched.notModified) {
+            sourceData[i] = Parser::parse(fetched.payload, fetched.payloadLength,
+                                          fetched.format, fetched.encoding, &rollup);
+        }
+
+        if (!sourceData[i].valid) {
+            // Make sure the next poll brings a full body to re-parse
+            network.forgetValidator(i);
+            stats.recordPoll(result.elapsedMs, ERR_JSON);
+            handleError(ERR_JSON);
+            return false;
+        }
+
+        log_d("Source %u phases (ms): DNS %u, connect %u, TLS %u, first byte %u, body %u",
+              i, fetched.phaseMs[PHASE_DNS], fetched.phaseMs[PHASE_CONNECT],
+              fetched.phaseMs[PHASE_TLS], fetched.phaseMs[PHASE_FIRST_BYTE],
+              fetched.phaseMs[PHASE_BODY]);
+
+        if (result.sourceCount > 1) {
+            log_i("Source %u: $%.2f (%lu ms%s)", i, sourceData[i].costUsd,
+                  fetched.elapsedMs, fetched.notModified ? ", not modified" : "");
+        }
     }
 
+    MeterData data = Parser::combine(sourceData, result.sourceCount);
+    log_i("Poll cycle: %lu ms for %u source(s)", result.elapsedMs, result.sourceCount);
+    stats.recordPoll(result.elapsedMs, nullptr);
+
     log_i("Cost: $%.2f | Tokens: %llu | Trend: %s",
           data.costUsd, (unsigned long long)data.tokens.totalTokens,
-          data.trend.c_str());
+          Parser::trendName(data.trend));
+
+    acceptReading(data);
+#if RELAY_ENABLED
+    relay.publish(data);
+#endif
+    return true;
+}
+
+// Show and persist a fresh reading, polled or relayed
+void acceptReading(const MeterData& data) {
+    lastReading = data;
+    display.addSparklinePoint(data.costUsd);
+    restoredValueShown = false;
+    if (windowLabelUntil == 0) {
+        showCurrent();
+    }
+#if CAPTURE_MODE != 2
+    // A replay must not overwrite the reading restored at the next real boot
+    store.save(data);
+    stats.recordFlashWrites(store.flashWrites());
+#endif
+
+    if (!firstValueShown) {
+        firstValueShown = true;
+        log_i("Boot to first value: %lu ms", millis());
+    }
 
-    // Display based on configured mode
-    String mode = network.getDisplayMode();
+    lastCostUsd = data.costUsd;
+}
 
-    if (mode == "tokens") {
+void showData(const MeterData& data) {
+    // Long chains show everything at once; otherwise follow the configured mode
+    if (display.isMultiZone()) {
+        display.showMeter(data);
+    } else if (DISPLAY_PAGE_MS > 0) {
+        // Rotate through every figure, starting with the configured one
+        display.showCarousel(data, network.getDisplayMode() == MODE_TOKENS
+                                   ? PAGE_TOKENS : PAGE_COST);
+    } else if (network.getDisplayMode() == MODE_TOKENS) {
         display.showTokens(data.tokens.totalTokens);
     } else {
         display.showCost(data.costUsd);
     }
+}
 
-    lastCostUsd = data.costUsd;
+bool restoreLastValue() {
+    MeterData data;
+    uint32_t timestamp;
+
+    if (!store.load(data, timestamp)) {
+        return false;
+    }
+
+    // The clock only survives soft resets; when it did, skip readings that
+    // are too old to mean anything
+    time_t now = time(nullptr);
+    if (timestamp != 0 && now > (time_t)timestamp &&
+        (uint32_t)(now - timestamp) > STORE_MAX_AGE_S) {
+        log_i("Stored value from %u is too old, not shown", timestamp);
+        return false;
+    }
+
+    log_i("Restored last value: $%.2f (taken at %u)", data.costUsd, timestamp);
+    lastReading = data;
+    display.addSparklinePoint(data.costUsd);
+    showData(data);
+    display.setStale(true);
+    return true;
+}
+
+void showCurrent() {
+    if (selectedWindow >= WINDOW_COUNT || !rollup.hasData()) {
+        showData(lastReading);
+    } else {
+        // Window totals are token counts; price them like usage reports
+        MeterData data = {};
+        data.valid = true;
+        data.tokens = rollup.total((RollupWindow)selectedWindow);
+        data.costUsd = Parser::computeCost(data.tokens);
+        showData(data);
+    }
+    display.setStale(restoredValueShown);
+}
+
+void cycleWindow() {
+    lastWindowCycle = millis();
+
+    if (!rollup.hasData()) {
+        // Needs usage reports with hourly buckets
+        display.showStatic("NO DATA");
+        selectedWindow = WINDOW_COUNT;
+    } else {
+        selectedWindow = (selectedWindow + 1) % (WINDOW_COUNT + 1);
+        display.showStatic(selectedWindow < WINDOW_COUNT
+            ? Rollup::windowName((RollupWindow)selectedWindow) : "NOW");
+    }
+    windowLabelUntil = millis() + ROLLUP_LABEL_MS;
 }
 
 // ---------------------------------------------------------------------------
-// Factory Reset (hold BOOT button for 5 seconds)
+// BOOT Button (tap: next window, hold 5 seconds: factory reset)
 // ---------------------------------------------------------------------------
 
-void checkFactoryReset() {
+void checkButton() {
     bool pressed = (digitalRead(RESET_BUTTON_PIN) == LOW);
 
     if (pressed && !resetButtonActive) {
@@ -258,12 +579,22 @@ void checkFactoryReset() {
     } else if (pressed && resetButtonActive) {
         if (millis() - resetButtonDown >= RESET_HOLD_MS) {
             log_w("Factory reset triggered!");
+            network.cancelPoll();
             display.showScrolling("RESET...");
             delay(1000);
             network.resetConfig();
+            store.clear();
+#if CAPTURE_MODE
+            capture.clear();
+#endif
             ESP.restart();
         }
-    } else {
+    } else if (!pressed && resetButtonActive) {
         resetButtonActive = false;
+        unsigned long held = millis() - resetButtonDown;
+        if (held >= BUTTON_DEBOUNCE_MS && held < BUTTON_TAP_MS &&
+            state == STATE_RUNNING) {
+            cycleWindow();
+        }
     }
 }
@@ -1,4 +1,5 @@
 #include "network.h"
+#include <esp_wifi.h>
 
 // ============================================================================
 // Network Manager Implementation
@@ -68,22 +69,86 @@ HK8NhXBx4SA7WkL/LFaaTkH4VudbVLfVBKKQheS0tvQ9GMz8Z/k=
 // Static instance pointer for WiFiManager callback
 NetworkManager* NetworkManager::_instance = nullptr;
 
+// Bumped whenever NetCache changes layout, invalidating stored records
+#define NET_CACHE_MAGIC  0x4E430002
+
+// Worker tasks run the TLS handshake, which needs a deep stack
+#define WORKER_STACK_SIZE  8192
+
+static const char* modeName(DisplayMode mode) {
+    return mode == MODE_TOKENS ? "tokens" : "cost";
+}
+
+static uint32_t fnv1a(const char* text) {
+    uint32_t hash = 2166136261u;
+    while (*text) {
+        hash = (hash ^ (uint8_t)*text++) * 16777619u;
+    }
+    return hash;
+}
+
+// Use the ISRG Root X1 CA by default (covers Let's Encrypt).
+// For Anthropic direct API, Amazon Root CA 1 is needed.
+static const char* rootCaFor(const char* url) {
+    return strstr(url, "anthropic.com") != nullptr ? ROOT_CA_AMAZON : ROOT_CA_ISRG;
+}
+
+// NVS key for source i: the first keeps the original key name
+static void webhookKey(uint8_t index, char* key, size_t size) {
+    if (index == 0) {
+        strlcpy(key, PREF_KEY_WEBHOOK, size);
+    } else {
+        snprintf(key, size, "%s%u", PREF_KEY_WEBHOOK, index);
+    }
+}
+
 NetworkManager::NetworkManager()
-    : _paramWebhook(nullptr),
+    : _sourceCount(0),
+      _displayMode(MODE_COST),
+      _configLoaded(false),
+      _fastAttempted(false),
+      _polling(false),
+      _cancel(false),
+      _pollStarted(0),
+      _pollDeadline(0),
+      _groupCount(0),
+      _phaseEwmaSeeded(0),
+      _paramWebhook(nullptr),
       _paramMode(nullptr)
 {
     _instance = this;
+    memset(&_netCache, 0, sizeof(_netCache));
+    memset(_workers, 0, sizeof(_workers));
+    memset(&_pollResult, 0, sizeof(_pollResult));
+    memset(_phaseEwmaMs, 0, sizeof(_phaseEwmaMs));
 }
 
 bool NetworkManager::begin() {
-    _loadPreferences();
-    _setupTLS();
+    if (!_configLoaded) {
+        _loadPreferences();
+    }
+
+    if (_fastAttempted) {
+        // Abandon the fast attempt and return to DHCP with flash-backed config
+        WiFi.disconnect();
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+        WiFi.persistent(true);
+        _fastAttempted = false;
+    }
+
+    // The portal edits all sources as one space-separated field
+    char urls[MAX_SOURCES * (WEBHOOK_URL_MAX + 1)];
+    urls[0] = '\0';
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        if (i > 0) strlcat(urls, " ", sizeof(urls));
+        strlcat(urls, _sources[i].url(), sizeof(urls));
+    }
 
     // Add custom parameters to the captive portal
     _paramWebhook = new WiFiManagerParameter(
-        "webhook", "n8n Webhook URL", _webhookUrl.c_str(), 256);
+        "webhook", "n8n Webhook URL(s), space separated", urls, sizeof(urls) - 1);
     _paramMode = new WiFiManagerParameter(
-        "mode", "Display Mode (cost/tokens)", _displayMode.c_str(), 16);
+        "mode", "Display Mode (cost/tokens)", modeName(_displayMode), 16);
 
     _wifiManager.addParameter(_paramWebhook);
     _wifiManager.addParameter(_paramMode);
@@ -102,68 +167,178 @@ bool NetworkManager::begin() {
     return connected;
 }
 
+bool NetworkManager::beginFast() {
+    _loadPreferences();
+
+    if (_netCache.magic != NET_CACHE_MAGIC) {
+        log_i("Fast reconnect: no cached network record");
+        return false;
+    }
+
+    // Credentials stay in the WiFi driver's own NVS storage; only the
+    // scan/DHCP results are ours to cache
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+
+    wifi_config_t conf;
+    if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK || conf.sta.ssid[0] == 0) {
+        WiFi.persistent(true);
+        return false;
+    }
+
+    char ssid[sizeof(conf.sta.ssid) + 1];
+    char pass[sizeof(conf.sta.password) + 1];
+    memcpy(ssid, conf.sta.ssid, sizeof(conf.sta.ssid));
+    ssid[sizeof(conf.sta.ssid)] = '\0';
+    memcpy(pass, conf.sta.password, sizeof(conf.sta.password));
+    pass[sizeof(conf.sta.password)] = '\0';
+
+    // Reuse the previous lease instead of waiting on DHCP
+    WiFi.config(IPAddress(_netCache.localIp), IPAddress(_netCache.gateway),
+                IPAddress(_netCache.subnet), IPAddress(_netCache.dns));
+
+    // Known channel + BSSID skips the all-channel scan
+    WiFi.begin(ssid, pass, _netCache.channel, _netCache.bssid);
+    _fastAttempted = true;
+
+    log_i("Fast reconnect: channel %u, IP %s",
+          _netCache.channel, IPAddress(_netCache.localIp).toString().c_str());
+    return true;
+}
+
+bool NetworkManager::fastConnectFailed() {
+    wl_status_t status = WiFi.status();
+    return status == WL_CONNECT_FAILED || status == WL_NO_SSID_AVAIL;
+}
+
 bool NetworkManager::isConnected() {
     return WiFi.status() == WL_CONNECTED;
 }
 
-PollResult NetworkManager::poll() {
-    PollResult result = { false, 0, "", "" };
+bool NetworkManager::startPoll(unsigned long sendAt) {
+    memset(&_pollResult, 0, sizeof(_pollResult));
+    _polling = false;
 
     if (!isConnected()) {
-        result.errorMsg = ERR_WIFI;
-        return result;
+        _pollResult.errorMsg = ERR_WIFI;
+        return false;
     }
 
-    if (_webhookUrl.length() == 0) {
-        result.errorMsg = "NO_URL";
-        return result;
+    if (_sourceCount == 0) {
+        _pollResult.errorMsg = "NO_URL";
+        return false;
     }
 
-    HTTPClient https;
-    https.setTimeout(HTTP_TIMEOUT_MS);
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        if (!_sources[i].isUsable()) {
+            // URL is neither http:// nor https:// or has no host
+            log_w("Source %u has an unusable URL: %s", i, _sources[i].url());
+            _pollResult.errorMsg = ERR_HTTP;
+            return false;
+        }
+    }
 
-    // Determine if URL is HTTPS
-    if (_webhookUrl.startsWith("https://")) {
-        if (!https.begin(_secureClient, _webhookUrl)) {
-            result.errorMsg = ERR_TLS;
-            return result;
+    for (uint8_t g = 0; g < MAX_SOURCES; g++) {
+        if (_workers[g].busy) {
+            // Abandoned by an earlier poll and still inside a library call;
+            // its sources' buffers are not ours to reuse yet
+            log_w("fetch%u still busy, poll skipped", g);
+            _pollResult.httpCode = HTTP_ERR_TIMEOUT;
+            _pollResult.errorMsg = ERR_TLS;
+            return false;
         }
-    } else {
-        // Allow HTTP for local n8n instances on trusted networks
-        // Use member variable to persist client for duration of request
-        if (!https.begin(_plainClient, _webhookUrl)) {
-            result.errorMsg = ERR_HTTP;
-            return result;
+    }
+
+    _cancel = false;
+    _pollStarted = millis();
+    if (sendAt == 0 || (long)(sendAt - _pollStarted) < 0) {
+        sendAt = _pollStarted;
+    }
+    _pollDeadline = sendAt + HTTP_TIMEOUT_MS;
+    _groupCount = _groupSources(_pollDeadline);
+
+    // If a worker cannot be started its group runs here, blocking but
+    // still bounded by the deadline
+    for (uint8_t g = 0; g < _groupCount; g++) {
+        Worker& worker = _workers[g];
+        worker.sendAt = sendAt;
+        if (_ensureWorker(g)) {
+            worker.busy = true;
+            xSemaphoreGive(worker.start);
+        } else {
+            Source::fetchGroup(worker.group, worker.count, worker.sendAt,
+                               worker.deadline, &_cancel);
         }
     }
 
-    https.addHeader("Accept", "application/json");
-    https.addHeader("User-Agent", "ClaudeCodeMeter/1.0 ESP32");
+    _polling = true;
+    return true;
+}
 
-    int httpCode = https.GET();
-    result.httpCode = httpCode;
+bool NetworkManager::pollDone() {
+    if (!_polling) {
+        return true;
+    }
 
-    if (httpCode == HTTP_CODE_OK) {
-        result.success = true;
-        result.payload = https.getString();
-    } else if (httpCode == 401 || httpCode == 403) {
-        result.errorMsg = ERR_API;
-    } else if (httpCode < 0) {
-        // WiFiClientSecure / HTTPClient error codes are negative
-        result.errorMsg = ERR_TLS;
-    } else {
-        result.errorMsg = ERR_HTTP;
+    bool running = false;
+    for (uint8_t g = 0; g < _groupCount; g++) {
+        running |= _workers[g].busy;
+    }
+    if (running &&
+        (long)(millis() - (_pollDeadline + HTTP_ABANDON_GRACE_MS)) < 0) {
+        return false;
+    }
+
+    _completePoll();
+    _polling = false;
+    return true;
+}
+
+void NetworkManager::cancelPoll() {
+    if (_polling) {
+        _cancel = true;
+    }
+}
+
+const PollResult& NetworkManager::pollResult() const {
+    return _pollResult;
+}
+
+unsigned long NetworkManager::warmupMs() const {
+    // Sources sharing an endpoint ride on their first member's connection
+    unsigned long slowest = 0;
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        bool shared = false;
+        for (uint8_t j = 0; j < i && !shared; j++) {
+            shared = _sources[j].sameEndpoint(_sources[i]);
+        }
+        if (shared) continue;
+
+        unsigned long setup = _phaseEwmaMs[i][PHASE_DNS] +
+                              _phaseEwmaMs[i][PHASE_CONNECT] +
+                              _phaseEwmaMs[i][PHASE_TLS];
+        if (setup > slowest) slowest = setup;
     }
 
-    https.end();
-    return result;
+    unsigned long warmup = slowest + POLL_WARMUP_MARGIN_MS;
+    return warmup < POLL_WARMUP_MAX_MS ? warmup : POLL_WARMUP_MAX_MS;
+}
+
+uint8_t NetworkManager::getSourceCount() const {
+    return _sourceCount;
 }
 
-String NetworkManager::getWebhookUrl() {
-    return _webhookUrl;
+const char* NetworkManager::getWebhookUrl(uint8_t source) const {
+    return source < _sourceCount ? _sources[source].url() : "";
 }
 
-String NetworkManager::getDisplayMode() {
+void NetworkManager::forgetValidator(uint8_t source) {
+    if (source < _sourceCount) {
+        _sources[source].forgetValidator();
+    }
+}
+
+DisplayMode NetworkManager::getDisplayMode() const {
     return _displayMode;
 }
 
@@ -179,47 +354,281 @@ void NetworkManager::resetConfig() {
 
 void NetworkManager::_saveConfigCallback() {
     if (_instance) {
-        _instance->_webhookUrl = _instance->_paramWebhook->getValue();
-        _instance->_displayMode = _instance->_paramMode->getValue();
+        _instance->_setSources(_instance->_paramWebhook->getValue());
 
-        // Refresh TLS settings in case the new URL requires a different CA
-        _instance->_setupTLS();
-
-        // Validate display mode
-        if (_instance->_displayMode != "cost" && _instance->_displayMode != "tokens") {
-            _instance->_displayMode = "cost";
-        }
+        // Validate display mode: anything but "tokens" falls back to cost
+        const char* mode = _instance->_paramMode->getValue();
+        _instance->_displayMode = (strcmp(mode, "tokens") == 0) ? MODE_TOKENS : MODE_COST;
 
         _instance->_savePreferences();
-        log_i("Config saved — webhook: %s, mode: %s",
-              _instance->_webhookUrl.c_str(), _instance->_displayMode.c_str());
+        log_i("Config saved — %u webhook(s), mode: %s",
+              _instance->_sourceCount, modeName(_instance->_displayMode));
+    }
+}
+
+void NetworkManager::_workerTask(void* arg) {
+    Worker* worker = static_cast<Worker*>(arg);
+    for (;;) {
+        xSemaphoreTake(worker->start, portMAX_DELAY);
+        Source::fetchGroup(worker->group, worker->count, worker->sendAt,
+                           worker->deadline, &_instance->_cancel);
+        worker->busy = false;
     }
 }
 
 void NetworkManager::_loadPreferences() {
+    char mode[16] = "cost";
+    char key[16];
+    char url[WEBHOOK_URL_MAX + 1];
+
+    _sourceCount = 0;
+
     _preferences.begin(PREF_NAMESPACE, true);  // read-only
-    _webhookUrl = _preferences.getString(PREF_KEY_WEBHOOK, "");
-    _displayMode = _preferences.getString(PREF_KEY_MODE, "cost");
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        webhookKey(i, key, sizeof(key));
+        url[0] = '\0';
+        // Skip the lookup (and its "not found" log) for absent keys
+        if (_preferences.isKey(key)) {
+            _preferences.getString(key, url, sizeof(url));
+        }
+        if (url[0] == '\0') break;
+        _sources[_sourceCount++].configure(url, rootCaFor(url));
+    }
+    _preferences.getString(PREF_KEY_MODE, mode, sizeof(mode));
     _preferences.end();
 
-    log_i("Loaded prefs — webhook: %s, mode: %s",
-          _webhookUrl.c_str(), _displayMode.c_str());
+    _displayMode = (strcmp(mode, "tokens") == 0) ? MODE_TOKENS : MODE_COST;
+    _loadNetCache();
+    _configLoaded = true;
+
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        log_i("Loaded prefs — webhook %u: %s", i, _sources[i].url());
+    }
+    log_i("Loaded prefs — mode: %s", modeName(_displayMode));
 }
 
 void NetworkManager::_savePreferences() {
+    char key[16];
+
     _preferences.begin(PREF_NAMESPACE, false);  // read-write
-    _preferences.putString(PREF_KEY_WEBHOOK, _webhookUrl);
-    _preferences.putString(PREF_KEY_MODE, _displayMode);
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        webhookKey(i, key, sizeof(key));
+        if (i < _sourceCount) {
+            _preferences.putString(key, _sources[i].url());
+        } else if (_preferences.isKey(key)) {
+            _preferences.remove(key);
+        }
+    }
+    _preferences.putString(PREF_KEY_MODE, modeName(_displayMode));
     _preferences.end();
 }
 
-void NetworkManager::_setupTLS() {
-    // Use the ISRG Root X1 CA by default (covers Let's Encrypt)
-    // For Anthropic direct API, Amazon Root CA 1 is needed
-    _secureClient.setCACert(ROOT_CA_ISRG);
+void NetworkManager::_setSources(const char* urls) {
+    char url[WEBHOOK_URL_MAX + 1];
+
+    for (uint8_t i = 0; i < MAX_SOURCES; i++) {
+        _sources[i].clear();
+    }
+    _sourceCount = 0;
+    _phaseEwmaSeeded = 0;
+
+    const char* separators = " \t\r\n,";
+    const char* p = urls + strspn(urls, separators);
+    while (*p) {
+        size_t len = strcspn(p, separators);
+        if (_sourceCount == MAX_SOURCES) {
+            log_w("More than %u webhooks configured, ignoring the rest", MAX_SOURCES);
+            break;
+        }
+        if (len > WEBHOOK_URL_MAX) {
+            log_w("Webhook URL longer than %u characters ignored", WEBHOOK_URL_MAX);
+        } else {
+            memcpy(url, p, len);
+            url[len] = '\0';
+            _sources[_sourceCount++].configure(url, rootCaFor(url));
+        }
+        p += len;
+        p += strspn(p, separators);
+    }
+}
+
+uint8_t NetworkManager::_groupSources(unsigned long deadline) {
+    uint8_t groups = 0;
+
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        uint8_t g = 0;
+        while (g < groups && !_workers[g].group[0]->sameEndpoint(_sources[i])) {
+            g++;
+        }
+        if (g == groups) {
+            _workers[g].count = 0;
+            _workers[g].deadline = deadline;
+            groups++;
+        }
+        _workers[g].group[_workers[g].count++] = &_sources[i];
+    }
+
+    return groups;
+}
+
+bool NetworkManager::_ensureWorker(uint8_t index) {
+    Worker& worker = _workers[index];
+    if (worker.task) {
+        return true;
+    }
+
+    // Created on first use and kept: stacks are allocated once, not per poll
+    if (!worker.start) {
+        worker.start = xSemaphoreCreateBinary();
+        if (!worker.start) return false;
+    }
 
-    // If webhook URL points to api.anthropic.com, switch to Amazon CA
-    if (_webhookUrl.indexOf("anthropic.com") >= 0) {
-        _secureClient.setCACert(ROOT_CA_AMAZON);
+    char name[12];
+    snprintf(name, sizeof(name), "fetch%u", index);
+    if (xTaskCreate(_workerTask, name, WORKER_STACK_SIZE, &worker, 1, &worker.task) != pdPASS) {
+        worker.task = nullptr;
+        log_e("Could not start %s, fetching inline", name);
+        return false;
+    }
+    return true;
+}
+
+void NetworkManager::_completePoll() {
+    PollResult& result = _pollResult;
+    result.sourceCount = _sourceCount;
+    result.success = true;
+
+    for (uint8_t g = 0; g < _groupCount; g++) {
+        const Worker& worker = _workers[g];
+        for (uint8_t k = 0; k < worker.count; k++) {
+            const Source& source = *worker.group[k];
+            FetchResult& fetched = result.sources[&source - _sources];
+
+            if (!worker.busy) {
+                fetched = source.result();
+                if (fetched.success) {
+                    _updatePhaseAverages(&source - _sources, fetched);
+                }
+                continue;
+            }
+
+            // Abandoned: the worker still owns the source, so report where
+            // it is stuck rather than reading its result
+            memset(&fetched, 0, sizeof(fetched));
+            fetched.httpCode = _cancel ? HTTP_ERR_CANCELLED : HTTP_ERR_TIMEOUT;
+            fetched.errorMsg = ERR_TLS;
+            fetched.elapsedMs = millis() - _pollStarted;
+            fetched.failedPhase = source.phase();
+        }
     }
+
+    // The cycle takes as long as its slowest fetch
+    result.elapsedMs = 0;
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        if (result.sources[i].elapsedMs > result.elapsedMs) {
+            result.elapsedMs = result.sources[i].elapsedMs;
+        }
+    }
+
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        if (!result.sources[i].success && result.success) {
+            result.success = false;
+            result.httpCode = result.sources[i].httpCode;
+            result.errorMsg = result.sources[i].errorMsg;
+        }
+    }
+
+    if (result.success) {
+        // Every path just worked — remember it for the next boot
+        _updateNetCache();
+
+        if (_fastAttempted) {
+            _renewLease();
+        }
+    }
+}
+
+void NetworkManager::_renewLease() {
+    // The borrowed lease got the first poll out; hand the address back to
+    // DHCP so the server can confirm it (or assign another) before a
+    // stale or reused lease can collide. The next poll is an interval
+    // away, and _updateNetCache() then stores whatever DHCP granted.
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    _fastAttempted = false;
+    log_i("Fast reconnect done — renewing the lease over DHCP");
+}
+
+void NetworkManager::_updatePhaseAverages(uint8_t source, const FetchResult& fetched) {
+    uint16_t* average = _phaseEwmaMs[source];
+
+    // The first sample seeds the averages instead of being damped from 0
+    if (!(_phaseEwmaSeeded & (1 << source))) {
+        _phaseEwmaSeeded |= 1 << source;
+        memcpy(average, fetched.phaseMs, sizeof(fetched.phaseMs));
+        return;
+    }
+
+    for (uint8_t p = 0; p < PHASE_COUNT; p++) {
+        // Integer EWMA; a shift keeps it cheap and free of float
+        int32_t delta = (int32_t)fetched.phaseMs[p] - average[p];
+        average[p] = (uint16_t)(average[p] + delta / (1 << PHASE_EWMA_SHIFT));
+    }
+}
+
+void NetworkManager::_loadNetCache() {
+    memset(&_netCache, 0, sizeof(_netCache));
+
+    _preferences.begin(PREF_NAMESPACE, true);  // read-only
+    if (_preferences.getBytesLength(PREF_KEY_NET_CACHE) == sizeof(_netCache)) {
+        _preferences.getBytes(PREF_KEY_NET_CACHE, &_netCache, sizeof(_netCache));
+    }
+    _preferences.end();
+
+    if (_netCache.magic != NET_CACHE_MAGIC) {
+        memset(&_netCache, 0, sizeof(_netCache));
+        return;
+    }
+
+    // A cached address is only good for the host it was resolved from
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        if (_netCache.hostHash[i] == fnv1a(_sources[i].host())) {
+            _sources[i].setHostIp(IPAddress(_netCache.hostIp[i]));
+        }
+    }
+}
+
+void NetworkManager::_updateNetCache() {
+    NetCache fresh;
+    memset(&fresh, 0, sizeof(fresh));
+
+    // Nothing to cache while DHCP is still (re)acquiring an address
+    if ((uint32_t)WiFi.localIP() == 0) {
+        return;
+    }
+
+    fresh.magic = NET_CACHE_MAGIC;
+    memcpy(fresh.bssid, WiFi.BSSID(), sizeof(fresh.bssid));
+    fresh.channel = (uint8_t)WiFi.channel();
+    fresh.localIp = WiFi.localIP();
+    fresh.gateway = WiFi.gatewayIP();
+    fresh.subnet = WiFi.subnetMask();
+    fresh.dns = WiFi.dnsIP();
+    for (uint8_t i = 0; i < _sourceCount; i++) {
+        fresh.hostHash[i] = fnv1a(_sources[i].host());
+        fresh.hostIp[i] = _sources[i].hostIp();
+    }
+
+    // Only touch flash when something actually changed (roaming, new lease,
+    // new webhook address) — a steady network never rewrites the record
+    if (memcmp(&fresh, &_netCache, sizeof(fresh)) == 0) {
+        return;
+    }
+
+    _preferences.begin(PREF_NAMESPACE, false);  // read-write
+    _preferences.putBytes(PREF_KEY_NET_CACHE, &fresh, sizeof(fresh));
+    _preferences.end();
+    _netCache = fresh;
+
+    log_i("Network cache updated — channel %u, %u host address(es)",
+          fresh.channel, _sourceCount);
 }
@@ -1,74 +1,161 @@
 #include "parser.h"
+#include "inflate.h"
+#include "rollup.h"
 
 // ============================================================================
 // JSON Parser Implementation
 // ============================================================================
 
-MeterData Parser::parseWebhookResponse(const String& json) {
-    MeterData data = { false, 0.0f, "flat", {0, 0, 0, 0, 0} };
+// ---------------------------------------------------------------------------
+// Static arena allocator for JsonDocument
+// ---------------------------------------------------------------------------
+// Bump allocator over a fixed buffer. Each block carries a small size header
+// so reallocate() can copy when the block is not the most recent one; the
+// most recent block grows and shrinks in place, which covers ArduinoJson's
+// string builder and its final shrinkToFit(). deallocate() only reclaims the
+// most recent block — everything else is released by reset() before the
+// next parse.
+class ArenaAllocator : public ArduinoJson::Allocator {
+public:
+    ArenaAllocator() : _used(0), _last(nullptr) {}
 
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, json);
+    void reset() {
+        _used = 0;
+        _last = nullptr;
+    }
 
-    if (err) {
-        log_e("Webhook JSON parse error: %s", err.c_str());
-        return data;
+    void* allocate(size_t size) override {
+        size_t need = _align(sizeof(size_t) + size);
+        if (_used + need > sizeof(_buf)) return nullptr;
+        uint8_t* block = _buf + _used;
+        *(size_t*)block = size;
+        _used += need;
+        _last = block;
+        return block + sizeof(size_t);
     }
 
-    data.valid = true;
-    data.costUsd = doc["cost_usd"] | 0.0f;
-    data.trend = doc["trend"] | "flat";
+    void deallocate(void* ptr) override {
+        if (ptr && _header(ptr) == _last) {
+            _used = _last - _buf;
+            _last = nullptr;
+        }
+    }
 
-    // Optional token fields from n8n
-    data.tokens.totalTokens = doc["tokens_total"] | (uint64_t)0;
-    data.tokens.uncachedInputTokens = doc["uncached_input_tokens"] | (uint64_t)0;
-    data.tokens.outputTokens = doc["output_tokens"] | (uint64_t)0;
-    data.tokens.cacheCreationTokens = doc["cache_creation_input_tokens"] | (uint64_t)0;
-    data.tokens.cacheReadTokens = doc["cache_read_input_tokens"] | (uint64_t)0;
+    void* reallocate(void* ptr, size_t newSize) override {
+        if (!ptr) return allocate(newSize);
 
-    // If total wasn't provided but individual fields were, compute it
-    if (data.tokens.totalTokens == 0) {
-        data.tokens.totalTokens =
-            data.tokens.uncachedInputTokens +
-            data.tokens.outputTokens +
-            data.tokens.cacheCreationTokens +
-            data.tokens.cacheReadTokens;
+        uint8_t* block = _header(ptr);
+        if (block == _last) {
+            size_t need = _align(sizeof(size_t) + newSize);
+            if ((size_t)(block - _buf) + need > sizeof(_buf)) return nullptr;
+            *(size_t*)block = newSize;
+            _used = (block - _buf) + need;
+            return ptr;
+        }
+
+        size_t oldSize = *(size_t*)block;
+        void* moved = allocate(newSize);
+        if (moved) memcpy(moved, ptr, oldSize < newSize ? oldSize : newSize);
+        return moved;
     }
 
-    return data;
-}
+private:
+    alignas(8) uint8_t _buf[JSON_ARENA_SIZE];
+    size_t _used;
+    uint8_t* _last;
 
-MeterData Parser::parseAnthropicUsage(const String& json) {
-    MeterData data = { false, 0.0f, "flat", {0, 0, 0, 0, 0} };
+    static size_t _align(size_t n) { return (n + 7) & ~(size_t)7; }
+    static uint8_t* _header(void* ptr) { return (uint8_t*)ptr - sizeof(size_t); }
+};
 
-    // Build a filter document to extract only the token fields we need.
+static ArenaAllocator jsonArena;
+
+#if HTTP_ACCEPT_GZIP
+// Window and decoder state for compressed bodies (~43 KB), kept static
+// like the arena so a poll never needs that much contiguous heap
+static InflateReader inflateReader;
+#endif
+
+// ---------------------------------------------------------------------------
+
+MeterData Parser::parse(const char* payload, size_t length, PayloadFormat format,
+                        PayloadEncoding encoding, Rollup* rollup) {
+    MeterData data = {};
+    unsigned long started = micros();
+
+    jsonArena.reset();
+
+    // Build a filter document to extract only the fields we need.
     // This discards ~90% of the API response payload before deserialization,
     // critical for staying within ESP32 heap limits.
-    JsonDocument filter;
+    JsonDocument filter(&jsonArena);
+    filter["cost_usd"] = true;
+    filter["trend"] = true;
+    filter["tokens_total"] = true;
+    filter["uncached_input_tokens"] = true;
+    filter["output_tokens"] = true;
+    filter["cache_creation_input_tokens"] = true;
+    filter["cache_read_input_tokens"] = true;
+    filter["data"][0]["starting_at"] = true;
+    filter["data"][0]["ending_at"] = true;
     filter["data"][0]["results"]["uncached_input_tokens"] = true;
     filter["data"][0]["results"]["output_tokens"] = true;
     filter["data"][0]["results"]["cache_creation_input_tokens"] = true;
     filter["data"][0]["results"]["cache_read_input_tokens"] = true;
 
-    JsonDocument doc;
-    DeserializationError err = deserializeJson(doc, json,
-        DeserializationOption::Filter(filter));
+    JsonDocument doc(&jsonArena);
+    DeserializationError err;
+    size_t inflated = length;
+
+    if (encoding == ENCODING_IDENTITY) {
+        err = (format == FORMAT_MSGPACK)
+            ? deserializeMsgPack(doc, payload, length, DeserializationOption::Filter(filter))
+            : deserializeJson(doc, payload, length, DeserializationOption::Filter(filter));
+    } else {
+#if HTTP_ACCEPT_GZIP
+        // The parser pulls decompressed bytes as it goes; the inflated text
+        // never exists in full
+        InflateReader& reader = inflateReader;
+        if (!reader.begin((const uint8_t*)payload, length, encoding == ENCODING_GZIP)) {
+            log_e("Malformed gzip header");
+            return data;
+        }
+        err = (format == FORMAT_MSGPACK)
+            ? deserializeMsgPack(doc, reader, DeserializationOption::Filter(filter))
+            : deserializeJson(doc, reader, DeserializationOption::Filter(filter));
+        if (reader.failed()) {
+            return data;
+        }
+        inflated = reader.inflatedBytes();
+#else
+        log_e("Compressed response received but HTTP_ACCEPT_GZIP is off");
+        return data;
+#endif
+    }
 
     if (err) {
-        log_e("Anthropic JSON parse error: %s", err.c_str());
+        log_e("%s parse error: %s", formatName(format), err.c_str());
         return data;
     }
 
-    JsonArray dataArray = doc["data"].as<JsonArray>();
-    if (dataArray.isNull() || dataArray.size() == 0) {
-        log_e("Anthropic response: empty 'data' array");
+    // Misconfigured workflows return bare values, arrays or fields of the
+    // wrong type; reject those rather than showing a bogus zero
+    JsonObjectConst root = doc.as<JsonObjectConst>();
+    if (root.isNull()) {
+        log_e("Response is not a %s object", formatName(format));
         return data;
     }
 
-    data.tokens = _sumTokens(dataArray);
-    data.costUsd = computeCost(data.tokens);
-    data.valid = true;
+    // Usage reports are recognised by their top-level "data" array
+    if (!root["data"].isNull()) {
+        data = _fromUsageReport(root, rollup);
+    } else {
+        data = _fromWebhook(root);
+    }
 
+    log_i("Decoded %u-byte %s payload (%u inflated) in %lu us",
+          (unsigned)length, formatName(format), (unsigned)inflated,
+          micros() - started);
     return data;
 }
 
@@ -98,24 +185,170 @@ float Parser::computeCost(const TokenUsage& usage, const char* model) {
     return cost;
 }
 
-TokenUsage Parser::_sumTokens(JsonArray dataArray) {
-    TokenUsage total = {0, 0, 0, 0, 0};
+MeterData Parser::combine(const MeterData* parts, uint8_t count) {
+    MeterData data = {};
+    data.valid = true;
+    bool anyUp = false;
+    bool anyDown = false;
+
+    if (count > MAX_SOURCES) count = MAX_SOURCES;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const MeterData& part = parts[i];
+        data.valid = data.valid && part.valid;
+        data.costUsd += part.costUsd;
+        data.sourceCostUsd[i] = part.costUsd;
+
+        _accumulate(data.tokens, part.tokens);
+        data.tokens.totalTokens = _addSaturating(data.tokens.totalTokens,
+                                                 part.tokens.totalTokens);
+
+        anyUp = anyUp || part.trend == TREND_UP;
+        anyDown = anyDown || part.trend == TREND_DOWN;
+    }
+
+    data.sourceCount = count;
+    if (anyUp && !anyDown) data.trend = TREND_UP;
+    if (anyDown && !anyUp) data.trend = TREND_DOWN;
+
+    return data;
+}
+
+const char* Parser::formatName(PayloadFormat format) {
+    return format == FORMAT_MSGPACK ? "MessagePack" : "JSON";
+}
+
+const char* Parser::trendName(Trend trend) {
+    switch (trend) {
+        case TREND_UP:   return "up";
+        case TREND_DOWN: return "down";
+        default:         return "flat";
+    }
+}
+
+MeterData Parser::_fromWebhook(JsonObjectConst root) {
+    MeterData data = {};
+
+    JsonVariantConst cost = root["cost_usd"];
+    if (!cost.isNull()) {
+        data.costUsd = cost.as<float>();
+        if (!cost.is<float>() || !isfinite(data.costUsd) || data.costUsd < 0.0f) {
+            log_e("Webhook field 'cost_usd' is not a valid amount");
+            data.costUsd = 0.0f;
+            return data;
+        }
+    }
 
-    for (JsonObject entry : dataArray) {
-        JsonObject results = entry["results"];
+    data.trend = _parseTrend(root["trend"] | "flat");
+
+    // Optional token fields from n8n
+    if (!_readCount(root, "tokens_total", data.tokens.totalTokens) ||
+        !_readCount(root, "uncached_input_tokens", data.tokens.uncachedInputTokens) ||
+        !_readCount(root, "output_tokens", data.tokens.outputTokens) ||
+        !_readCount(root, "cache_creation_input_tokens", data.tokens.cacheCreationTokens) ||
+        !_readCount(root, "cache_read_input_tokens", data.tokens.cacheReadTokens)) {
+        return data;
+    }
+
+    // If total wasn't provided but individual fields were, compute it
+    if (data.tokens.totalTokens == 0) {
+        data.tokens.totalTokens = _totalOf(data.tokens);
+    }
+
+    data.valid = true;
+    return data;
+}
+
+MeterData Parser::_fromUsageReport(JsonObjectConst root, Rollup* rollup) {
+    MeterData data = {};
+
+    JsonArrayConst dataArray = root["data"].as<JsonArrayConst>();
+    if (dataArray.isNull() || dataArray.size() == 0) {
+        log_e("Anthropic response: empty 'data' array");
+        return data;
+    }
+
+    if (!_sumTokens(dataArray, data.tokens, rollup)) {
+        return data;
+    }
+    data.costUsd = computeCost(data.tokens);
+    data.valid = true;
+
+    return data;
+}
+
+Trend Parser::_parseTrend(const char* text) {
+    if (strcmp(text, "up") == 0) return TREND_UP;
+    if (strcmp(text, "down") == 0) return TREND_DOWN;
+    return TREND_FLAT;
+}
+
+bool Parser::_sumTokens(JsonArrayConst dataArray, TokenUsage& total, Rollup* rollup) {
+    total = {0, 0, 0, 0, 0};
+
+    for (JsonVariantConst entry : dataArray) {
+        // The filter turns entries of the wrong shape into null
+        JsonVariantConst results = entry["results"];
         if (results.isNull()) continue;
 
-        total.uncachedInputTokens  += results["uncached_input_tokens"] | (uint64_t)0;
-        total.outputTokens         += results["output_tokens"] | (uint64_t)0;
-        total.cacheCreationTokens  += results["cache_creation_input_tokens"] | (uint64_t)0;
-        total.cacheReadTokens      += results["cache_read_input_tokens"] | (uint64_t)0;
+        TokenUsage bucket = {0, 0, 0, 0, 0};
+        JsonObjectConst fields = results.as<JsonObjectConst>();
+        if (fields.isNull() ||
+            !_readCount(fields, "uncached_input_tokens", bucket.uncachedInputTokens) ||
+            !_readCount(fields, "output_tokens", bucket.outputTokens) ||
+            !_readCount(fields, "cache_creation_input_tokens", bucket.cacheCreationTokens) ||
+            !_readCount(fields, "cache_read_input_tokens", bucket.cacheReadTokens)) {
+            log_e("Anthropic response: malformed 'results' entry");
+            return false;
+        }
+
+        _accumulate(total, bucket);
+
+        // Only hour-wide buckets feed the window history
+        uint32_t startsAt, endsAt;
+        if (rollup != nullptr &&
+            Rollup::parseTime(entry["starting_at"] | "", startsAt) &&
+            Rollup::parseTime(entry["ending_at"] | "", endsAt) &&
+            endsAt - startsAt == 3600) {
+            rollup->record(startsAt, bucket);
+        }
     }
 
-    total.totalTokens =
-        total.uncachedInputTokens +
-        total.outputTokens +
-        total.cacheCreationTokens +
-        total.cacheReadTokens;
+    total.totalTokens = _totalOf(total);
+    return true;
+}
+
+bool Parser::_readCount(JsonObjectConst object, const char* key, uint64_t& out) {
+    JsonVariantConst value = object[key];
+
+    // Absent fields are optional; anything present must be an integer that
+    // fits in 0..UINT64_MAX (no negatives, fractions, strings or overflow)
+    if (value.isNull()) {
+        out = 0;
+        return true;
+    }
+    if (!value.is<uint64_t>()) {
+        log_e("Field '%s' is not a token count", key);
+        return false;
+    }
+
+    out = value.as<uint64_t>();
+    return true;
+}
+
+uint64_t Parser::_addSaturating(uint64_t a, uint64_t b) {
+    return (a > UINT64_MAX - b) ? UINT64_MAX : a + b;
+}
+
+void Parser::_accumulate(TokenUsage& total, const TokenUsage& part) {
+    total.uncachedInputTokens = _addSaturating(total.uncachedInputTokens, part.uncachedInputTokens);
+    total.outputTokens        = _addSaturating(total.outputTokens, part.outputTokens);
+    total.cacheCreationTokens = _addSaturating(total.cacheCreationTokens, part.cacheCreationTokens);
+    total.cacheReadTokens     = _addSaturating(total.cacheReadTokens, part.cacheReadTokens);
+}
 
-    return total;
+uint64_t Parser::_totalOf(const TokenUsage& usage) {
+    uint64_t total = _addSaturating(usage.uncachedInputTokens, usage.outputTokens);
+    total = _addSaturating(total, usage.cacheCreationTokens);
+    return _addSaturating(total, usage.cacheReadTokens);
 }
@@ -0,0 +1,284 @@
+#include "relay.h"
+#include <mbedtls/md.h>
+#include <time.h>
+
+// ============================================================================
+// Relay Implementation
+// ============================================================================
+
+#define RELAY_MAGIC  0x434D5232   // "CMR2"
+
+// Packet flags
+#define RELAY_FLAG_NO_READING  0x01   // Leader heartbeat before its first poll
+
+// Clock values before this are "not synced yet" (2023-11-14)
+#define RELAY_MIN_VALID_TIME  1700000000UL
+
+static const char* const ERROR_CODES[] = {
+    ERR_WIFI, ERR_TLS, ERR_API, ERR_JSON, ERR_HTTP
+};
+#define ERROR_CODE_COUNT  (sizeof(ERROR_CODES) / sizeof(ERROR_CODES[0]))
+
+static uint32_t syncedTime() {
+    time_t now = time(nullptr);
+    return now >= (time_t)RELAY_MIN_VALID_TIME ? (uint32_t)now : 0;
+}
+
+Relay::Relay()
+    : _joined(false)
+    , _configured(false)
+    , _group(0)
+    , _nodeId(0)
+    , _bootId(0)
+    , _seq(0)
+    , _leading(false)
+    , _lastHeartbeat(0)
+    , _leaderId(0)
+    , _leaderBoot(0)
+    , _leaderSeq(0)
+    , _leaderReading(0)
+    , _leaderSeen(0)
+    , _leaderError(ERR_HTTP)
+{
+    memset(_key, 0, sizeof(_key));
+    memset(&_current, 0, sizeof(_current));
+}
+
+void Relay::configure(const char* const urls[], uint8_t count) {
+    const mbedtls_md_info_t* sha256 = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    static const char label[] = "ClaudeMeter relay v1";
+
+    // key = HMAC-SHA256("ClaudeMeter relay v1", url0 '\n' url1 ...)
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, sha256, 1);
+    mbedtls_md_hmac_starts(&ctx, (const uint8_t*)label, sizeof(label) - 1);
+    for (uint8_t i = 0; i < count; i++) {
+        mbedtls_md_hmac_update(&ctx, (const uint8_t*)urls[i], strlen(urls[i]));
+        mbedtls_md_hmac_update(&ctx, (const uint8_t*)"\n", 1);
+    }
+    mbedtls_md_hmac_finish(&ctx, _key);
+    mbedtls_md_free(&ctx);
+
+    uint8_t digest[32];
+    mbedtls_md_hmac(sha256, _key, sizeof(_key), (const uint8_t*)"group", 5, digest);
+    memcpy(&_group, digest, sizeof(_group));
+
+    _nodeId = (uint32_t)ESP.getEfuseMac();
+    _bootId = esp_random();
+    _configured = count > 0;
+    _leaderSeen = millis();
+
+    log_i("Relay: node %08x, group %08x", _nodeId, _group);
+}
+
+RelayEvent Relay::update(MeterData& reading) {
+    if (!_configured) {
+        return RELAY_IDLE;
+    }
+
+    // (Re)join the group whenever WiFi comes back
+    if (WiFi.status() != WL_CONNECTED) {
+        if (_joined) {
+            _udp.stop();
+            _joined = false;
+        }
+        return RELAY_IDLE;
+    }
+    if (!_joined) {
+        _joined = _udp.beginMulticast(RELAY_GROUP, RELAY_PORT);
+        if (!_joined) return RELAY_IDLE;
+
+        // A running leader is heard within two heartbeats; don't make a
+        // lone meter wait the full timeout for its first poll
+        _leaderSeen = millis() - (RELAY_LEADER_TIMEOUT_MS - 2 * RELAY_HEARTBEAT_MS);
+    }
+
+    RelayEvent event = RELAY_IDLE;
+    Packet packet;
+
+    while (_receive(packet)) {
+        if (packet.nodeId == _nodeId) continue;   // Our own multicast echo
+
+        if (_leading) {
+            if (packet.nodeId > _nodeId) continue;   // It will step down
+            log_i("Relay: node %08x outranks us, following", packet.nodeId);
+            _leading = false;
+        } else if (packet.nodeId != _leaderId &&
+                   packet.nodeId > _leaderId && _leaderId != 0 &&
+                   millis() - _leaderSeen < RELAY_LEADER_TIMEOUT_MS) {
+            continue;   // Our current leader outranks this one
+        }
+
+        // New leader, or a new boot of the current one: start its stream
+        if (packet.nodeId != _leaderId || packet.bootId != _leaderBoot) {
+            log_i("Relay: following node %08x", packet.nodeId);
+            _leaderId = packet.nodeId;
+            _leaderBoot = packet.bootId;
+            _leaderReading = packet.readingId - 1;
+        } else if ((int32_t)(packet.seq - _leaderSeq) <= 0) {
+            continue;   // Replayed or reordered
+        }
+        _leaderSeq = packet.seq;
+        _leaderSeen = millis();
+
+        if (packet.flags & RELAY_FLAG_NO_READING) continue;   // Keep the last
+        if (packet.readingId == _leaderReading) continue;   // Heartbeat
+        _leaderReading = packet.readingId;
+        _current = packet;
+
+        if (packet.error != 0) {
+            _leaderError = ERROR_CODES[packet.error - 1];
+            event = RELAY_LEADER_ERROR;
+        } else {
+            reading = {};
+            reading.valid = true;
+            reading.costUsd = packet.costUsd;
+            reading.trend = (Trend)packet.trend;
+            reading.tokens.uncachedInputTokens = packet.tokens[0];
+            reading.tokens.outputTokens = packet.tokens[1];
+            reading.tokens.cacheCreationTokens = packet.tokens[2];
+            reading.tokens.cacheReadTokens = packet.tokens[3];
+            reading.tokens.totalTokens = packet.tokens[4];
+            reading.sourceCount = packet.sourceCount;
+            event = RELAY_READING;
+        }
+    }
+
+    // Lower node IDs take over sooner, so one promotes before the others
+    if (!_leading &&
+        millis() - _leaderSeen > RELAY_LEADER_TIMEOUT_MS + (_nodeId & 0x0FFF)) {
+        log_i("Relay: no leader for %lu ms, taking over", millis() - _leaderSeen);
+        _leading = true;
+        _leaderId = 0;
+        _announce();
+        return RELAY_PROMOTED;
+    }
+
+    if (_leading && millis() - _lastHeartbeat >= RELAY_HEARTBEAT_MS) {
+        _send();
+    }
+
+    return event;
+}
+
+bool Relay::isLeader() const {
+    return _leading || !_configured;
+}
+
+void Relay::publish(const MeterData& reading) {
+    if (!_leading) return;
+
+    _current.readingId++;
+    _current.flags = 0;
+    _current.error = 0;
+    _current.trend = reading.trend;
+    _current.sourceCount = reading.sourceCount;
+    _current.costUsd = reading.costUsd;
+    _current.tokens[0] = reading.tokens.uncachedInputTokens;
+    _current.tokens[1] = reading.tokens.outputTokens;
+    _current.tokens[2] = reading.tokens.cacheCreationTokens;
+    _current.tokens[3] = reading.tokens.cacheReadTokens;
+    _current.tokens[4] = reading.tokens.totalTokens;
+    _send();
+}
+
+void Relay::publishError(const char* errorCode) {
+    if (!_leading) return;
+
+    _current.readingId++;
+    _current.flags = 0;
+    _current.error = _errorIndex(errorCode) + 1;
+    _send();
+}
+
+const char* Relay::leaderError() const {
+    return _leaderError;
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+void Relay::_announce() {
+    // Drop the reading copied from the previous leader; until our own first
+    // poll lands, heartbeats only claim the lead
+    uint32_t readingId = _current.readingId;
+    memset(&_current, 0, sizeof(_current));
+    _current.readingId = readingId;
+    _current.flags = RELAY_FLAG_NO_READING;
+    _send();
+}
+
+void Relay::_send() {
+    _lastHeartbeat = millis();
+    if (!_joined) return;
+
+    Packet& packet = _current;
+    packet.magic = RELAY_MAGIC;
+    packet.group = _group;
+    packet.nodeId = _nodeId;
+    packet.bootId = _bootId;
+    packet.seq = ++_seq;
+    packet.timestamp = syncedTime();
+    _sign(packet, packet.mac);
+
+    _udp.beginPacket(RELAY_GROUP, RELAY_PORT);
+    _udp.write((const uint8_t*)&packet, sizeof(packet));
+    _udp.endPacket();
+}
+
+bool Relay::_receive(Packet& packet) {
+    while (true) {
+        int size = _udp.parsePacket();
+        if (size <= 0) return false;
+
+        if (size != sizeof(Packet) ||
+            _udp.read((uint8_t*)&packet, sizeof(packet)) != (int)sizeof(packet) ||
+            packet.magic != RELAY_MAGIC || packet.group != _group) {
+            continue;   // Not ours
+        }
+
+        // Constant-time compare so the MAC cannot be guessed bytewise
+        uint8_t mac[RELAY_MAC_LENGTH];
+        uint8_t diff = 0;
+        _sign(packet, mac);
+        for (uint8_t i = 0; i < RELAY_MAC_LENGTH; i++) {
+            diff |= mac[i] ^ packet.mac[i];
+        }
+        if (diff != 0) {
+            log_w("Relay: bad signature from %s", _udp.remoteIP().toString().c_str());
+            continue;
+        }
+
+        if (packet.error > ERROR_CODE_COUNT || !_fresh(packet)) {
+            continue;
+        }
+        return true;
+    }
+}
+
+void Relay::_sign(const Packet& packet, uint8_t mac[RELAY_MAC_LENGTH]) const {
+    uint8_t digest[32];
+    mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                    _key, sizeof(_key),
+                    (const uint8_t*)&packet, offsetof(Packet, mac), digest);
+    memcpy(mac, digest, RELAY_MAC_LENGTH);
+}
+
+bool Relay::_fresh(const Packet& packet) const {
+    // Only enforceable when both clocks are synced
+    uint32_t now = syncedTime();
+    if (now == 0 || packet.timestamp == 0) return true;
+
+    uint32_t skew = now > packet.timestamp ? now - packet.timestamp
+                                           : packet.timestamp - now;
+    return skew <= RELAY_MAX_SKEW_S;
+}
+
+uint8_t Relay::_errorIndex(const char* errorCode) {
+    for (uint8_t i = 0; i < ERROR_CODE_COUNT; i++) {
+        if (strcmp(errorCode, ERROR_CODES[i]) == 0) return i;
+    }
+    return ERROR_CODE_COUNT - 1;   // ERR_HTTP
+}
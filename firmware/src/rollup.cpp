@@ -0,0 +1,201 @@
+#include "rollup.h"
+
+// ============================================================================
+// Rollup Implementation
+// ============================================================================
+
+// Month-to-date needs up to 31 days of history
+static_assert(ROLLUP_HOURS >= 31 * 24, "ROLLUP_HOURS must cover a month");
+
+#define HOURS_PER_WEEK  (7 * 24)
+
+// Clock values before this are "not synced yet" (2023-11-14)
+#define ROLLUP_MIN_VALID_TIME  1700000000UL
+
+// Days since 1970-01-01 of a proleptic Gregorian date (Howard Hinnant's
+// days_from_civil) and its inverse
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+static uint32_t dayOfMonth(int32_t days) {
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = (uint32_t)(days - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    return doy - (153 * mp + 2) / 5 + 1;
+}
+
+static uint32_t clamp32(uint64_t value) {
+    return value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+}
+
+Rollup::Rollup()
+    : _hour(0)
+    , _dayStart(0)
+    , _monthStart(0)
+    , _cycle(0)
+    , _hasData(false)
+{
+    memset(_buckets, 0, sizeof(_buckets));
+    memset(_totals, 0, sizeof(_totals));
+}
+
+void Rollup::beginCycle() {
+    _cycle++;
+}
+
+void Rollup::record(uint32_t hourStart, const TokenUsage& usage) {
+    uint32_t hour = hourStart / 3600;
+    if (hour > _hour) {
+        advance(hourStart);
+    }
+    if (hour + ROLLUP_HOURS <= _hour) {
+        return;  // Older than the ring
+    }
+
+    Bucket& bucket = _buckets[hour % ROLLUP_HOURS];
+    Bucket updated = { hour, _cycle, 0, 0, 0, 0 };
+
+    // Another source already reported this hour in this cycle: add to it
+    if (bucket.hour == hour && bucket.cycle == _cycle) {
+        updated = bucket;
+    }
+    updated.uncachedInputTokens = clamp32((uint64_t)updated.uncachedInputTokens + usage.uncachedInputTokens);
+    updated.outputTokens        = clamp32((uint64_t)updated.outputTokens + usage.outputTokens);
+    updated.cacheCreationTokens = clamp32((uint64_t)updated.cacheCreationTokens + usage.cacheCreationTokens);
+    updated.cacheReadTokens     = clamp32((uint64_t)updated.cacheReadTokens + usage.cacheReadTokens);
+
+    // Swap the old contribution for the new one in every window holding
+    // this hour. A slot still holding an older hour has already left them.
+    for (uint8_t w = 0; w < WINDOW_COUNT; w++) {
+        if (!_inWindow((RollupWindow)w, hour)) continue;
+        if (bucket.hour == hour) {
+            _apply(_totals[w], bucket, false);
+        }
+        _apply(_totals[w], updated, true);
+    }
+
+    bucket = updated;
+    _hasData = true;
+}
+
+void Rollup::advance(uint32_t now) {
+    uint32_t hour = now / 3600;
+    if (now < ROLLUP_MIN_VALID_TIME || hour <= _hour) {
+        return;
+    }
+
+    // Rolling windows: subtract the hours that slid out
+    _evict(WINDOW_HOUR, 1, hour);
+    _evict(WINDOW_WEEK, HOURS_PER_WEEK, hour);
+
+    // Calendar windows restart empty: nothing newer than the old clock has
+    // been recorded, so no bucket belongs to the new day or month yet
+    uint32_t dayStart = hour - hour % 24;
+    if (dayStart != _dayStart) {
+        _dayStart = dayStart;
+        memset(&_totals[WINDOW_TODAY], 0, sizeof(TokenUsage));
+    }
+    uint32_t monthStart = _monthStartHour(hour);
+    if (monthStart != _monthStart) {
+        _monthStart = monthStart;
+        memset(&_totals[WINDOW_MONTH], 0, sizeof(TokenUsage));
+    }
+
+    _hour = hour;
+}
+
+TokenUsage Rollup::total(RollupWindow window) const {
+    TokenUsage usage = _totals[window];
+    usage.totalTokens = usage.uncachedInputTokens + usage.outputTokens +
+                        usage.cacheCreationTokens + usage.cacheReadTokens;
+    return usage;
+}
+
+bool Rollup::hasData() const {
+    return _hasData;
+}
+
+const char* Rollup::windowName(RollupWindow window) {
+    switch (window) {
+        case WINDOW_HOUR:  return "1H";
+        case WINDOW_TODAY: return "DAY";
+        case WINDOW_WEEK:  return "7D";
+        default:           return "MTD";
+    }
+}
+
+bool Rollup::parseTime(const char* text, uint32_t& unixTime) {
+    int year, month, day, hour, minute = 0, second = 0;
+    if (sscanf(text, "%4d-%2d-%2dT%2d:%2d:%2d", &year, &month, &day,
+               &hour, &minute, &second) < 4) {
+        return false;
+    }
+    if (year < 1970 || month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    unixTime = (uint32_t)daysFromCivil(year, month, day) * 86400UL +
+               hour * 3600UL + minute * 60UL + second;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+bool Rollup::_inWindow(RollupWindow window, uint32_t hour) const {
+    if (hour > _hour) return false;
+
+    switch (window) {
+        case WINDOW_HOUR:  return hour == _hour;
+        case WINDOW_TODAY: return hour >= _dayStart;
+        case WINDOW_WEEK:  return hour + HOURS_PER_WEEK > _hour;
+        default:           return hour >= _monthStart;
+    }
+}
+
+void Rollup::_evict(RollupWindow window, uint32_t span, uint32_t newHour) {
+    // The window covers the last span hours. A jump at least that long (or
+    // the first clock setting) empties it outright.
+    if (_hour == 0 || newHour - _hour >= span) {
+        memset(&_totals[window], 0, sizeof(TokenUsage));
+        return;
+    }
+
+    // Otherwise hours [old start, new start) leave it
+    for (uint32_t hour = _hour + 1 - span; hour < newHour + 1 - span; hour++) {
+        const Bucket& bucket = _buckets[hour % ROLLUP_HOURS];
+        if (bucket.hour == hour) {
+            _apply(_totals[window], bucket, false);
+        }
+    }
+}
+
+void Rollup::_apply(TokenUsage& total, const Bucket& bucket, bool add) {
+    if (add) {
+        total.uncachedInputTokens += bucket.uncachedInputTokens;
+        total.outputTokens        += bucket.outputTokens;
+        total.cacheCreationTokens += bucket.cacheCreationTokens;
+        total.cacheReadTokens     += bucket.cacheReadTokens;
+    } else {
+        total.uncachedInputTokens -= bucket.uncachedInputTokens;
+        total.outputTokens        -= bucket.outputTokens;
+        total.cacheCreationTokens -= bucket.cacheCreationTokens;
+        total.cacheReadTokens     -= bucket.cacheReadTokens;
+    }
+}
+
+uint32_t Rollup::_monthStartHour(uint32_t hour) {
+    int32_t days = hour / 24;
+    return (uint32_t)(days - (int32_t)dayOfMonth(days) + 1) * 24;
+}
@@ -0,0 +1,538 @@
+#include "source.h"
+
+// ============================================================================
+// Source Implementation
+// ============================================================================
+
+// Budget of each FetchPhase (ms)
+static const uint32_t phaseBudgetMs[PHASE_COUNT] = {
+    HTTP_DNS_TIMEOUT_MS,
+    HTTP_CONNECT_TIMEOUT_MS,
+    HTTP_TLS_TIMEOUT_MS,
+    HTTP_FIRST_BYTE_TIMEOUT_MS,
+    HTTP_BODY_TIMEOUT_MS
+};
+
+Source::Source()
+    : _useTls(false),
+      _port(0),
+      _path("/"),
+      _rootCa(nullptr),
+      _format(FORMAT_JSON),
+      _encoding(ENCODING_IDENTITY),
+      _phase(PHASE_COUNT),
+      _phaseStarted(0),
+      _cancel(nullptr)
+{
+    clear();
+    // Without this the handshake may block for the library default (120 s)
+    _secureClient.setHandshakeTimeout((HTTP_TLS_TIMEOUT_MS + 999) / 1000);
+}
+
+void Source::configure(const char* url, const char* rootCa) {
+    clear();
+    strlcpy(_url, url, sizeof(_url));
+    _rootCa = rootCa;
+    _secureClient.setCACert(rootCa);
+
+    const char* p = _url;
+    if (strncmp(p, "https://", 8) == 0) {
+        _useTls = true;
+        _port = 443;
+        p += 8;
+    } else if (strncmp(p, "http://", 7) == 0) {
+        _useTls = false;
+        _port = 80;
+        p += 7;
+    } else {
+        return;
+    }
+
+    size_t hostLen = strcspn(p, ":/?");
+    if (hostLen == 0 || hostLen >= sizeof(_host)) {
+        return;
+    }
+    memcpy(_host, p, hostLen);
+    _host[hostLen] = '\0';
+    p += hostLen;
+
+    if (*p == ':') {
+        char* end;
+        _port = (uint16_t)strtoul(p + 1, &end, 10);
+        p = end;
+    }
+    if (*p == '/') {
+        _path = p;
+    }
+}
+
+void Source::clear() {
+    _url[0] = '\0';
+    _host[0] = '\0';
+    _path = "/";
+    _etag[0] = '\0';
+    _newEtag[0] = '\0';
+    _hostIp = IPAddress();
+    _hostIpAt = 0;
+    _payloadBuf[0] = '\0';
+    memset(&_result, 0, sizeof(_result));
+    memset(_phaseMs, 0, sizeof(_phaseMs));
+    _result.failedPhase = PHASE_COUNT;
+}
+
+const char* Source::url() const {
+    return _url;
+}
+
+const char* Source::host() const {
+    return _host;
+}
+
+bool Source::isUsable() const {
+    return _host[0] != '\0';
+}
+
+bool Source::sameEndpoint(const Source& other) const {
+    return _useTls == other._useTls &&
+           _port == other._port &&
+           strcasecmp(_host, other._host) == 0;
+}
+
+IPAddress Source::hostIp() const {
+    return _hostIp;
+}
+
+void Source::setHostIp(IPAddress ip) {
+    _hostIp = ip;
+    _hostIpAt = millis();
+}
+
+void Source::forgetValidator() {
+    _etag[0] = '\0';
+}
+
+const FetchResult& Source::result() const {
+    return _result;
+}
+
+FetchPhase Source::phase() const {
+    return _phase;
+}
+
+const char* Source::phaseName(FetchPhase phase) {
+    switch (phase) {
+        case PHASE_DNS:        return "DNS";
+        case PHASE_CONNECT:    return "connect";
+        case PHASE_TLS:        return "TLS";
+        case PHASE_FIRST_BYTE: return "first byte";
+        case PHASE_BODY:       return "body";
+        default:               return "none";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Pipelined group fetch
+// ---------------------------------------------------------------------------
+
+void Source::fetchGroup(Source* group[], size_t count, unsigned long sendAt,
+                        unsigned long deadline, const volatile bool* cancel) {
+    unsigned long started = millis();
+    Source& owner = *group[0];
+    Client& client = owner._client();
+    size_t next = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        group[i]->_cancel = cancel;
+        group[i]->_phase = PHASE_COUNT;
+        memset(group[i]->_phaseMs, 0, sizeof(group[i]->_phaseMs));
+    }
+
+    // Every round makes progress (a response or a recorded failure), so the
+    // loop is bounded by count rounds and by the shared deadline
+    while (next < count) {
+        int failure = owner._connect(deadline);
+        if (failure != 0) {
+            // Members waiting on the connection failed where the owner did
+            // (their clocks start now: they were not in that phase before)
+            for (; next < count; next++) {
+                if (group[next] != &owner) {
+                    group[next]->_phase = owner._phase;
+                    group[next]->_phaseStarted = millis();
+                }
+                group[next]->_finish(failure, 0, started);
+            }
+            break;
+        }
+
+        // Pre-warmed: hold the requests until their tick, off the clock
+        if ((long)(millis() - sendAt) < 0) {
+            owner._enterPhase(PHASE_COUNT);
+            unsigned long held = millis();
+            while ((long)(millis() - sendAt) < 0 && !(cancel != nullptr && *cancel)) {
+                delay(1);
+            }
+            started += millis() - held;
+        }
+        owner._enterPhase(PHASE_FIRST_BYTE);
+
+        // Pipeline: all requests go out before any response is read. The
+        // last one asks the server to close so the socket is not left open.
+        size_t sent = next;
+        while (sent < count && group[sent]->_sendRequest(client, sent + 1 < count)) {
+            sent++;
+        }
+        if (sent == next) {
+            group[next]->_finish(HTTP_ERR_SEND, 0, started);
+            next++;
+        }
+
+        while (next < sent) {
+            bool keepAlive = false;
+            size_t bodyLength = 0;
+            if (group[next]->_phase != PHASE_FIRST_BYTE) {
+                group[next]->_enterPhase(PHASE_FIRST_BYTE);
+            }
+            int code = group[next]->_readResponse(client, deadline, keepAlive);
+            if (code == 200) {
+                bodyLength = group[next]->_result.payloadLength;
+            }
+            group[next]->_finish(code, bodyLength, started);
+            next++;
+            if (!keepAlive) break;
+        }
+
+        client.stop();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// HTTP/1.1 client
+// ---------------------------------------------------------------------------
+
+Client& Source::_client() {
+    // Allow HTTP for local n8n instances on trusted networks
+    return _useTls ? static_cast<Client&>(_secureClient)
+                   : static_cast<Client&>(_plainClient);
+}
+
+void Source::_enterPhase(FetchPhase phase) {
+    unsigned long now = millis();
+    if (_phase < PHASE_COUNT) {
+        uint32_t total = _phaseMs[_phase] + (now - _phaseStarted);
+        _phaseMs[_phase] = total > UINT16_MAX ? UINT16_MAX : (uint16_t)total;
+    }
+    _phase = phase;
+    _phaseStarted = now;
+}
+
+unsigned long Source::_phaseDeadline(unsigned long groupDeadline) const {
+    unsigned long phaseEnd = _phaseStarted + phaseBudgetMs[_phase];
+    return (long)(phaseEnd - groupDeadline) < 0 ? phaseEnd : groupDeadline;
+}
+
+bool Source::_expired(unsigned long deadline) const {
+    return (long)(millis() - deadline) >= 0 || (_cancel != nullptr && *_cancel);
+}
+
+int Source::_stopCode() const {
+    return (_cancel != nullptr && *_cancel) ? HTTP_ERR_CANCELLED : HTTP_ERR_TIMEOUT;
+}
+
+int Source::_connect(unsigned long deadline) {
+    if ((uint32_t)_hostIp != 0 && millis() - _hostIpAt >= HOST_IP_MAX_AGE_MS) {
+        _hostIp = IPAddress();
+    }
+
+    if ((uint32_t)_hostIp != 0) {
+        int code = _open(deadline);
+        // Out of time or cancelled: re-resolving would not help
+        if (code != HTTP_ERR_CONNECT) return code;
+        log_w("Connect to cached %s failed, re-resolving", _hostIp.toString().c_str());
+    }
+
+    _enterPhase(PHASE_DNS);
+    IPAddress resolved;
+    bool ok = WiFi.hostByName(_host, resolved);
+    if (_expired(_phaseDeadline(deadline))) {
+        return _stopCode();
+    }
+    if (!ok) {
+        return HTTP_ERR_CONNECT;
+    }
+    setHostIp(resolved);
+    return _open(deadline);
+}
+
+int Source::_open(unsigned long deadline) {
+    _enterPhase(_useTls ? PHASE_TLS : PHASE_CONNECT);
+    unsigned long phaseDeadline = _phaseDeadline(deadline);
+    if (_expired(phaseDeadline)) {
+        return _stopCode();
+    }
+
+    // TLS still verifies the certificate against _host (SNI), so
+    // connecting by address never weakens validation. Its TCP connect gets
+    // what is left of the phase; the handshake after it is bounded by the
+    // handshake timeout set in the constructor.
+    int32_t budget = (int32_t)(phaseDeadline - millis());
+    bool ok;
+    if (_useTls) {
+        _secureClient.setConnectTimeout(budget);
+        ok = _secureClient.connect(_hostIp, _port, _host, _rootCa, nullptr, nullptr);
+    } else {
+        ok = _plainClient.connect(_hostIp, _port, budget);
+    }
+
+    if (_expired(phaseDeadline)) {
+        if (ok) _client().stop();
+        return _stopCode();
+    }
+    return ok ? 0 : HTTP_ERR_CONNECT;
+}
+
+bool Source::_sendRequest(Client& client, bool keepAlive) {
+    // Host header carries the port only when it is non-default
+    char portSuffix[8] = "";
+    if (_port != (_useTls ? 443 : 80)) {
+        snprintf(portSuffix, sizeof(portSuffix), ":%u", _port);
+    }
+
+    int len = snprintf(_requestBuf, sizeof(_requestBuf),
+        "GET %s HTTP/1.1\r\n"
+        "Host: %s%s\r\n"
+        "Accept: %s\r\n"
+        "%s"
+        "User-Agent: ClaudeCodeMeter/1.0 ESP32\r\n"
+        "%s%s%s"
+        "Connection: %s\r\n"
+        "\r\n",
+        _path, _host, portSuffix,
+        HTTP_ACCEPT_MSGPACK ? "application/msgpack, application/json;q=0.9"
+                            : "application/json",
+        HTTP_ACCEPT_GZIP ? "Accept-Encoding: gzip, deflate\r\n" : "",
+        _etag[0] ? "If-None-Match: " : "", _etag, _etag[0] ? "\r\n" : "",
+        keepAlive ? "keep-alive" : "close");
+
+    if (len <= 0 || (size_t)len >= sizeof(_requestBuf)) {
+        return false;
+    }
+    return client.write((const uint8_t*)_requestBuf, len) == (size_t)len;
+}
+
+int Source::_readResponse(Client& client, unsigned long deadline, bool& keepAlive) {
+    keepAlive = false;
+    _result.payloadLength = 0;
+    _format = FORMAT_JSON;
+    _encoding = ENCODING_IDENTITY;
+    _newEtag[0] = '\0';
+
+    // Status line: "HTTP/1.1 200 OK"
+    int n = _readLine(client, _phaseDeadline(deadline));
+    if (n < 0) {
+        return n;
+    }
+    if (n < 12 || strncmp(_lineBuf, "HTTP/1.", 7) != 0) {
+        return HTTP_ERR_PROTOCOL;
+    }
+    bool http11 = _lineBuf[7] == '1';
+    int httpCode = atoi(_lineBuf + 9);
+
+    _enterPhase(PHASE_BODY);
+    deadline = _phaseDeadline(deadline);
+
+    // Headers: body framing, connection reuse and the validator
+    size_t contentLength = SIZE_MAX;
+    bool chunked = false;
+    bool closing = !http11;
+    while ((n = _readLine(client, deadline)) > 0) {
+        if (strncasecmp(_lineBuf, "Content-Length:", 15) == 0) {
+            contentLength = strtoul(_lineBuf + 15, nullptr, 10);
+        } else if (strncasecmp(_lineBuf, "Transfer-Encoding:", 18) == 0) {
+            chunked = strstr(_lineBuf + 18, "chunked") != nullptr;
+        } else if (strncasecmp(_lineBuf, "Content-Type:", 13) == 0) {
+            // application/msgpack, application/x-msgpack, application/vnd.msgpack
+            if (strcasestr(_lineBuf + 13, "msgpack") != nullptr) {
+                _format = FORMAT_MSGPACK;
+            }
+        } else if (strncasecmp(_lineBuf, "Content-Encoding:", 17) == 0) {
+            if (strcasestr(_lineBuf + 17, "gzip") != nullptr) {
+                _encoding = ENCODING_GZIP;
+            } else if (strcasestr(_lineBuf + 17, "deflate") != nullptr) {
+                _encoding = ENCODING_DEFLATE;
+            }
+        } else if (strncasecmp(_lineBuf, "Connection:", 11) == 0) {
+            closing = strstr(_lineBuf + 11, "close") != nullptr;
+        } else if (httpCode == 200 && strncasecmp(_lineBuf, "ETag:", 5) == 0) {
+            const char* value = _lineBuf + 5;
+            while (*value == ' ') value++;
+            // An over-long validator is dropped rather than truncated
+            if (strlen(value) < sizeof(_newEtag)) {
+                strcpy(_newEtag, value);
+            }
+        }
+    }
+    if (n < 0) {
+        return n;
+    }
+
+    // 204 and 304 never carry a body
+    if (httpCode == 204 || httpCode == 304) {
+        keepAlive = !closing;
+        return httpCode;
+    }
+
+    // Error bodies are read too, so the next pipelined response lines up
+    size_t bodyLength = 0;
+    int bodyCode = _readBody(client, contentLength, chunked, deadline, bodyLength);
+    if (bodyCode != 200) {
+        // An unreadable error body still reports the server's status
+        return httpCode == 200 ? bodyCode : httpCode;
+    }
+
+    keepAlive = !closing && (chunked || contentLength != SIZE_MAX);
+    _result.payloadLength = bodyLength;
+    return httpCode;
+}
+
+void Source::_finish(int httpCode, size_t bodyLength, unsigned long started) {
+    FetchResult& r = _result;
+    r.success = false;
+    r.notModified = false;
+    r.httpCode = httpCode;
+    r.payload = nullptr;
+    r.payloadLength = 0;
+    r.format = FORMAT_JSON;
+    r.encoding = ENCODING_IDENTITY;
+    r.errorMsg = nullptr;
+    r.elapsedMs = millis() - started;
+
+    // Close the last phase's timer; a failure is pinned to the phase it hit
+    FetchPhase last = _phase;
+    _enterPhase(PHASE_COUNT);
+    memcpy(r.phaseMs, _phaseMs, sizeof(r.phaseMs));
+    r.failedPhase = PHASE_COUNT;
+
+    // Only a complete 200 may move the validator on. Any failure drops it,
+    // so the next fetch cannot get a 304 for a body the device never had.
+    if (httpCode == 200) {
+        strcpy(_etag, _newEtag);
+    } else if (httpCode != 304) {
+        _etag[0] = '\0';
+    }
+
+    if (httpCode == 200) {
+        r.success = true;
+        r.payload = _payloadBuf;
+        r.payloadLength = bodyLength;
+        r.format = _format;
+        r.encoding = _encoding;
+    } else if (httpCode == 304) {
+        r.success = true;
+        r.notModified = true;
+    } else if (httpCode == 401 || httpCode == 403) {
+        r.errorMsg = ERR_API;
+    } else if (httpCode == HTTP_ERR_TOO_LARGE) {
+        r.errorMsg = ERR_JSON;
+    } else if (httpCode < 0) {
+        // Transport failures (connect, handshake, timeout) are negative
+        r.errorMsg = ERR_TLS;
+        r.failedPhase = last;
+    } else {
+        r.errorMsg = ERR_HTTP;
+    }
+}
+
+int Source::_readLine(Client& client, unsigned long deadline) {
+    size_t len = 0;
+
+    while (!_expired(deadline)) {
+        if (!client.available()) {
+            if (!client.connected()) return HTTP_ERR_CONNECTION_LOST;
+            delay(1);
+            continue;
+        }
+
+        int c = client.read();
+        if (c == '\n') {
+            _lineBuf[len] = '\0';
+            return (int)len;
+        }
+        // Over-long lines are truncated; the rest is consumed and dropped
+        if (c >= 0 && c != '\r' && len < sizeof(_lineBuf) - 1) {
+            _lineBuf[len++] = (char)c;
+        }
+    }
+
+    return _stopCode();
+}
+
+int Source::_readExact(Client& client, char* dst, size_t len, unsigned long deadline) {
+    while (len > 0) {
+        if (_expired(deadline)) return _stopCode();
+
+        int got = client.read((uint8_t*)dst, len);
+        if (got > 0) {
+            dst += got;
+            len -= got;
+        } else if (!client.connected() && !client.available()) {
+            return HTTP_ERR_CONNECTION_LOST;
+        } else {
+            delay(1);
+        }
+    }
+    return 0;
+}
+
+int Source::_readBody(Client& client, size_t contentLength, bool chunked,
+                      unsigned long deadline, size_t& bodyLength) {
+    bodyLength = 0;
+
+    int n;
+    if (chunked) {
+        // <hex size>\r\n<data>\r\n ... 0\r\n\r\n
+        while (true) {
+            n = _readLine(client, deadline);
+            if (n < 0) return n;
+
+            char* end;
+            size_t chunk = strtoul(_lineBuf, &end, 16);
+            if (end == _lineBuf) return HTTP_ERR_PROTOCOL;
+            if (chunk == 0) break;
+            if (chunk > HTTP_PAYLOAD_MAX - bodyLength) return HTTP_ERR_TOO_LARGE;
+
+            n = _readExact(client, _payloadBuf + bodyLength, chunk, deadline);
+            if (n < 0) return n;
+            bodyLength += chunk;
+
+            n = _readLine(client, deadline);
+            if (n < 0) return n;
+            if (n != 0) return HTTP_ERR_PROTOCOL;
+        }
+
+        // Trailers (if any) end with an empty line
+        while ((n = _readLine(client, deadline)) > 0) {}
+        if (n < 0) return n;
+    } else if (contentLength != SIZE_MAX) {
+        if (contentLength > HTTP_PAYLOAD_MAX) return HTTP_ERR_TOO_LARGE;
+        n = _readExact(client, _payloadBuf, contentLength, deadline);
+        if (n < 0) return n;
+        bodyLength = contentLength;
+    } else {
+        // No framing headers: the body runs until the server closes
+        while (client.connected() || client.available()) {
+            if (_expired(deadline)) return _stopCode();
+            if (bodyLength == HTTP_PAYLOAD_MAX) return HTTP_ERR_TOO_LARGE;
+
+            int got = client.read((uint8_t*)_payloadBuf + bodyLength,
+                                  HTTP_PAYLOAD_MAX - bodyLength);
+            if (got > 0) {
+                bodyLength += got;
+            } else {
+                delay(1);
+            }
+        }
+    }
+
+    _payloadBuf[bodyLength] = '\0';
+    return 200;
+}
@@ -0,0 +1,180 @@
+#include "stats.h"
+
+// ============================================================================
+// Poll Stats Implementation
+// ============================================================================
+
+static const uint16_t LATENCY_EDGES_MS[STATS_LATENCY_BUCKETS - 1] = {
+    100, 200, 300, 500, 750, 1000, 1500, 2000, 3000, 5000, 7500, 10000, 15000
+};
+
+static const char* const ERROR_CODES[STATS_ERROR_CODES] = {
+    ERR_WIFI, ERR_TLS, ERR_API, ERR_JSON, ERR_HTTP
+};
+
+PollStats::PollStats()
+    : _polls(0)
+    , _failedPolls(0)
+    , _maxLatencyMs(0)
+    , _displays(0)
+    , _maxDisplayMs(0)
+    , _flashWrites(0)
+    , _heapBaseline(0)
+    , _minLargestBlock(UINT32_MAX)
+    , _outageCode(-1)
+    , _outageStart(0)
+    , _lastReport(0)
+{
+    memset(_latency, 0, sizeof(_latency));
+    memset(_displayLatency, 0, sizeof(_displayLatency));
+    memset(_errors, 0, sizeof(_errors));
+}
+
+void PollStats::recordPoll(unsigned long elapsedMs, const char* errorCode) {
+    _latency[_bucket(elapsedMs)]++;
+    _polls++;
+    if (elapsedMs > _maxLatencyMs) {
+        _maxLatencyMs = elapsedMs;
+    }
+
+    _sampleHeap();
+
+    if (errorCode != nullptr) {
+        _failedPolls++;
+        _recordFailure(errorCode);
+        return;
+    }
+
+    // First success after an outage closes it
+    if (_outageCode >= 0) {
+        uint32_t recoveryMs = millis() - _outageStart;
+        ErrorStats& stats = _errors[_outageCode];
+        stats.recovered++;
+        stats.totalRecoveryMs += recoveryMs;
+        if (recoveryMs > stats.maxRecoveryMs) {
+            stats.maxRecoveryMs = recoveryMs;
+        }
+        log_i("Recovered from %s after %u ms", ERROR_CODES[_outageCode], recoveryMs);
+        _outageCode = -1;
+    }
+}
+
+void PollStats::recordError(const char* errorCode) {
+    _recordFailure(errorCode);
+}
+
+void PollStats::recordDisplayLatency(unsigned long latencyMs) {
+    _displayLatency[_bucket(latencyMs)]++;
+    _displays++;
+    if (latencyMs > _maxDisplayMs) {
+        _maxDisplayMs = latencyMs;
+    }
+}
+
+void PollStats::recordFlashWrites(uint32_t writes) {
+    _flashWrites = writes;
+}
+
+void PollStats::update() {
+    if (millis() - _lastReport >= STATS_REPORT_INTERVAL_MS) {
+        report();
+    }
+}
+
+void PollStats::report() {
+    _lastReport = millis();
+
+    if (_polls == 0) {
+        return;
+    }
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    log_i("Stats: %u polls, %u failed, uptime %lu s",
+          _polls, _failedPolls, millis() / 1000);
+    log_i("Stats: latency p50 <=%lu ms, p90 <=%lu ms, p99 <=%lu ms, max %lu ms",
+          _percentile(_latency, _polls, _maxLatencyMs, 50),
+          _percentile(_latency, _polls, _maxLatencyMs, 90),
+          _percentile(_latency, _polls, _maxLatencyMs, 99), _maxLatencyMs);
+    if (_displays > 0) {
+        log_i("Stats: tick to display p50 <=%lu ms, p90 <=%lu ms, p99 <=%lu ms, max %lu ms",
+              _percentile(_displayLatency, _displays, _maxDisplayMs, 50),
+              _percentile(_displayLatency, _displays, _maxDisplayMs, 90),
+              _percentile(_displayLatency, _displays, _maxDisplayMs, 99), _maxDisplayMs);
+    }
+    unsigned long uptimeS = millis() / 1000;
+    log_i("Stats: %u flash writes (%u/day at this rate)", _flashWrites,
+          uptimeS > 0 ? (uint32_t)((uint64_t)_flashWrites * 86400 / uptimeS) : 0);
+    log_i("Stats: heap %u (drift %+d since first poll), min %u, min largest block %u",
+          freeHeap, (int)(freeHeap - _heapBaseline),
+          ESP.getMinFreeHeap(), _minLargestBlock);
+
+    for (uint8_t i = 0; i < STATS_ERROR_CODES; i++) {
+        const ErrorStats& stats = _errors[i];
+        if (stats.failures == 0) continue;
+        log_i("Stats: %s x%u, %u outage(s), recovery avg %u ms max %u ms%s",
+              ERROR_CODES[i], stats.failures, stats.outages,
+              stats.recovered ? stats.totalRecoveryMs / stats.recovered : 0,
+              stats.maxRecoveryMs,
+              _outageCode == i ? " (ongoing)" : "");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+void PollStats::_recordFailure(const char* errorCode) {
+    int8_t index = _errorIndex(errorCode);
+    _errors[index].failures++;
+
+    // The outage is charged to the code that started it, even if the
+    // device shows other codes before it recovers
+    if (_outageCode < 0) {
+        _outageCode = index;
+        _outageStart = millis();
+        _errors[index].outages++;
+    }
+}
+
+void PollStats::_sampleHeap() {
+    if (_heapBaseline == 0) {
+        _heapBaseline = ESP.getFreeHeap();
+    }
+
+    uint32_t largest = ESP.getMaxAllocHeap();
+    if (largest < _minLargestBlock) {
+        _minLargestBlock = largest;
+    }
+}
+
+uint8_t PollStats::_bucket(unsigned long ms) {
+    uint8_t bucket = 0;
+    while (bucket < STATS_LATENCY_BUCKETS - 1 && ms > LATENCY_EDGES_MS[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+unsigned long PollStats::_percentile(const uint32_t* histogram, uint32_t count,
+                                     unsigned long maxMs, uint8_t pct) {
+    // Rank of the requested sample, rounded up
+    uint32_t rank = ((uint64_t)count * pct + 99) / 100;
+    uint32_t seen = 0;
+
+    for (uint8_t i = 0; i < STATS_LATENCY_BUCKETS - 1; i++) {
+        seen += histogram[i];
+        if (seen >= rank) {
+            return LATENCY_EDGES_MS[i];
+        }
+    }
+    return maxMs;
+}
+
+int8_t PollStats::_errorIndex(const char* errorCode) {
+    for (uint8_t i = 0; i < STATS_ERROR_CODES; i++) {
+        if (errorCode != nullptr && strcmp(errorCode, ERROR_CODES[i]) == 0) {
+            return i;
+        }
+    }
+    return STATS_ERROR_CODES - 1;   // ERR_HTTP
+}
@@ -0,0 +1,124 @@
+#include "store.h"
+#include <time.h>
+
+// ============================================================================
+// Meter Store Implementation
+// ============================================================================
+
+// Bumped whenever StoredValue or MeterData changes layout
+#define STORE_MAGIC  0x4C560002
+
+// Clock values before this are "not synced yet" (2023-11-14)
+#define STORE_MIN_VALID_TIME  1700000000UL
+
+struct StoredValue {
+    uint32_t magic;
+    uint32_t timestamp;
+    MeterData data;
+    uint32_t checksum;   // FNV-1a over everything above
+};
+
+// Not zeroed at boot: holds the previous run's value across soft resets
+RTC_NOINIT_ATTR static StoredValue rtcValue;
+
+static uint32_t checksum(const StoredValue& record) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(StoredValue, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool isValid(const StoredValue& record) {
+    return record.magic == STORE_MAGIC &&
+           record.checksum == checksum(record) &&
+           record.data.valid;
+}
+
+static bool sameReading(const MeterData& a, const MeterData& b) {
+    return a.costUsd == b.costUsd &&
+           a.trend == b.trend &&
+           a.tokens.totalTokens == b.tokens.totalTokens;
+}
+
+MeterStore::MeterStore()
+    : _flashValid(false),
+      _lastFlashWrite(0),
+      _flashWrites(0)
+{
+    memset(&_flashData, 0, sizeof(_flashData));
+}
+
+bool MeterStore::load(MeterData& data, uint32_t& timestamp) {
+    StoredValue flash;
+    memset(&flash, 0, sizeof(flash));
+
+    _preferences.begin(PREF_NAMESPACE, true);  // read-only
+    if (_preferences.getBytesLength(PREF_KEY_LAST_VALUE) == sizeof(flash)) {
+        _preferences.getBytes(PREF_KEY_LAST_VALUE, &flash, sizeof(flash));
+    }
+    _preferences.end();
+
+    if (isValid(flash)) {
+        _flashData = flash.data;
+        _flashValid = true;
+    }
+
+    // RTC memory is at least as fresh as flash whenever it survived
+    const StoredValue* best = isValid(rtcValue) ? &rtcValue
+                            : _flashValid       ? &flash
+                            : nullptr;
+    if (!best) {
+        return false;
+    }
+
+    data = best->data;
+    timestamp = best->timestamp;
+    return true;
+}
+
+void MeterStore::save(const MeterData& data) {
+    time_t now = time(nullptr);
+
+    StoredValue record;
+    memset(&record, 0, sizeof(record));
+    record.magic = STORE_MAGIC;
+    record.timestamp = (now >= (time_t)STORE_MIN_VALID_TIME) ? (uint32_t)now : 0;
+    record.data = data;
+    record.checksum = checksum(record);
+
+    rtcValue = record;
+
+    // Coalesce flash writes: skip unchanged readings, and rate-limit changed
+    // ones (the first write after boot goes straight through)
+    if (_flashValid && sameReading(_flashData, data)) {
+        return;
+    }
+    if (_flashWrites > 0 && millis() - _lastFlashWrite < STORE_FLASH_INTERVAL_MS) {
+        return;
+    }
+
+    _preferences.begin(PREF_NAMESPACE, false);  // read-write
+    _preferences.putBytes(PREF_KEY_LAST_VALUE, &record, sizeof(record));
+    _preferences.end();
+
+    _flashData = data;
+    _flashValid = true;
+    _lastFlashWrite = millis();
+    _flashWrites++;
+    log_i("Last value persisted (%u flash writes this boot)", _flashWrites);
+}
+
+void MeterStore::clear() {
+    memset(&rtcValue, 0, sizeof(rtcValue));
+
+    _preferences.begin(PREF_NAMESPACE, false);
+    _preferences.remove(PREF_KEY_LAST_VALUE);
+    _preferences.end();
+    _flashValid = false;
+}
+
+uint32_t MeterStore::flashWrites() const {
+    return _flashWrites;
+}
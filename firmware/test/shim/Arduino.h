@@ -0,0 +1,325 @@
+#ifndef SHIM_ARDUINO_H
+#define SHIM_ARDUINO_H
+
+// ============================================================================
+// Host Shim — Arduino Core Subset for the Native Test Build
+// ============================================================================
+//
+// Just enough of the ESP32 Arduino core for the portable modules (display,
+// parser, inflate, rollup, stats, store, relay, source, capture) to build
+// and run on a PC under `pio test -e native`. Everything is header-only and lives in
+// test/shim, which only the native env puts on the include path.
+//
+// Time is simulated: millis() and micros() move only when a test calls
+// fake::advance() or the code under test calls delay(), so a run is
+// repeatable to the microsecond. Tickers registered with fake::onTick()
+// (mock servers, scripted events) run on every advance, which is how a
+// fetch blocked in a delay(1) loop sees its server make progress.
+// fake::useRealClock() switches to the host's monotonic clock, for
+// benchmarks that time real work with micros().
+//
+// Log output is filtered by fake::logLevel (default: warnings and errors),
+// so passing tests stay quiet.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+using std::min;
+using std::max;
+
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define LOW           0
+#define HIGH          1
+#define INPUT         0x01
+#define OUTPUT        0x03
+#define INPUT_PULLUP  0x05
+
+// ---------------------------------------------------------------------------
+// Simulated clock, tickers and log filter
+// ---------------------------------------------------------------------------
+
+namespace fake {
+
+enum LogLevel { LOG_NONE, LOG_ERROR, LOG_WARN, LOG_INFO, LOG_DEBUG };
+
+inline uint64_t simUs = 0;
+inline bool realClock = false;
+inline int logLevel = LOG_WARN;
+
+inline std::vector<std::function<void()>>& tickers() {
+    static std::vector<std::function<void()>> list;
+    return list;
+}
+
+// Run fn after every clock advance until clearTickers()
+inline void onTick(std::function<void()> fn) {
+    tickers().push_back(fn);
+}
+
+inline void clearTickers() {
+    tickers().clear();
+}
+
+inline uint64_t hostUs() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline uint64_t nowUs() {
+    return realClock ? hostUs() : simUs;
+}
+
+inline void advanceUs(uint64_t us) {
+    if (realClock) return;
+    simUs += us;
+    // Indexed: a ticker may register another
+    for (size_t i = 0; i < tickers().size(); i++) {
+        tickers()[i]();
+    }
+}
+
+inline void advance(unsigned long ms) {
+    advanceUs((uint64_t)ms * 1000);
+}
+
+// Back to t = 0 with no tickers
+inline void resetClock() {
+    simUs = 0;
+    clearTickers();
+}
+
+inline void useRealClock(bool on = true) {
+    realClock = on;
+}
+
+inline void log(int level, char tag, const char* format, ...) {
+    if (level > logLevel) return;
+    va_list args;
+    va_start(args, format);
+    printf("[%8.3f][%c] ", nowUs() / 1000000.0, tag);
+    vprintf(format, args);
+    printf("\n");
+    va_end(args);
+}
+
+}  // namespace fake
+
+#define log_e(format, ...)  fake::log(fake::LOG_ERROR, 'E', format, ##__VA_ARGS__)
+#define log_w(format, ...)  fake::log(fake::LOG_WARN, 'W', format, ##__VA_ARGS__)
+#define log_i(format, ...)  fake::log(fake::LOG_INFO, 'I', format, ##__VA_ARGS__)
+#define log_d(format, ...)  fake::log(fake::LOG_DEBUG, 'D', format, ##__VA_ARGS__)
+
+inline unsigned long millis() {
+    return (unsigned long)(fake::nowUs() / 1000);
+}
+
+inline unsigned long micros() {
+    return (unsigned long)fake::nowUs();
+}
+
+inline void delay(unsigned long ms) {
+    fake::advance(ms);
+}
+
+inline void delayMicroseconds(unsigned int us) {
+    fake::advanceUs(us);
+}
+
+inline void yield() {}
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+
+// glibc only gained these in 2.38
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+inline size_t strlcat(char* dst, const char* src, size_t size) {
+    size_t len = strnlen(dst, size);
+    if (len == size) return size + strlen(src);
+    return len + strlcpy(dst + len, src, size - len);
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// String, Print, Stream, Serial
+// ---------------------------------------------------------------------------
+
+class String {
+public:
+    String(const char* text = "") : _text(text) {}
+    String(const std::string& text) : _text(text) {}
+    const char* c_str() const { return _text.c_str(); }
+    size_t length() const { return _text.size(); }
+    bool operator==(const char* other) const { return _text == other; }
+
+private:
+    std::string _text;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+
+    size_t printf(const char* format, ...) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (len < 0) return 0;
+        return write((const uint8_t*)buf, (size_t)len < sizeof(buf) ? len : sizeof(buf) - 1);
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(char* buffer, size_t length) {
+        size_t n = 0;
+        int c;
+        while (n < length && (c = read()) >= 0) buffer[n++] = (char)c;
+        return n;
+    }
+    void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t c) override { return fwrite(&c, 1, 1, stdout); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        return fwrite(buffer, 1, size, stdout);
+    }
+    using Print::write;
+};
+
+inline HardwareSerial Serial;
+
+namespace fake {
+
+// Collects printed text, e.g. for DisplayManager::dumpFrame()
+class PrintBuffer : public Print {
+public:
+    size_t write(uint8_t c) override { text += (char)c; return 1; }
+    using Print::write;
+    std::string text;
+};
+
+}  // namespace fake
+
+// ---------------------------------------------------------------------------
+// IPAddress and Client
+// ---------------------------------------------------------------------------
+
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        uint8_t bytes[4] = { a, b, c, d };
+        memcpy(&_address, bytes, 4);
+    }
+    // Raw address in network byte order, as the core stores it
+    IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return ((const uint8_t*)&_address)[index]; }
+    bool operator==(const IPAddress& other) const { return _address == other._address; }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u",
+                 (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(buf);
+    }
+
+private:
+    uint32_t _address;
+};
+
+class Client : public Stream {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual int read(uint8_t* buffer, size_t size) = 0;
+    using Stream::read;
+    virtual void flush() {}
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    virtual operator bool() = 0;
+};
+
+// ---------------------------------------------------------------------------
+// ESP object, RNG
+// ---------------------------------------------------------------------------
+
+namespace fake {
+
+inline uint64_t efuseMac = 0x0000A1B2C3D4E5F6ULL;
+inline uint32_t freeHeap = 200000;
+inline uint32_t rngState = 0x12345678;
+
+}  // namespace fake
+
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return fake::freeHeap; }
+    uint32_t getMinFreeHeap() { return fake::freeHeap; }
+    uint32_t getMaxAllocHeap() { return fake::freeHeap; }
+    uint64_t getEfuseMac() { return fake::efuseMac; }
+    void restart() {}
+};
+
+inline EspClass ESP;
+
+// xorshift32: repeatable across runs, distinct per call
+inline uint32_t esp_random() {
+    uint32_t x = fake::rngState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return fake::rngState = x;
+}
+
+#endif // SHIM_ARDUINO_H
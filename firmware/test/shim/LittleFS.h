@@ -0,0 +1,112 @@
+#ifndef SHIM_LITTLEFS_H
+#define SHIM_LITTLEFS_H
+
+// ============================================================================
+// Host Shim — LittleFS Files in Memory
+// ============================================================================
+//
+// Files live in one process-wide table keyed by path, so a second mount (a
+// "rebooted" module) sees what the first one wrote until fake::fsErase().
+// open() takes the FS.h modes: FILE_READ fails on a missing file,
+// FILE_WRITE truncates, FILE_APPEND writes at the end. A File shares its
+// contents with the table, so remove() and rename() behave like unlinking
+// an open file on the device: the handle keeps reading what it had.
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+
+#define FILE_READ    "r"
+#define FILE_WRITE   "w"
+#define FILE_APPEND  "a"
+
+namespace fake {
+
+typedef std::shared_ptr<std::vector<uint8_t>> FileData;
+
+inline std::map<std::string, FileData>& files() {
+    static std::map<std::string, FileData> table;
+    return table;
+}
+
+inline void fsErase() {
+    files().clear();
+}
+
+}  // namespace fake
+
+class File : public Stream {
+public:
+    File() {}
+    File(fake::FileData data, bool writable, size_t position)
+        : _data(data), _writable(writable), _position(position) {}
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!_data || !_writable) return 0;
+        _data->insert(_data->end(), buffer, buffer + size);
+        _position = _data->size();
+        return size;
+    }
+
+    size_t read(uint8_t* buffer, size_t size) {
+        if (!_data) return 0;
+        size_t n = std::min(size, _data->size() - std::min(_position, _data->size()));
+        memcpy(buffer, _data->data() + _position, n);
+        _position += n;
+        return n;
+    }
+    int read() override {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+    int available() override { return _data ? (int)(_data->size() - _position) : 0; }
+    int peek() override { return available() > 0 ? (*_data)[_position] : -1; }
+
+    size_t size() const { return _data ? _data->size() : 0; }
+    size_t position() const { return _position; }
+    void close() { _data.reset(); }
+    operator bool() const { return _data != nullptr; }
+
+private:
+    fake::FileData _data;
+    bool _writable = false;
+    size_t _position = 0;
+};
+
+class LittleFSFS {
+public:
+    bool begin(bool formatOnFail = false) {
+        (void)formatOnFail;
+        return true;
+    }
+
+    File open(const char* path, const char* mode) {
+        auto it = fake::files().find(path);
+        if (strcmp(mode, FILE_READ) == 0) {
+            return it != fake::files().end() ? File(it->second, false, 0) : File();
+        }
+        fake::FileData data = std::make_shared<std::vector<uint8_t>>();
+        if (strcmp(mode, FILE_APPEND) == 0 && it != fake::files().end()) {
+            data = it->second;
+        }
+        fake::files()[path] = data;
+        return File(data, true, data->size());
+    }
+
+    bool exists(const char* path) { return fake::files().count(path) > 0; }
+    bool remove(const char* path) { return fake::files().erase(path) > 0; }
+
+    bool rename(const char* from, const char* to) {
+        auto it = fake::files().find(from);
+        if (it == fake::files().end()) return false;
+        fake::FileData data = it->second;
+        fake::files().erase(it);
+        fake::files()[to] = data;
+        return true;
+    }
+};
+
+inline LittleFSFS LittleFS;
+
+#endif // SHIM_LITTLEFS_H
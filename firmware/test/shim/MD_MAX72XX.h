@@ -0,0 +1,188 @@
+#ifndef SHIM_MD_MAX72XX_H
+#define SHIM_MD_MAX72XX_H
+
+// ============================================================================
+// Host Shim — MD_MAX72XX Column Buffer
+// ============================================================================
+//
+// The subset of MD_MAX72XX the display code uses, backed by a plain column
+// buffer (column 0 is the rightmost column of module 0, bit 0 the top row,
+// as on the real chain). Nothing is driven; instead the fake counts what
+// the real library would put on the SPI bus: a flush rewrites every row in
+// which any column changed, and a row write shifts 2 bytes through each of
+// the N devices. Flushes happen on every buffer change while UPDATE is ON,
+// and once on switching it back ON, as in the library.
+//
+// getChar() serves a 5x7 ASCII font whose glyph widths follow the ink
+// (narrow '1', '.', ':'), like the library's variable-width system font.
+// The pixels differ from the real font, so golden frames made with this
+// fake pin down layout (zones, widths, centering, scrolling), not glyphs.
+
+#include <Arduino.h>
+
+namespace fake {
+
+// Classic 5x7 font, ' ' to '~', one byte per column, bit 0 = top row
+inline const uint8_t font5x7[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00},
+    {0x14,0x7F,0x14,0x7F,0x14}, {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62},
+    {0x36,0x49,0x56,0x20,0x50}, {0x00,0x08,0x07,0x03,0x00}, {0x00,0x1C,0x22,0x41,0x00},
+    {0x00,0x41,0x22,0x1C,0x00}, {0x2A,0x1C,0x7F,0x1C,0x2A}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x80,0x70,0x30,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x00,0x60,0x60,0x00},
+    {0x20,0x10,0x08,0x04,0x02}, {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00},
+    {0x72,0x49,0x49,0x49,0x46}, {0x21,0x41,0x49,0x4D,0x33}, {0x18,0x14,0x12,0x7F,0x10},
+    {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x31}, {0x41,0x21,0x11,0x09,0x07},
+    {0x36,0x49,0x49,0x49,0x36}, {0x46,0x49,0x49,0x29,0x1E}, {0x00,0x00,0x14,0x00,0x00},
+    {0x00,0x40,0x34,0x00,0x00}, {0x00,0x08,0x14,0x22,0x41}, {0x14,0x14,0x14,0x14,0x14},
+    {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x59,0x09,0x06}, {0x3E,0x41,0x5D,0x59,0x4E},
+    {0x7C,0x12,0x11,0x12,0x7C}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x41,0x3E}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01},
+    {0x3E,0x41,0x41,0x51,0x73}, {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00},
+    {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41}, {0x7F,0x40,0x40,0x40,0x40},
+    {0x7F,0x02,0x1C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46},
+    {0x26,0x49,0x49,0x49,0x32}, {0x03,0x01,0x7F,0x01,0x03}, {0x3F,0x40,0x40,0x40,0x3F},
+    {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F}, {0x63,0x14,0x08,0x14,0x63},
+    {0x03,0x04,0x78,0x04,0x03}, {0x61,0x59,0x49,0x4D,0x43}, {0x00,0x7F,0x41,0x41,0x41},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x41,0x7F}, {0x04,0x02,0x01,0x02,0x04},
+    {0x40,0x40,0x40,0x40,0x40}, {0x00,0x03,0x07,0x08,0x00}, {0x20,0x54,0x54,0x78,0x40},
+    {0x7F,0x28,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x28}, {0x38,0x44,0x44,0x28,0x7F},
+    {0x38,0x54,0x54,0x54,0x18}, {0x00,0x08,0x7E,0x09,0x02}, {0x18,0xA4,0xA4,0x9C,0x78},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x40,0x3D,0x00},
+    {0x7F,0x10,0x28,0x44,0x00}, {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x78,0x04,0x78},
+    {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38}, {0xFC,0x18,0x24,0x24,0x18},
+    {0x18,0x24,0x24,0x18,0xFC}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x24},
+    {0x04,0x04,0x3F,0x44,0x24}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C},
+    {0x3C,0x40,0x30,0x40,0x3C}, {0x44,0x28,0x10,0x28,0x44}, {0x4C,0x90,0x90,0x90,0x7C},
+    {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00}, {0x00,0x00,0x77,0x00,0x00},
+    {0x00,0x41,0x36,0x08,0x00}, {0x02,0x01,0x02,0x04,0x02},
+};
+
+// Glyph of c trimmed to its ink (space keeps 2 blank columns; codes
+// outside the font render as a 1-column gap). Returns the width.
+inline uint8_t fontGlyph(uint8_t c, uint8_t* cols, uint8_t size) {
+    if (c == ' ' || c < ' ' || c > '~') {
+        uint8_t width = c == ' ' ? 2 : 1;
+        for (uint8_t i = 0; i < width && i < size; i++) cols[i] = 0;
+        return width;
+    }
+
+    const uint8_t* glyph = font5x7[c - ' '];
+    uint8_t first = 0;
+    uint8_t last = 4;
+    while (glyph[first] == 0) first++;
+    while (glyph[last] == 0) last--;
+
+    uint8_t width = last - first + 1;
+    for (uint8_t i = 0; i < width && i < size; i++) cols[i] = glyph[first + i];
+    return width;
+}
+
+}  // namespace fake
+
+class MD_MAX72XX {
+public:
+    enum moduleType_t { GENERIC_HW, FC16_HW, PAROLA_HW, ICSTATION_HW, DR0CR0RR0_HW };
+    enum controlRequest_t { SHUTDOWN, SCANLIMIT, INTENSITY, TEST, DECODE, UPDATE, WRAPAROUND };
+    enum controlValue_t { OFF = 0, ON = 1 };
+
+    MD_MAX72XX(moduleType_t, uint8_t, uint8_t numDevices = 1)
+        : _devices(numDevices), _cols(numDevices * 8, 0), _sent(numDevices * 8, 0) {}
+
+    void begin() { clear(); }
+
+    bool control(controlRequest_t mode, int value) {
+        if (mode == UPDATE) {
+            _autoUpdate = value == ON;
+            if (_autoUpdate) _flush();
+        } else if (mode == INTENSITY) {
+            _intensity = (uint8_t)value;
+        }
+        return true;
+    }
+
+    bool control(uint8_t, uint8_t, controlRequest_t mode, int value) {
+        return control(mode, value);
+    }
+
+    void clear() { clear(0, _devices - 1); }
+
+    void clear(uint8_t startDev, uint8_t endDev) {
+        for (uint16_t c = startDev * 8; c < (endDev + 1) * 8 && c < _cols.size(); c++) {
+            _cols[c] = 0;
+        }
+        _changed();
+    }
+
+    uint8_t getColumn(uint16_t c) { return c < _cols.size() ? _cols[c] : 0; }
+
+    bool setColumn(uint16_t c, uint8_t value) {
+        if (c >= _cols.size()) return false;
+        _cols[c] = value;
+        _changed();
+        return true;
+    }
+
+    // Both walk from col towards column 0, i.e. left to right on the matrix
+    bool getBuffer(uint16_t col, uint16_t size, uint8_t* pd) {
+        for (uint16_t i = 0; i < size && i <= col; i++) pd[i] = getColumn(col - i);
+        return true;
+    }
+
+    bool setBuffer(uint16_t col, uint16_t size, uint8_t* pd) {
+        for (uint16_t i = 0; i < size && i <= col; i++) {
+            if ((size_t)(col - i) < _cols.size()) _cols[col - i] = pd[i];
+        }
+        _changed();
+        return true;
+    }
+
+    uint16_t getColumnCount() { return (uint16_t)_cols.size(); }
+
+    uint8_t getChar(uint16_t c, uint16_t size, uint8_t* buf) {
+        return fake::fontGlyph((uint8_t)c, buf, (uint8_t)size);
+    }
+
+    bool setPoint(uint8_t r, uint16_t c, bool state) {
+        if (c >= _cols.size() || r > 7) return false;
+        _cols[c] = state ? (_cols[c] | (1 << r)) : (_cols[c] & ~(1 << r));
+        _changed();
+        return true;
+    }
+
+    bool getPoint(uint8_t r, uint16_t c) { return (getColumn(c) >> r) & 1; }
+
+    // --- Fake only ---
+
+    uint8_t devices() const { return _devices; }
+    uint8_t intensity() const { return _intensity; }
+    uint32_t flushes() const { return _flushes; }
+    uint32_t spiBytes() const { return _spiBytes; }
+    void resetCounters() { _flushes = 0; _spiBytes = 0; }
+
+private:
+    uint8_t _devices;
+    std::vector<uint8_t> _cols;
+    std::vector<uint8_t> _sent;   // What the chain shows
+    bool _autoUpdate = true;
+    uint8_t _intensity = 7;
+    uint32_t _flushes = 0;
+    uint32_t _spiBytes = 0;
+
+    void _changed() {
+        if (_autoUpdate) _flush();
+    }
+
+    void _flush() {
+        uint8_t rows = 0;
+        for (size_t c = 0; c < _cols.size(); c++) {
+            rows |= _cols[c] ^ _sent[c];
+            _sent[c] = _cols[c];
+        }
+        if (rows == 0) return;
+        _flushes++;
+        _spiBytes += __builtin_popcount(rows) * 2 * _devices;
+    }
+};
+
+#endif // SHIM_MD_MAX72XX_H
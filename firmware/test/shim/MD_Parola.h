@@ -0,0 +1,263 @@
+#ifndef SHIM_MD_PAROLA_H
+#define SHIM_MD_PAROLA_H
+
+// ============================================================================
+// Host Shim — MD_Parola Zones and Text Effects
+// ============================================================================
+//
+// Zones, alignment and the two effects the display code uses, rendered
+// into the fake MD_MAX72XX so tests can read back the frame:
+//
+//   PA_PRINT        text appears at once, aligned within its zone; the zone
+//                   is done after the pause.
+//   PA_SCROLL_LEFT  text enters at the zone's right edge and moves one
+//                   column per `speed` ms (one step per displayAnimate()
+//                   call that finds a step due), holds for `pause` ms at
+//                   its aligned position and leaves on the left; the zone
+//                   is done once the last column has left.
+//
+// Other effects behave like PA_PRINT. As in the library, a zone keeps a
+// pointer to its text, characters are separated by one blank column, and
+// a zone's custom characters (addChar) take precedence over the font.
+
+#include <Arduino.h>
+#include <MD_MAX72XX.h>
+#include <map>
+
+enum textPosition_t { PA_LEFT, PA_CENTER, PA_RIGHT };
+enum textEffect_t {
+    PA_NO_EFFECT, PA_PRINT, PA_SCROLL_UP, PA_SCROLL_DOWN,
+    PA_SCROLL_LEFT, PA_SCROLL_RIGHT, PA_FADE
+};
+
+class MD_Parola {
+public:
+    MD_Parola(MD_MAX72XX::moduleType_t mod, uint8_t csPin, uint8_t numDevices = 1)
+        : _mx(mod, csPin, numDevices), _devices(numDevices) {}
+
+    void begin(uint8_t numZones = 1) {
+        _mx.begin();
+        _zones.assign(numZones, Zone());
+        _zones[0].endModule = _devices - 1;
+        for (uint8_t z = 1; z < numZones; z++) {
+            _zones[z].startModule = 1;   // Empty until setZone()
+            _zones[z].endModule = 0;
+        }
+    }
+
+    bool setZone(uint8_t z, uint8_t moduleStart, uint8_t moduleEnd) {
+        if (z >= _zones.size() || moduleStart > moduleEnd || moduleEnd >= _devices) {
+            return false;
+        }
+        _zones[z].startModule = moduleStart;
+        _zones[z].endModule = moduleEnd;
+        return true;
+    }
+
+    void setIntensity(uint8_t level) { _mx.control(MD_MAX72XX::INTENSITY, level); }
+    void setIntensity(uint8_t, uint8_t level) { setIntensity(level); }
+
+    void setTextAlignment(textPosition_t align) {
+        for (Zone& zone : _zones) zone.align = align;
+    }
+    void setTextAlignment(uint8_t z, textPosition_t align) { _zones[z].align = align; }
+
+    void setSpeed(uint16_t speed) {
+        for (Zone& zone : _zones) zone.speed = speed;
+    }
+    void setSpeed(uint8_t z, uint16_t speed) { _zones[z].speed = speed; }
+
+    void setPause(uint16_t pause) {
+        for (Zone& zone : _zones) zone.pause = pause;
+    }
+    void setPause(uint8_t z, uint16_t pause) { _zones[z].pause = pause; }
+
+    void setCharSpacing(uint8_t) {}
+    void setCharSpacing(uint8_t, uint8_t) {}
+    uint8_t getCharSpacing() { return 1; }
+
+    bool addChar(uint16_t code, uint8_t* data) {
+        for (uint8_t z = 0; z < _zones.size(); z++) addChar(z, code, data);
+        return true;
+    }
+    bool addChar(uint8_t z, uint16_t code, uint8_t* data) {
+        _zones[z].custom[(uint8_t)code] = data;
+        return true;
+    }
+
+    uint16_t getTextColumns(const char* text) { return getTextColumns(0, text); }
+    uint16_t getTextColumns(uint8_t z, const char* text) {
+        uint8_t glyph[8];
+        uint16_t width = 0;
+        for (const char* p = text; *p != '\0'; p++) {
+            if (p != text) width++;
+            width += _glyph(_zones[z], (uint8_t)*p, glyph);
+        }
+        return width;
+    }
+
+    void displayClear() {
+        for (uint8_t z = 0; z < _zones.size(); z++) displayClear(z);
+    }
+    void displayClear(uint8_t z) {
+        if (_empty(_zones[z])) return;
+        _mx.clear(_zones[z].startModule, _zones[z].endModule);
+    }
+
+    void displayText(const char* text, textPosition_t align, uint16_t speed,
+                     uint16_t pause, textEffect_t effectIn,
+                     textEffect_t effectOut = PA_NO_EFFECT) {
+        for (uint8_t z = 0; z < _zones.size(); z++) {
+            displayZoneText(z, text, align, speed, pause, effectIn, effectOut);
+        }
+    }
+
+    void displayZoneText(uint8_t z, const char* text, textPosition_t align,
+                         uint16_t speed, uint16_t pause, textEffect_t effectIn,
+                         textEffect_t effectOut = PA_NO_EFFECT) {
+        Zone& zone = _zones[z];
+        zone.text = text;
+        zone.align = align;
+        zone.speed = speed;
+        zone.pause = pause;
+        zone.effectIn = effectIn;
+        zone.effectOut = effectOut;
+        zone.state = STATE_START;
+    }
+
+    void displayReset() {
+        for (Zone& zone : _zones) zone.state = STATE_START;
+    }
+    void displayReset(uint8_t z) { _zones[z].state = STATE_START; }
+
+    bool getZoneStatus(uint8_t z) { return _zones[z].state == STATE_DONE; }
+
+    // Advance every zone one step if due. True when all zones are done.
+    bool displayAnimate() {
+        bool done = true;
+        for (Zone& zone : _zones) {
+            _animate(zone);
+            done &= zone.state == STATE_DONE;
+        }
+        return done;
+    }
+
+    MD_MAX72XX* getGraphicObject() { return &_mx; }
+
+    // --- Fake only ---
+
+    // Calls to displayAnimate() that redrew at least one zone
+    uint32_t renders() const { return _renders; }
+
+private:
+    enum State : uint8_t { STATE_START, STATE_SCROLL, STATE_PAUSE, STATE_DONE };
+
+    struct Zone {
+        uint8_t startModule = 0;
+        uint8_t endModule = 0;
+        const char* text = "";
+        textPosition_t align = PA_CENTER;
+        uint16_t speed = 10;
+        uint16_t pause = 0;
+        textEffect_t effectIn = PA_PRINT;
+        textEffect_t effectOut = PA_NO_EFFECT;
+        State state = STATE_DONE;
+        int16_t x = 0;                  // Text's first column, from the zone's left
+        unsigned long stepAt = 0;       // When the next step is due
+        std::map<uint8_t, const uint8_t*> custom;
+    };
+
+    MD_MAX72XX _mx;
+    uint8_t _devices;
+    std::vector<Zone> _zones;
+    uint32_t _renders = 0;
+
+    static bool _empty(const Zone& zone) { return zone.startModule > zone.endModule; }
+
+    static uint16_t _width(const Zone& zone) {
+        return (zone.endModule - zone.startModule + 1) * 8;
+    }
+
+    uint8_t _glyph(const Zone& zone, uint8_t c, uint8_t* cols) {
+        auto custom = zone.custom.find(c);
+        if (custom != zone.custom.end()) {
+            const uint8_t* data = custom->second;
+            memcpy(cols, data + 1, data[0] <= 8 ? data[0] : 8);
+            return data[0];
+        }
+        return _mx.getChar(c, 8, cols);
+    }
+
+    int16_t _alignedX(Zone& zone) {
+        int16_t slack = (int16_t)_width(zone) - (int16_t)getTextColumns(_index(zone), zone.text);
+        if (zone.align == PA_LEFT) return 0;
+        if (zone.align == PA_RIGHT) return slack;
+        return slack / 2;
+    }
+
+    uint8_t _index(const Zone& zone) const { return (uint8_t)(&zone - _zones.data()); }
+
+    void _render(Zone& zone) {
+        uint16_t width = _width(zone);
+        uint16_t left = zone.endModule * 8 + 7;   // Zone's leftmost column
+        uint8_t glyph[8];
+
+        _mx.control(MD_MAX72XX::UPDATE, MD_MAX72XX::OFF);
+        _mx.clear(zone.startModule, zone.endModule);
+        int16_t x = zone.x;
+        for (const char* p = zone.text; *p != '\0'; p++) {
+            if (p != zone.text) x++;
+            uint8_t glyphWidth = _glyph(zone, (uint8_t)*p, glyph);
+            for (uint8_t i = 0; i < glyphWidth; i++, x++) {
+                if (x >= 0 && x < (int16_t)width) _mx.setColumn(left - x, glyph[i]);
+            }
+        }
+        _mx.control(MD_MAX72XX::UPDATE, MD_MAX72XX::ON);
+        _renders++;
+    }
+
+    void _animate(Zone& zone) {
+        if (_empty(zone) || zone.state == STATE_DONE) return;
+        unsigned long now = millis();
+        bool scrolls = zone.effectIn == PA_SCROLL_LEFT;
+
+        switch (zone.state) {
+            case STATE_START:
+                if (scrolls) {
+                    zone.x = _width(zone);
+                    zone.stepAt = now;
+                    zone.state = STATE_SCROLL;
+                } else {
+                    zone.x = _alignedX(zone);
+                    _render(zone);
+                    zone.stepAt = now + zone.pause;
+                    zone.state = zone.pause > 0 ? STATE_PAUSE : STATE_DONE;
+                }
+                break;
+
+            case STATE_SCROLL: {
+                if ((long)(now - zone.stepAt) < 0) break;
+                zone.x--;
+                zone.stepAt = now + zone.speed;
+                _render(zone);
+
+                int16_t columns = getTextColumns(_index(zone), zone.text);
+                if (zone.x == _alignedX(zone) && zone.pause > 0) {
+                    zone.stepAt = now + zone.pause;
+                } else if (zone.x <= -columns) {
+                    zone.state = STATE_DONE;
+                }
+                break;
+            }
+
+            case STATE_PAUSE:
+                if ((long)(now - zone.stepAt) >= 0) zone.state = STATE_DONE;
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+#endif // SHIM_MD_PAROLA_H
@@ -0,0 +1,110 @@
+#ifndef SHIM_PREFERENCES_H
+#define SHIM_PREFERENCES_H
+
+// ============================================================================
+// Host Shim — Preferences (NVS) in Memory
+// ============================================================================
+//
+// Namespaces and keys live in one process-wide table, so a Preferences
+// opened by a second object (a "rebooted" module) sees what the first one
+// wrote until fake::nvsErase(). Every put and remove counts as a flash
+// write in fake::nvsWrites, the figure the wear tests care about. Writes to
+// a namespace opened read-only fail, as on the device.
+
+#include <Arduino.h>
+#include <map>
+
+namespace fake {
+
+typedef std::map<std::string, std::vector<uint8_t>> NvsNamespace;
+
+inline std::map<std::string, NvsNamespace>& nvs() {
+    static std::map<std::string, NvsNamespace> table;
+    return table;
+}
+
+inline uint32_t nvsWrites = 0;
+
+inline void nvsErase() {
+    nvs().clear();
+    nvsWrites = 0;
+}
+
+}  // namespace fake
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false) {
+        _space = &fake::nvs()[name];
+        _readOnly = readOnly;
+        return true;
+    }
+
+    void end() { _space = nullptr; }
+
+    bool clear() {
+        if (!_writable()) return false;
+        _space->clear();
+        fake::nvsWrites++;
+        return true;
+    }
+
+    bool remove(const char* key) {
+        if (!_writable() || _space->erase(key) == 0) return false;
+        fake::nvsWrites++;
+        return true;
+    }
+
+    bool isKey(const char* key) { return _find(key) != nullptr; }
+
+    size_t putBytes(const char* key, const void* value, size_t len) {
+        if (!_writable()) return 0;
+        const uint8_t* bytes = (const uint8_t*)value;
+        (*_space)[key].assign(bytes, bytes + len);
+        fake::nvsWrites++;
+        return len;
+    }
+
+    size_t getBytesLength(const char* key) {
+        const std::vector<uint8_t>* value = _find(key);
+        return value ? value->size() : 0;
+    }
+
+    size_t getBytes(const char* key, void* buf, size_t maxLen) {
+        const std::vector<uint8_t>* value = _find(key);
+        if (!value || value->size() > maxLen) return 0;
+        memcpy(buf, value->data(), value->size());
+        return value->size();
+    }
+
+    size_t putString(const char* key, const char* value) {
+        return putBytes(key, value, strlen(value) + 1);
+    }
+
+    size_t getString(const char* key, char* value, size_t maxLen) {
+        return getBytes(key, value, maxLen);
+    }
+
+    size_t putUInt(const char* key, uint32_t value) {
+        return putBytes(key, &value, sizeof(value));
+    }
+
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+        uint32_t value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+
+private:
+    fake::NvsNamespace* _space = nullptr;
+    bool _readOnly = true;
+
+    bool _writable() const { return _space != nullptr && !_readOnly; }
+
+    const std::vector<uint8_t>* _find(const char* key) const {
+        if (!_space) return nullptr;
+        auto it = _space->find(key);
+        return it != _space->end() ? &it->second : nullptr;
+    }
+};
+
+#endif // SHIM_PREFERENCES_H
@@ -0,0 +1 @@
+// MD_MAX72XX includes it for the hardware SPI bus; nothing to drive here
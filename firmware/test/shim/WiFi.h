@@ -0,0 +1,71 @@
+#ifndef SHIM_WIFI_H
+#define SHIM_WIFI_H
+
+// ============================================================================
+// Host Shim — WiFi Station and DNS
+// ============================================================================
+//
+// The station is always associated (fake::wifiStatus to change that) with
+// fake::localIp. hostByName() answers from fake::dns() after fake::dnsMs of
+// simulated time; unknown names fail.
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+namespace fake {
+
+inline wl_status_t wifiStatus = WL_CONNECTED;
+inline IPAddress localIp(192, 168, 1, 50);
+inline uint32_t dnsMs = 3;
+
+inline std::map<std::string, IPAddress>& dns() {
+    static std::map<std::string, IPAddress> table;
+    return table;
+}
+
+// Forget every endpoint and DNS entry
+inline void resetNetwork() {
+    endpoints().clear();
+    dns().clear();
+    dnsMs = 3;
+    wifiStatus = WL_CONNECTED;
+}
+
+}  // namespace fake
+
+class WiFiClass {
+public:
+    wl_status_t status() { return fake::wifiStatus; }
+    IPAddress localIP() { return fake::wifiStatus == WL_CONNECTED ? fake::localIp : IPAddress(); }
+
+    int hostByName(const char* host, IPAddress& result) {
+        fake::InNetwork scope;
+        fake::advance(fake::dnsMs);
+        auto it = fake::dns().find(host);
+        if (it == fake::dns().end()) return 0;
+        result = it->second;
+        return 1;
+    }
+};
+
+inline WiFiClass WiFi;
+
+inline int WiFiClient::connect(const char* host, uint16_t port, int32_t timeout) {
+    IPAddress ip;
+    return WiFi.hostByName(host, ip) ? connect(ip, port, timeout) : 0;
+}
+
+inline int WiFiClient::connect(const char* host, uint16_t port) {
+    return connect(host, port, 30000);
+}
+
+#endif // SHIM_WIFI_H
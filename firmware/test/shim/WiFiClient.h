@@ -0,0 +1,178 @@
+#ifndef SHIM_WIFICLIENT_H
+#define SHIM_WIFICLIENT_H
+
+// ============================================================================
+// Host Shim — WiFiClient over an In-Memory Network
+// ============================================================================
+//
+// No sockets: a test registers fake::Endpoint objects (mock servers) at an
+// address and port, and WiFiClient talks to them directly. Everything runs
+// on the simulated clock:
+//
+//   connect   takes the endpoint's connectMs; a refused port fails at once,
+//             a blackholed one (or connectMs >= the timeout) burns the
+//             whole timeout first, like an unanswered SYN.
+//   write     hands the bytes to the endpoint's onData() right away.
+//   read      sees a response byte only once the clock reaches the time the
+//             endpoint scheduled it for, so latency, slow drips and the
+//             client's delay(1) polling behave as on a real socket.
+//   close     the endpoint schedules the peer's FIN; connected() turns
+//             false then, while bytes already received stay readable.
+//
+// fake::resetNetwork() drops the endpoints and the DNS table (see WiFi.h).
+//
+// The simulation keeps its bytes in std::string and std::deque, so it
+// allocates where a real socket would not. Shim code that allocates runs
+// inside a fake::InNetwork scope; a test counting the heap traffic of the
+// code under test ignores allocations while fake::inNetwork() is nonzero.
+
+#include <Arduino.h>
+#include <deque>
+#include <map>
+#include <memory>
+
+namespace fake {
+
+class Endpoint;
+
+inline int& inNetwork() {
+    static int depth = 0;
+    return depth;
+}
+
+struct InNetwork {
+    InNetwork() { inNetwork()++; }
+    ~InNetwork() { inNetwork()--; }
+};
+
+// One TCP connection as both sides see it
+struct Connection {
+    Endpoint* endpoint = nullptr;
+    std::string toServer;                   // Written by the client, not yet consumed
+    std::deque<std::pair<uint64_t, uint8_t>> toClient;   // (arrival us, byte)
+    uint64_t lastByteUs = 0;                // When the last scheduled byte lands
+    uint64_t closeAtUs = UINT64_MAX;        // Peer's FIN
+    uint32_t requests = 0;                  // Endpoint's own count
+
+    // Queue data to arrive from atUs on, one byte every usPerByte
+    void send(const std::string& data, uint64_t atUs, uint32_t usPerByte = 0) {
+        uint64_t t = std::max(atUs, lastByteUs);
+        for (char c : data) {
+            toClient.push_back({ t, (uint8_t)c });
+            t += usPerByte;
+        }
+        lastByteUs = toClient.empty() ? t : toClient.back().first;
+    }
+
+    // FIN once everything queued so far has arrived
+    void closeAfterSent() { closeAtUs = std::max(lastByteUs, nowUs()); }
+
+    // RST: drop what has not arrived yet and close now
+    void reset() {
+        while (!toClient.empty() && toClient.back().first > nowUs()) toClient.pop_back();
+        closeAtUs = nowUs();
+    }
+
+    bool peerClosed() const { return nowUs() >= closeAtUs; }
+
+    size_t readable() const {
+        size_t n = 0;
+        while (n < toClient.size() && toClient[n].first <= nowUs()) n++;
+        return n;
+    }
+};
+
+class Endpoint {
+public:
+    virtual ~Endpoint() {}
+
+    uint32_t connectMs = 5;      // SYN to established
+    uint32_t handshakeMs = 0;    // TLS handshake (WiFiClientSecure only)
+    bool refuse = false;         // RST on SYN
+    bool blackhole = false;      // SYN never answered
+    bool tlsFails = false;       // Handshake rejected (bad certificate)
+    uint32_t connections = 0;    // Accepted so far
+
+    // New bytes are in conn.toServer
+    virtual void onData(Connection& conn) = 0;
+};
+
+inline std::map<std::pair<uint32_t, uint16_t>, Endpoint*>& endpoints() {
+    static std::map<std::pair<uint32_t, uint16_t>, Endpoint*> table;
+    return table;
+}
+
+inline void listen(IPAddress ip, uint16_t port, Endpoint* endpoint) {
+    endpoints()[{ (uint32_t)ip, port }] = endpoint;
+}
+
+inline Endpoint* endpointAt(IPAddress ip, uint16_t port) {
+    auto it = endpoints().find({ (uint32_t)ip, port });
+    return it != endpoints().end() ? it->second : nullptr;
+}
+
+}  // namespace fake
+
+class WiFiClient : public Client {
+public:
+    int connect(IPAddress ip, uint16_t port, int32_t timeout) {
+        fake::InNetwork scope;
+        stop();
+        fake::Endpoint* endpoint = fake::endpointAt(ip, port);
+        if (endpoint == nullptr || endpoint->refuse) {
+            fake::advance(1);
+            return 0;
+        }
+        if (endpoint->blackhole || (int32_t)endpoint->connectMs >= timeout) {
+            fake::advance(timeout > 0 ? timeout : 0);
+            return 0;
+        }
+
+        fake::advance(endpoint->connectMs);
+        _conn = std::make_shared<fake::Connection>();
+        _conn->endpoint = endpoint;
+        endpoint->connections++;
+        return 1;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override { return connect(ip, port, 30000); }
+    int connect(const char* host, uint16_t port) override;
+    int connect(const char* host, uint16_t port, int32_t timeout);
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (!_conn || _conn->peerClosed()) return 0;
+        fake::InNetwork scope;
+        _conn->toServer.append((const char*)buffer, size);
+        _conn->endpoint->onData(*_conn);
+        return size;
+    }
+
+    int available() override { return _conn ? (int)_conn->readable() : 0; }
+
+    int read() override {
+        if (available() == 0) return -1;
+        uint8_t c = _conn->toClient.front().second;
+        _conn->toClient.pop_front();
+        return c;
+    }
+
+    int read(uint8_t* buffer, size_t size) override {
+        size_t n = std::min(size, (size_t)available());
+        for (size_t i = 0; i < n; i++) buffer[i] = (uint8_t)read();
+        return n > 0 ? (int)n : -1;
+    }
+
+    int peek() override { return available() ? _conn->toClient.front().second : -1; }
+
+    void stop() override { _conn.reset(); }
+    uint8_t connected() override { return _conn && !_conn->peerClosed(); }
+    operator bool() override { return _conn != nullptr; }
+
+    void setTimeout(uint32_t) {}
+
+protected:
+    std::shared_ptr<fake::Connection> _conn;
+};
+
+#endif // SHIM_WIFICLIENT_H
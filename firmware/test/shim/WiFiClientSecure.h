@@ -0,0 +1,56 @@
+#ifndef SHIM_WIFICLIENTSECURE_H
+#define SHIM_WIFICLIENTSECURE_H
+
+// ============================================================================
+// Host Shim — WiFiClientSecure without the TLS
+// ============================================================================
+//
+// The plain in-memory transport plus the timing and failure modes of a
+// handshake: the TCP connect is bounded by the protected _timeout (30 s
+// unless a subclass changes it, as in core 2.x), then the endpoint's
+// handshakeMs runs against the handshake timeout. An endpoint with
+// tlsFails rejects the handshake once it has taken its time. Bytes then
+// flow in the clear.
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setCACert(const char*) {}
+    void setInsecure() {}
+    void setHandshakeTimeout(unsigned long seconds) { _handshakeTimeoutS = seconds; }
+
+    int connect(IPAddress ip, uint16_t port, const char* host, const char* rootCa,
+                const char* cert, const char* key) {
+        (void)host; (void)rootCa; (void)cert; (void)key;
+        if (!WiFiClient::connect(ip, port, _timeout)) return 0;
+
+        fake::Endpoint* endpoint = _conn->endpoint;
+        unsigned long limitMs = _handshakeTimeoutS * 1000;
+        if (endpoint->handshakeMs >= limitMs) {
+            fake::advance(limitMs);
+            stop();
+            return 0;
+        }
+        fake::advance(endpoint->handshakeMs);
+        if (endpoint->tlsFails) {
+            stop();
+            return 0;
+        }
+        return 1;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override {
+        return connect(ip, port, nullptr, nullptr, nullptr, nullptr);
+    }
+    using WiFiClient::connect;
+
+protected:
+    int _timeout = 30000;
+
+private:
+    unsigned long _handshakeTimeoutS = 120;
+};
+
+#endif // SHIM_WIFICLIENTSECURE_H
@@ -0,0 +1,18 @@
+#ifndef SHIM_WIFIMANAGER_H
+#define SHIM_WIFIMANAGER_H
+
+// ============================================================================
+// Host Shim — WiFiManager Declarations
+// ============================================================================
+//
+// Only what network.h names, so that modules using its types (PollResult)
+// build on the host. The captive portal itself, and network.cpp with it,
+// is not part of the native build.
+
+#include <Arduino.h>
+
+class WiFiManagerParameter {};
+
+class WiFiManager {};
+
+#endif // SHIM_WIFIMANAGER_H
@@ -0,0 +1,168 @@
+#ifndef SHIM_WIFIUDP_H
+#define SHIM_WIFIUDP_H
+
+// ============================================================================
+// Host Shim — WiFiUDP Multicast over an In-Memory Bus
+// ============================================================================
+//
+// Sockets that joined a group with beginMulticast() share one bus per
+// group and port. endPacket() queues a copy of the datagram on every
+// member, the sender included (multicast loopback is on by default), to be
+// read on the next parsePacket(). remoteIP() is the sender's address: the
+// fake::localIp it joined with, so a test sets fake::localIp per device
+// before that device's first update.
+//
+// fake::onMulticast() sees every datagram before delivery and may change
+// it (tampering) or return false to drop it (loss); fake::inject() puts a
+// datagram from an arbitrary address on the bus (spoofing, replays).
+// fake::resetMulticast() drops the members and the hook.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <deque>
+#include <functional>
+#include <vector>
+
+class WiFiUDP;
+
+namespace fake {
+
+struct Datagram {
+    IPAddress from;
+    std::string data;
+};
+
+struct Membership {
+    uint32_t group;
+    uint16_t port;
+    WiFiUDP* socket;
+};
+
+inline std::vector<Membership>& multicastMembers() {
+    static std::vector<Membership> members;
+    return members;
+}
+
+inline std::function<bool(Datagram&)>& multicastHook() {
+    static std::function<bool(Datagram&)> hook;
+    return hook;
+}
+
+inline void onMulticast(std::function<bool(Datagram&)> hook) {
+    multicastHook() = hook;
+}
+
+inline uint32_t& multicastSent() {
+    static uint32_t sent = 0;
+    return sent;
+}
+
+inline void deliver(IPAddress group, uint16_t port, Datagram datagram);
+inline void inject(IPAddress group, uint16_t port, IPAddress from, const std::string& data);
+
+inline void resetMulticast() {
+    multicastMembers().clear();
+    multicastHook() = nullptr;
+    multicastSent() = 0;
+}
+
+}  // namespace fake
+
+class WiFiUDP {
+public:
+    ~WiFiUDP() { stop(); }
+
+    uint8_t beginMulticast(IPAddress group, uint16_t port) {
+        stop();
+        if (fake::wifiStatus != WL_CONNECTED) return 0;
+        _address = fake::localIp;
+        fake::multicastMembers().push_back({ (uint32_t)group, port, this });
+        return 1;
+    }
+
+    void stop() {
+        auto& members = fake::multicastMembers();
+        for (size_t i = 0; i < members.size();) {
+            if (members[i].socket == this) {
+                members.erase(members.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        _inbox.clear();
+        _current.data.clear();
+        _readPos = 0;
+    }
+
+    int beginPacket(IPAddress ip, uint16_t port) {
+        _toGroup = ip;
+        _toPort = port;
+        _outgoing.clear();
+        return 1;
+    }
+
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t size) {
+        _outgoing.append((const char*)buffer, size);
+        return size;
+    }
+
+    int endPacket() {
+        fake::deliver(_toGroup, _toPort, { _address, _outgoing });
+        _outgoing.clear();
+        return 1;
+    }
+
+    // Size of the next datagram, 0 if none
+    int parsePacket() {
+        if (_inbox.empty()) return 0;
+        _current = _inbox.front();
+        _inbox.pop_front();
+        _readPos = 0;
+        return (int)_current.data.size();
+    }
+
+    int read(uint8_t* buffer, size_t size) {
+        size_t n = std::min(size, _current.data.size() - _readPos);
+        memcpy(buffer, _current.data.data() + _readPos, n);
+        _readPos += n;
+        return (int)n;
+    }
+
+    IPAddress remoteIP() const { return _current.from; }
+
+    void receive(const fake::Datagram& datagram) { _inbox.push_back(datagram); }
+
+private:
+    IPAddress _address;
+    IPAddress _toGroup;
+    uint16_t _toPort = 0;
+    std::string _outgoing;
+    std::deque<fake::Datagram> _inbox;
+    fake::Datagram _current;
+    size_t _readPos = 0;
+};
+
+namespace fake {
+
+inline void deliver(IPAddress group, uint16_t port, Datagram datagram) {
+    multicastSent()++;
+    if (multicastHook() && !multicastHook()(datagram)) return;
+    for (const Membership& member : multicastMembers()) {
+        if (member.group == (uint32_t)group && member.port == port) {
+            member.socket->receive(datagram);
+        }
+    }
+}
+
+inline void inject(IPAddress group, uint16_t port, IPAddress from, const std::string& data) {
+    for (const Membership& member : multicastMembers()) {
+        if (member.group == (uint32_t)group && member.port == port) {
+            member.socket->receive({ from, data });
+        }
+    }
+}
+
+}  // namespace fake
+
+#endif // SHIM_WIFIUDP_H
@@ -0,0 +1,102 @@
+#ifndef SHIM_ROM_MINIZ_H
+#define SHIM_ROM_MINIZ_H
+
+// ============================================================================
+// Host Shim — ROM tinfl on Top of zlib
+// ============================================================================
+//
+// The tinfl calls InflateReader makes, with tinfl's contract: output goes
+// into [next, next + *outSize) of a TINFL_LZ_DICT_SIZE window, *inSize and
+// *outSize come back as the bytes consumed and produced, and a stream that
+// runs out of input without TINFL_FLAG_HAS_MORE_INPUT fails. zlib keeps its
+// own history, so the window is only an output buffer here.
+//
+// Like the ROM decoder, it never touches the heap: zlib's state is carved
+// out of an arena inside the decompressor, so the allocation counts and
+// peak-heap figures of the native tests match the device's.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE  32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+typedef struct {
+    z_stream stream;
+    bool live;            // inflateInit2 has run on stream
+    size_t arenaUsed;
+    // inflate_state (~7 KB) plus its 32 KB window, with room to spare
+    alignas(16) uint8_t arena[48 * 1024];
+} tinfl_decompressor;
+
+inline voidpf tinflShimAlloc(voidpf opaque, uInt items, uInt size) {
+    tinfl_decompressor* r = (tinfl_decompressor*)opaque;
+    size_t need = ((size_t)items * size + 15) & ~(size_t)15;
+    if (r->arenaUsed + need > sizeof(r->arena)) return Z_NULL;
+    voidpf block = r->arena + r->arenaUsed;
+    r->arenaUsed += need;
+    return block;
+}
+
+inline void tinflShimFree(voidpf, voidpf) {}
+
+// Also rearms a decompressor that is mid-stream
+inline void tinfl_init(tinfl_decompressor* r) {
+    r->live = false;
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in,
+                                     size_t* inSize, uint8_t* outStart,
+                                     uint8_t* outNext, size_t* outSize,
+                                     const uint32_t flags) {
+    (void)outStart;
+    if (!r->live) {
+        memset(&r->stream, 0, sizeof(r->stream));
+        r->arenaUsed = 0;
+        r->stream.zalloc = tinflShimAlloc;
+        r->stream.zfree = tinflShimFree;
+        r->stream.opaque = r;
+        int windowBits = (flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? 15 : -15;
+        if (inflateInit2(&r->stream, windowBits) != Z_OK) {
+            *inSize = *outSize = 0;
+            return TINFL_STATUS_FAILED;
+        }
+        r->live = true;
+    }
+
+    z_stream& s = r->stream;
+    s.next_in = (Bytef*)in;
+    s.avail_in = (uInt)*inSize;
+    s.next_out = outNext;
+    s.avail_out = (uInt)*outSize;
+
+    int rc = inflate(&s, Z_NO_FLUSH);
+    *inSize -= s.avail_in;
+    *outSize -= s.avail_out;
+
+    if (rc == Z_STREAM_END) return TINFL_STATUS_DONE;
+    if (rc != Z_OK && rc != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+    if (s.avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+    if (flags & TINFL_FLAG_HAS_MORE_INPUT) return TINFL_STATUS_NEEDS_MORE_INPUT;
+    return TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+}
+
+#endif // SHIM_ROM_MINIZ_H
@@ -0,0 +1,196 @@
+#ifndef SHIM_FAKE_WEBHOOK_H
+#define SHIM_FAKE_WEBHOOK_H
+
+// ============================================================================
+// Mock Webhook Server with Chaos Modes
+// ============================================================================
+//
+// Not a library shim: an n8n-like endpoint for the in-memory network of
+// WiFiClient.h. It serves one body per path (or a default body) with an
+// ETag derived from the body, answers If-None-Match with 304, and keeps
+// pipelined responses in order. Responses start latencyMs after their
+// request arrives and then arrive at the link rate, one byte every
+// usPerByte. contentEncoding labels the stored bodies (already compressed
+// by the test) with a Content-Encoding.
+//
+// chaos misbehaves on purpose, per request:
+//
+//   CHAOS_SLOW_DRIP     the response trickles in, one byte every dripUs
+//   CHAOS_TRUNCATE      Content-Length promises the full body; half is sent,
+//                       then the connection closes
+//   CHAOS_RESET         the connection is reset as the request arrives
+//   CHAOS_STALL         the request is swallowed and never answered
+//   CHAOS_STATUS        answers `status` (401, 403, 429, 5xx) with a short
+//                       JSON error body
+//   CHAOS_CLOSE_EARLY   the first response on a connection says
+//                       "Connection: close" and the rest of the pipeline is
+//                       dropped
+//   CHAOS_GARBAGE       a status line that is not HTTP
+//
+// Connection-level faults (refused, blackholed, slow or failing TLS) are
+// the Endpoint fields inherited from fake::Endpoint.
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <map>
+
+namespace fake {
+
+enum Chaos : uint8_t {
+    CHAOS_NONE,
+    CHAOS_SLOW_DRIP,
+    CHAOS_TRUNCATE,
+    CHAOS_RESET,
+    CHAOS_STALL,
+    CHAOS_STATUS,
+    CHAOS_CLOSE_EARLY,
+    CHAOS_GARBAGE,
+    CHAOS_COUNT
+};
+
+inline const char* chaosName(Chaos chaos) {
+    static const char* const names[CHAOS_COUNT] = {
+        "none", "slow drip", "truncate", "reset", "stall", "status",
+        "close early", "garbage"
+    };
+    return chaos < CHAOS_COUNT ? names[chaos] : "?";
+}
+
+class Webhook : public Endpoint {
+public:
+    Chaos chaos = CHAOS_NONE;
+    int status = 500;              // For CHAOS_STATUS
+    uint32_t latencyMs = 40;       // Request to first response byte
+    uint32_t dripUs = 20000;       // For CHAOS_SLOW_DRIP
+    uint32_t usPerByte = 0;        // Link rate (0 = instant)
+    bool chunked = false;          // Transfer-Encoding: chunked bodies
+    const char* contentType = "application/json";
+    const char* contentEncoding = nullptr;
+
+    // Counters
+    uint32_t requests = 0;
+    uint32_t notModified = 0;
+
+    void setBody(const std::string& body) { _defaultBody = body; }
+    void setBody(const std::string& path, const std::string& body) { _bodies[path] = body; }
+
+    const std::string& bodyFor(const std::string& path) const {
+        auto it = _bodies.find(path);
+        return it != _bodies.end() ? it->second : _defaultBody;
+    }
+
+    // Strong validator of a body (FNV-1a)
+    static std::string etagOf(const std::string& body) {
+        uint32_t hash = 2166136261u;
+        for (char c : body) hash = (hash ^ (uint8_t)c) * 16777619u;
+        char etag[16];
+        snprintf(etag, sizeof(etag), "\"%08x\"", hash);
+        return etag;
+    }
+
+    void onData(Connection& conn) override {
+        size_t end;
+        while (conn.closeAtUs == UINT64_MAX &&
+               (end = conn.toServer.find("\r\n\r\n")) != std::string::npos) {
+            std::string request = conn.toServer.substr(0, end + 2);
+            conn.toServer.erase(0, end + 4);
+            requests++;
+            conn.requests++;
+            _respond(conn, request);
+        }
+    }
+
+private:
+    std::string _defaultBody = "{\"cost_usd\":12.50,\"trend\":\"up\",\"tokens_total\":1234567}";
+    std::map<std::string, std::string> _bodies;
+
+    static std::string _header(const std::string& request, const char* name) {
+        std::string key = std::string("\r\n") + name + ":";
+        size_t at = request.find(key);
+        if (at == std::string::npos) return "";
+        at += key.size();
+        while (at < request.size() && request[at] == ' ') at++;
+        return request.substr(at, request.find("\r\n", at) - at);
+    }
+
+    void _respond(Connection& conn, const std::string& request) {
+        uint64_t at = nowUs() + (uint64_t)latencyMs * 1000;
+        bool clientCloses = _header(request, "Connection") == "close";
+
+        switch (chaos) {
+            case CHAOS_RESET:
+                conn.reset();
+                return;
+            case CHAOS_STALL:
+                return;
+            case CHAOS_GARBAGE:
+                conn.send("HTP/1.1 OK\r\n\r\n", at);
+                conn.closeAfterSent();
+                return;
+            case CHAOS_STATUS: {
+                char line[128];
+                std::string body = "{\"error\":\"chaos\"}";
+                snprintf(line, sizeof(line),
+                         "HTTP/1.1 %d Chaos\r\nContent-Type: application/json\r\n"
+                         "Content-Length: %u\r\n%s%s\r\n",
+                         status, (unsigned)body.size(),
+                         status == 429 ? "Retry-After: 30\r\n" : "",
+                         clientCloses ? "Connection: close\r\n" : "");
+                conn.send(line + body, at);
+                if (clientCloses) conn.closeAfterSent();
+                return;
+            }
+            default:
+                break;
+        }
+
+        size_t pathStart = request.find(' ') + 1;
+        std::string path = request.substr(pathStart, request.find(' ', pathStart) - pathStart);
+        const std::string& body = bodyFor(path);
+        std::string etag = etagOf(body);
+        bool closing = clientCloses || (chaos == CHAOS_CLOSE_EARLY && conn.requests == 1);
+
+        std::string response;
+        if (_header(request, "If-None-Match") == etag) {
+            notModified++;
+            response = "HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\n";
+            if (closing) response += "Connection: close\r\n";
+            response += "\r\n";
+        } else {
+            std::string framed = body;
+            response = "HTTP/1.1 200 OK\r\nContent-Type: " + std::string(contentType) +
+                       "\r\nETag: " + etag + "\r\n";
+            if (contentEncoding != nullptr) {
+                response += "Content-Encoding: " + std::string(contentEncoding) + "\r\n";
+            }
+            if (chunked) {
+                // Two chunks, so the reader has to join them
+                size_t half = body.size() / 2;
+                char size1[24], size2[24];
+                snprintf(size1, sizeof(size1), "%zx\r\n", half);
+                snprintf(size2, sizeof(size2), "%zx\r\n", body.size() - half);
+                framed = size1 + body.substr(0, half) + "\r\n" + size2 +
+                         body.substr(half) + "\r\n0\r\n\r\n";
+                response += "Transfer-Encoding: chunked\r\n";
+            } else {
+                response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+            }
+            if (closing) response += "Connection: close\r\n";
+            response += "\r\n";
+
+            if (chaos == CHAOS_TRUNCATE) {
+                conn.send(response + framed.substr(0, framed.size() / 2), at);
+                conn.closeAfterSent();
+                return;
+            }
+            response += framed;
+        }
+
+        conn.send(response, at, chaos == CHAOS_SLOW_DRIP ? dripUs : usPerByte);
+        if (closing) conn.closeAfterSent();
+    }
+};
+
+}  // namespace fake
+
+#endif // SHIM_FAKE_WEBHOOK_H
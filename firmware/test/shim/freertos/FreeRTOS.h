@@ -0,0 +1,14 @@
+#ifndef SHIM_FREERTOS_H
+#define SHIM_FREERTOS_H
+
+// ============================================================================
+// Host Shim — FreeRTOS Handle Types
+// ============================================================================
+//
+// Declarations only, for headers that keep task and semaphore handles
+// (network.h). Nothing in the native build creates a task.
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+
+#endif // SHIM_FREERTOS_H
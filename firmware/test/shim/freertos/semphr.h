@@ -0,0 +1,6 @@
+#ifndef SHIM_SEMPHR_H
+#define SHIM_SEMPHR_H
+
+#include <freertos/FreeRTOS.h>
+
+#endif // SHIM_SEMPHR_H
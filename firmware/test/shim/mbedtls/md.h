@@ -0,0 +1,175 @@
+#ifndef SHIM_MBEDTLS_MD_H
+#define SHIM_MBEDTLS_MD_H
+
+// ============================================================================
+// Host Shim — mbedtls Message Digest, HMAC-SHA256 Only
+// ============================================================================
+//
+// The calls Relay makes to sign datagrams. SHA-256 per FIPS 180-4 and HMAC
+// per RFC 2104; no other digest exists, so the md_info is a tag.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 6
+} mbedtls_md_type_t;
+
+typedef struct {
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+namespace fake {
+
+struct Sha256 {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    size_t used;
+
+    void begin() {
+        static const uint32_t initial[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        memcpy(state, initial, sizeof(state));
+        length = 0;
+        used = 0;
+    }
+
+    void update(const uint8_t* data, size_t size) {
+        length += size;
+        while (size > 0) {
+            size_t n = 64 - used < size ? 64 - used : size;
+            memcpy(block + used, data, n);
+            used += n;
+            data += n;
+            size -= n;
+            if (used == 64) {
+                compress();
+                used = 0;
+            }
+        }
+    }
+
+    void finish(uint8_t digest[32]) {
+        uint64_t bits = length * 8;
+        uint8_t pad = 0x80;
+        update(&pad, 1);
+        pad = 0;
+        while (used != 56) update(&pad, 1);
+        uint8_t tail[8];
+        for (int i = 0; i < 8; i++) tail[i] = (uint8_t)(bits >> (56 - 8 * i));
+        update(tail, 8);
+        for (int i = 0; i < 32; i++) digest[i] = (uint8_t)(state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+
+private:
+    static uint32_t ror(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+    void compress() {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+                   (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = ror(w[i - 15], 7) ^ ror(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = ror(w[i - 2], 17) ^ ror(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (ror(e, 6) ^ ror(e, 11) ^ ror(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (ror(a, 2) ^ ror(a, 13) ^ ror(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+};
+
+}  // namespace fake
+
+typedef struct {
+    fake::Sha256 inner;
+    uint8_t outerPad[64];
+} mbedtls_md_context_t;
+
+inline const mbedtls_md_info_t* mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+    static const mbedtls_md_info_t sha256 = { MBEDTLS_MD_SHA256 };
+    return type == MBEDTLS_MD_SHA256 ? &sha256 : nullptr;
+}
+
+inline void mbedtls_md_init(mbedtls_md_context_t* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+inline void mbedtls_md_free(mbedtls_md_context_t* ctx) { memset(ctx, 0, sizeof(*ctx)); }
+
+inline int mbedtls_md_setup(mbedtls_md_context_t*, const mbedtls_md_info_t* info, int) {
+    return info != nullptr ? 0 : -1;
+}
+
+inline int mbedtls_md_hmac_starts(mbedtls_md_context_t* ctx, const uint8_t* key, size_t keyLength) {
+    uint8_t block[64] = {};
+    if (keyLength > 64) {
+        fake::Sha256 hash;
+        hash.begin();
+        hash.update(key, keyLength);
+        hash.finish(block);
+    } else {
+        memcpy(block, key, keyLength);
+    }
+
+    uint8_t innerPad[64];
+    for (int i = 0; i < 64; i++) {
+        innerPad[i] = block[i] ^ 0x36;
+        ctx->outerPad[i] = block[i] ^ 0x5c;
+    }
+    ctx->inner.begin();
+    ctx->inner.update(innerPad, 64);
+    return 0;
+}
+
+inline int mbedtls_md_hmac_update(mbedtls_md_context_t* ctx, const uint8_t* data, size_t length) {
+    ctx->inner.update(data, length);
+    return 0;
+}
+
+inline int mbedtls_md_hmac_finish(mbedtls_md_context_t* ctx, uint8_t* output) {
+    uint8_t innerDigest[32];
+    ctx->inner.finish(innerDigest);
+    fake::Sha256 outer;
+    outer.begin();
+    outer.update(ctx->outerPad, 64);
+    outer.update(innerDigest, 32);
+    outer.finish(output);
+    return 0;
+}
+
+inline int mbedtls_md_hmac(const mbedtls_md_info_t* info, const uint8_t* key, size_t keyLength,
+                           const uint8_t* input, size_t length, uint8_t* output) {
+    if (info == nullptr) return -1;
+    mbedtls_md_context_t ctx;
+    mbedtls_md_init(&ctx);
+    mbedtls_md_hmac_starts(&ctx, key, keyLength);
+    mbedtls_md_hmac_update(&ctx, input, length);
+    mbedtls_md_hmac_finish(&ctx, output);
+    mbedtls_md_free(&ctx);
+    return 0;
+}
+
+#endif // SHIM_MBEDTLS_MD_H
@@ -0,0 +1,232 @@
+// ============================================================================
+// Capture Record, Rotation and Replay
+// ============================================================================
+//
+// Records poll cycles through Capture onto the in-memory LittleFS of
+// test/shim and replays them: every field of a result survives the round
+// trip, the log rotates at CAPTURE_MAX_BYTES without splitting a cycle
+// across files, and replay hands back the per-poll bodies regrouped into
+// their cycles, in order, at the recorded pace.
+//
+// Needs CAPTURE_MODE 2 (replay buffers): `pio test -e native_capture`.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <LittleFS.h>
+#include "capture.h"
+
+static const uint32_t POLL_MS = 60000;
+
+static Capture* capture;
+static PollResult polled;
+static std::string bodies[MAX_SOURCES];
+
+// A poll cycle of count sources, bodies "cycle <n> source <i>" padded to
+// bodyBytes (at least the label)
+static const PollResult& cycle(uint32_t n, uint8_t count, size_t bodyBytes = 0) {
+    memset(&polled, 0, sizeof(polled));
+    polled.success = true;
+    polled.sourceCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        char label[32];
+        snprintf(label, sizeof(label), "cycle %u source %u", n, i);
+        bodies[i] = label;
+        if (bodies[i].size() < bodyBytes) bodies[i].append(bodyBytes - bodies[i].size(), '.');
+
+        FetchResult& r = polled.sources[i];
+        r.success = true;
+        r.httpCode = 200;
+        r.payload = bodies[i].c_str();
+        r.payloadLength = bodies[i].size();
+        r.format = FORMAT_JSON;
+        r.encoding = ENCODING_IDENTITY;
+        r.elapsedMs = 100 + i;
+        r.failedPhase = PHASE_COUNT;
+    }
+    polled.elapsedMs = 100 + count - 1;
+    return polled;
+}
+
+static std::string body(const FetchResult& r) {
+    return r.payload != nullptr ? std::string(r.payload, r.payloadLength) : "";
+}
+
+// Replay every cycle back to back, letting simulated time run to each one
+static std::vector<PollResult> replayAll(std::vector<std::vector<std::string>>* bodiesOut) {
+    std::vector<PollResult> cycles;
+    PollResult result;
+    TEST_ASSERT_TRUE(capture->beginReplay());
+    for (int idle = 0; idle < 1000; idle++) {
+        if (!capture->nextCycle(result)) {
+            fake::advance(POLL_MS / 10);
+            continue;
+        }
+        idle = 0;
+        cycles.push_back(result);
+        if (bodiesOut != nullptr) {
+            std::vector<std::string> texts;
+            for (uint8_t i = 0; i < result.sourceCount; i++) texts.push_back(body(result.sources[i]));
+            bodiesOut->push_back(texts);
+        }
+    }
+    return cycles;
+}
+
+void setUp() {
+    fake::resetClock();
+    fake::fsErase();
+    capture = new Capture();
+    TEST_ASSERT_TRUE(capture->begin());
+}
+
+void tearDown() {
+    delete capture;
+}
+
+void test_record_round_trips() {
+#if CAPTURE_MODE == 2
+    // A good cycle: JSON and a compressed MessagePack body
+    PollResult first = cycle(1, 2);
+    first.sources[1].format = FORMAT_MSGPACK;
+    first.sources[1].encoding = ENCODING_GZIP;
+    capture->record(first, 1000);
+
+    // 304 for one source, a 503 for the other
+    PollResult second = cycle(2, 2);
+    second.success = false;
+    second.httpCode = 503;
+    second.errorMsg = ERR_HTTP;
+    second.sources[0].notModified = true;
+    second.sources[0].payload = nullptr;
+    second.sources[0].payloadLength = 0;
+    second.sources[1].success = false;
+    second.sources[1].httpCode = 503;
+    second.sources[1].errorMsg = ERR_HTTP;
+    second.sources[1].failedPhase = PHASE_BODY;
+    second.sources[1].elapsedMs = 4321;
+    capture->record(second, 1000 + POLL_MS);
+
+    // A poll that never started
+    PollResult third = {};
+    third.errorMsg = ERR_WIFI;
+    capture->record(third, 1000 + 2 * POLL_MS);
+
+    std::vector<std::vector<std::string>> texts;
+    std::vector<PollResult> cycles = replayAll(&texts);
+    TEST_ASSERT_EQUAL(3, cycles.size());
+
+    const PollResult& a = cycles[0];
+    TEST_ASSERT_TRUE(a.success);
+    TEST_ASSERT_EQUAL(2, a.sourceCount);
+    TEST_ASSERT_EQUAL_STRING("cycle 1 source 0", texts[0][0].c_str());
+    TEST_ASSERT_EQUAL_STRING("cycle 1 source 1", texts[0][1].c_str());
+    TEST_ASSERT_EQUAL(200, a.sources[0].httpCode);
+    TEST_ASSERT_EQUAL(FORMAT_JSON, a.sources[0].format);
+    TEST_ASSERT_EQUAL(FORMAT_MSGPACK, a.sources[1].format);
+    TEST_ASSERT_EQUAL(ENCODING_GZIP, a.sources[1].encoding);
+    TEST_ASSERT_EQUAL_UINT32(101, a.sources[1].elapsedMs);
+    TEST_ASSERT_EQUAL_UINT32(101, a.elapsedMs);
+    TEST_ASSERT_EQUAL(PHASE_COUNT, a.sources[0].failedPhase);
+    TEST_ASSERT_NULL(a.sources[0].errorMsg);
+
+    const PollResult& b = cycles[1];
+    TEST_ASSERT_FALSE(b.success);
+    TEST_ASSERT_EQUAL(503, b.httpCode);
+    TEST_ASSERT_EQUAL_STRING(ERR_HTTP, b.errorMsg);
+    TEST_ASSERT_TRUE(b.sources[0].success);
+    TEST_ASSERT_TRUE(b.sources[0].notModified);
+    TEST_ASSERT_NULL(b.sources[0].payload);
+    TEST_ASSERT_FALSE(b.sources[1].success);
+    TEST_ASSERT_EQUAL_STRING(ERR_HTTP, b.sources[1].errorMsg);
+    TEST_ASSERT_EQUAL(PHASE_BODY, b.sources[1].failedPhase);
+    TEST_ASSERT_EQUAL_UINT32(4321, b.elapsedMs);
+
+    const PollResult& c = cycles[2];
+    TEST_ASSERT_FALSE(c.success);
+    TEST_ASSERT_EQUAL(0, c.sourceCount);
+    TEST_ASSERT_EQUAL_STRING(ERR_WIFI, c.errorMsg);
+#else
+    TEST_IGNORE_MESSAGE("needs CAPTURE_MODE 2 (pio test -e native_capture)");
+#endif
+}
+
+void test_rotation_at_the_size_cap() {
+#if CAPTURE_MODE == 2
+    // Two 7000-byte bodies a cycle: the cap falls mid-cycle more often than not
+    const size_t bodyBytes = 7000;
+    const uint32_t cycles = CAPTURE_MAX_BYTES * 5 / 2 / (2 * bodyBytes);
+    for (uint32_t n = 1; n <= cycles; n++) {
+        capture->record(cycle(n, 2, bodyBytes), n * POLL_MS);
+    }
+
+    // Two files at most, each within the cap
+    File current = LittleFS.open(CAPTURE_PATH, FILE_READ);
+    File old = LittleFS.open(CAPTURE_PATH_OLD, FILE_READ);
+    TEST_ASSERT_TRUE(current);
+    TEST_ASSERT_TRUE(old);
+    TEST_ASSERT_LESS_OR_EQUAL(CAPTURE_MAX_BYTES, current.size());
+    TEST_ASSERT_LESS_OR_EQUAL(CAPTURE_MAX_BYTES, old.size());
+    TEST_ASSERT_GREATER_THAN(CAPTURE_MAX_BYTES - 2 * (bodyBytes + 64), old.size());
+    TEST_ASSERT_EQUAL(2, fake::files().size());
+
+    // What is left replays as whole, consecutive cycles up to the last one
+    std::vector<std::vector<std::string>> texts;
+    std::vector<PollResult> replayed = replayAll(&texts);
+    TEST_ASSERT_GREATER_THAN(0, replayed.size());
+    TEST_ASSERT_LESS_THAN(cycles, replayed.size());
+    uint32_t firstKept = cycles - replayed.size() + 1;
+    for (size_t k = 0; k < replayed.size(); k++) {
+        char expected[32];
+        TEST_ASSERT_EQUAL(2, replayed[k].sourceCount);
+        for (uint8_t i = 0; i < 2; i++) {
+            snprintf(expected, sizeof(expected), "cycle %u source %u", (unsigned)(firstKept + k), i);
+            TEST_ASSERT_EQUAL_STRING(expected, texts[k][i].substr(0, strlen(expected)).c_str());
+            TEST_ASSERT_EQUAL(bodyBytes, texts[k][i].size());
+        }
+    }
+#else
+    TEST_IGNORE_MESSAGE("needs CAPTURE_MODE 2 (pio test -e native_capture)");
+#endif
+}
+
+void test_replay_regroups_cycles_in_order() {
+#if CAPTURE_MODE == 2
+    // Source counts vary from poll to poll
+    const uint8_t counts[] = { 1, 3, 2, 3, 1, 1, 2 };
+    const size_t polls = sizeof(counts);
+    for (size_t n = 0; n < polls; n++) {
+        capture->record(cycle(n, counts[n]), 5000 + n * POLL_MS);
+    }
+
+    PollResult result;
+    TEST_ASSERT_TRUE(capture->beginReplay());
+    for (size_t n = 0; n < polls; n++) {
+        // Held back until its recorded offset, then due at once
+        if (n > 0) {
+            TEST_ASSERT_FALSE(capture->nextCycle(result));
+            fake::advance(POLL_MS - 1);
+            TEST_ASSERT_FALSE(capture->nextCycle(result));
+            fake::advance(1);
+        }
+        TEST_ASSERT_TRUE(capture->nextCycle(result));
+        TEST_ASSERT_EQUAL(counts[n], result.sourceCount);
+        for (uint8_t i = 0; i < result.sourceCount; i++) {
+            char expected[32];
+            snprintf(expected, sizeof(expected), "cycle %u source %u", (unsigned)n, i);
+            TEST_ASSERT_EQUAL_STRING(expected, body(result.sources[i]).c_str());
+        }
+    }
+    fake::advance(10 * POLL_MS);
+    TEST_ASSERT_FALSE(capture->nextCycle(result));
+#else
+    TEST_IGNORE_MESSAGE("needs CAPTURE_MODE 2 (pio test -e native_capture)");
+#endif
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_round_trips);
+    RUN_TEST(test_rotation_at_the_size_cap);
+    RUN_TEST(test_replay_regroups_cycles_in_order);
+    return UNITY_END();
+}
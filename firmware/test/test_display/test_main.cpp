@@ -0,0 +1,465 @@
+// ============================================================================
+// Display Golden Frames
+// ============================================================================
+//
+// Renders readings through DisplayManager on the fake MD_Parola/MD_MAX72XX
+// (test/shim) and compares dumpFrame() output with frames checked in below.
+// The frames pin down what the tests can see on a real chain: zone widths,
+// centering, which values fit and which scroll, and how errors, the boot
+// animation and the carousel take over the matrix. The font is the shim's,
+// so a golden frame is about layout, not glyph shapes.
+//
+// Run with `pio test -e native` (4 modules) and `pio test -e native_8`,
+// `native_12` and `native_16` (zoned layouts); any other chain length has
+// no frames and does not compile. A failing case prints the frame it got; after a
+// deliberate layout change, paste that in as the new golden frame.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "display.h"
+
+static DisplayManager* display;
+
+static std::string frame() {
+    fake::PrintBuffer out;
+    display->dumpFrame(out);
+    return out.text;
+}
+
+static MeterData reading(float cost, uint64_t tokens, Trend trend) {
+    MeterData data = {};
+    data.valid = true;
+    data.costUsd = cost;
+    data.trend = trend;
+    data.tokens.uncachedInputTokens = tokens / 2;
+    data.tokens.outputTokens = tokens / 4;
+    data.tokens.cacheReadTokens = tokens / 4;
+    data.tokens.totalTokens = tokens;
+    data.sourceCount = 1;
+    return data;
+}
+
+void setUp() {
+    fake::resetClock();
+    display = new DisplayManager();
+    display->begin();
+}
+
+void tearDown() {
+    delete display;
+}
+
+#define ASSERT_FRAME(expected)  TEST_ASSERT_EQUAL_STRING(expected, frame().c_str())
+
+#if DISPLAY_NUM_DEVICES == 4
+
+// ---------------------------------------------------------------------------
+// Single zone (4 modules, 32 columns)
+// ---------------------------------------------------------------------------
+
+static const char* const COST_12_50 =
+    "...#....#...###.....#####..###..\n"
+    "..####.##..#...#....#.....#...#.\n"
+    ".#.#....#......#....####..#..##.\n"
+    "..###...#...###.........#.#.#.#.\n"
+    "...#.#..#..#............#.##..#.\n"
+    ".####...#..#.....##.#...#.#...#.\n"
+    "...#...###.#####.##..###...###..\n"
+    "................................\n";
+
+static const char* const COST_1234 =
+    "....#....#...###..#####....#....\n"
+    "...####.##..#...#.....#...##....\n"
+    "..#.#....#......#....#...#.#....\n"
+    "...###...#...###....##..#..#....\n"
+    "....#.#..#..#.........#.#####...\n"
+    "..####...#..#.....#...#....#....\n"
+    "....#...###.#####..###.....#....\n"
+    "................................\n";
+
+static const char* const TOKENS_1_2M =
+    "........#......###..#...#.......\n"
+    ".......##.....#...#.##.##.......\n"
+    "........#.........#.#.#.#.......\n"
+    "........#......###..#.#.#.......\n"
+    "........#.....#.....#.#.#.......\n"
+    "........#..##.#.....#...#.......\n"
+    ".......###.##.#####.#...#.......\n"
+    "................................\n";
+
+static const char* const TOKENS_999 =
+    "........###...###...###.........\n"
+    ".......#...#.#...#.#...#........\n"
+    ".......#...#.#...#.#...#........\n"
+    "........####..####..####........\n"
+    "...........#.....#.....#........\n"
+    "..........#.....#.....#.........\n"
+    ".......###...###...###..........\n"
+    "................................\n";
+
+static const char* const ERROR_WIFI =
+    "#####.......#...#.###.#####.###.\n"
+    "#...........#...#..#..#......#..\n"
+    "#...........#...#..#..#......#..\n"
+    "####..#####.#.#.#..#..####...#..\n"
+    "#...........#.#.#..#..#......#..\n"
+    "#...........#.#.#..#..#......#..\n"
+    "#####........#.#..###.#.....###.\n"
+    "................................\n";
+
+static const char* const BLANK =
+    "................................\n"
+    "................................\n"
+    "................................\n"
+    "................................\n"
+    "................................\n"
+    "................................\n"
+    "................................\n"
+    "................................\n";
+
+static const char* const BOOT_CLAUDE =
+    "..............###..#.......#...#\n"
+    ".............#...#.#......#.#..#\n"
+    ".............#.....#.....#...#.#\n"
+    ".............#.....#.....#...#.#\n"
+    ".............#.....#.....#####.#\n"
+    ".............#...#.#.....#...#.#\n"
+    "..............###..#####.#...#..\n"
+    "................................\n";
+
+static const char* const BOOT_METER =
+    ".#...#.#####.#####.#####.####...\n"
+    ".##.##.#.....#.#.#.#.....#...#..\n"
+    ".#.#.#.#.......#...#.....#...#..\n"
+    ".#.#.#.####....#...####..####...\n"
+    ".#.#.#.#.......#...#.....#.#....\n"
+    ".#...#.#.......#...#.....#..#...\n"
+    ".#...#.#####...#...#####.#...#..\n"
+    "................................\n";
+
+static const char* const PAGE_INPUT_FRAME =
+    "...###..#..#####....#####.#...#.\n"
+    "..#....##......#........#.#..#..\n"
+    ".#......#......#.......#..#.#...\n"
+    ".####...#.....#.......##..##....\n"
+    ".#...#..#....#..........#.#.#...\n"
+    ".#...#..#...#....##.#...#.#..#..\n"
+    "..###..###.#.....##..###..#...#.\n"
+    "................................\n";
+
+static const char* const PAGE_TREND_FRAME =
+    "........#......#...#.####.......\n"
+    ".......###.....#...#.#...#......\n"
+    "......#.#.#....#...#.#...#......\n"
+    "........#......#...#.####.......\n"
+    "........#......#...#.#..........\n"
+    "........#......#...#.#..........\n"
+    "........#.......###..#..........\n"
+    "................................\n";
+
+static const char* const SCROLL_AFTER_10 =
+    "........................###...##\n"
+    ".......................#...#.#..\n"
+    ".......................#.....#..\n"
+    ".......................#.....#..\n"
+    ".......................#.....#..\n"
+    ".......................#...#.#..\n"
+    "........................###...##\n"
+    "................................\n";
+
+void test_cost_is_centered() {
+    display->showCost(12.5f);
+    ASSERT_FRAME(COST_12_50);
+}
+
+void test_cost_over_100_drops_cents() {
+    display->showCost(1234.4f);
+    ASSERT_FRAME(COST_1234);
+}
+
+void test_tokens_compact() {
+    display->showTokens(1234567);
+    ASSERT_FRAME(TOKENS_1_2M);
+}
+
+void test_tokens_below_1000_are_exact() {
+    display->showTokens(999);
+    ASSERT_FRAME(TOKENS_999);
+}
+
+void test_compact_widths_fit_one_zone() {
+    // Every K/M/B form must print statically on the narrowest chain; only
+    // status text is meant to scroll
+    const uint64_t values[] = { 0, 999, 1000, 999949, 999999, 1000000,
+                                 999949999ULL, 1000000000ULL, 999900000000ULL };
+    for (uint64_t value : values) {
+        display->showTokens(value);
+        std::string shown = frame();
+        fake::advance(SCROLL_SPEED_MS * 3);
+        display->update();
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(shown.c_str(), frame().c_str(),
+                                         "a token count scrolled");
+    }
+}
+
+void test_error_blinks() {
+    display->showError("E-WIFI");
+    ASSERT_FRAME(ERROR_WIFI);
+
+    fake::advance(500);
+    display->update();
+    ASSERT_FRAME(BLANK);
+
+    fake::advance(500);
+    display->update();
+    ASSERT_FRAME(ERROR_WIFI);
+}
+
+void test_boot_animation() {
+    // "CLAUDE" is wider than 4 modules, so it scrolls in
+    display->showBootAnimation();
+    ASSERT_FRAME(BLANK);
+
+    for (int i = 0; i < 20; i++) {
+        display->update();
+        fake::advance(SCROLL_SPEED_MS);
+    }
+    ASSERT_FRAME(BOOT_CLAUDE);
+
+    fake::advance(1200);
+    display->update();
+    display->update();
+    ASSERT_FRAME(BOOT_METER);
+
+    fake::advance(800);
+    display->update();
+    display->update();
+    ASSERT_FRAME(BLANK);
+}
+
+void test_scrolling_text_enters_from_the_right() {
+    display->showScrolling("CONNECTING");
+    ASSERT_FRAME(BLANK);
+
+    for (int i = 0; i < 10; i++) {
+        display->update();
+        fake::advance(SCROLL_SPEED_MS);
+    }
+    ASSERT_FRAME(SCROLL_AFTER_10);
+}
+
+void test_carousel_pages() {
+    MeterData data = reading(12.5f, 1234567, TREND_UP);
+    display->showCarousel(data);
+    ASSERT_FRAME(COST_12_50);
+
+    display->showCarousel(data, PAGE_INPUT);   // Already running: page kept
+    ASSERT_FRAME(COST_12_50);
+
+    display->showStatic("");
+    display->showCarousel(data, PAGE_INPUT);
+    ASSERT_FRAME(PAGE_INPUT_FRAME);
+
+    display->showStatic("");
+    display->showCarousel(data, PAGE_TREND);
+    ASSERT_FRAME(PAGE_TREND_FRAME);
+}
+
+void test_carousel_stops_for_text() {
+    display->showCarousel(reading(12.5f, 1234567, TREND_UP));
+    display->showCost(12.5f);   // Same text Parola drew before: still redrawn
+    ASSERT_FRAME(COST_12_50);
+}
+
+#elif DISPLAY_NUM_DEVICES == 8 || DISPLAY_NUM_DEVICES == 12 || DISPLAY_NUM_DEVICES == 16
+
+#if DISPLAY_NUM_DEVICES == 8
+
+// ---------------------------------------------------------------------------
+// Zoned layout (8 modules: cost 4 | tokens 3 | trend 1)
+// ---------------------------------------------------------------------------
+
+static const char* const METER_UP =
+    "...#....#...###.....#####..###......#......###..#...#......#....\n"
+    "..####.##..#...#....#.....#...#....##.....#...#.##.##.....###...\n"
+    ".#.#....#......#....####..#..##.....#.........#.#.#.#....#.#.#..\n"
+    "..###...#...###.........#.#.#.#.....#......###..#.#.#......#....\n"
+    "...#.#..#..#............#.##..#.....#.....#.....#.#.#......#....\n"
+    ".####...#..#.....##.#...#.#...#.....#..##.#.....#...#......#....\n"
+    "...#...###.#####.##..###...###.....###.##.#####.#...#......#....\n"
+    "................................................................\n";
+
+static const char* const METER_DOWN_BIG =
+    "......#...#####....#..#####.......#####....#####.#...#.....#....\n"
+    ".....####.....#...##..#...............#....#.....#..#......#....\n"
+    "....#.#......#...#.#..####............#....####..#.#.......#....\n"
+    ".....###....##..#..#......#..........#.........#.##........#....\n"
+    "......#.#.....#.#####.....#.........#..........#.#.#.....#.#.#..\n"
+    "....####..#...#....#..#...#........#....##.#...#.#..#.....###...\n"
+    "......#....###.....#...###........#.....##..###..#...#.....#....\n"
+    "................................................................\n";
+
+static const char* const STATUS_ONLY =
+    ".....###..#...#.#...#..###......................................\n"
+    "....#...#.#...#.#...#.#...#.....................................\n"
+    "....#......#.#..##..#.#.........................................\n"
+    ".....###....#...#.#.#.#.........................................\n"
+    "........#...#...#..##.#.........................................\n"
+    "....#...#...#...#...#.#...#.....................................\n"
+    ".....###....#...#...#..###......................................\n"
+    "................................................................\n";
+
+#elif DISPLAY_NUM_DEVICES == 12
+
+// ---------------------------------------------------------------------------
+// Zoned layout (12 modules: cost 4 | tokens 4 | trend 1 | sparkline 3)
+// ---------------------------------------------------------------------------
+
+static const char* const METER_UP =
+    "...#....#...###.....#####..###..........#......###..#...#..........#............................\n"
+    "..####.##..#...#....#.....#...#........##.....#...#.##.##.........###...........................\n"
+    ".#.#....#......#....####..#..##.........#.........#.#.#.#........#.#.#..........................\n"
+    "..###...#...###.........#.#.#.#.........#......###..#.#.#..........#............................\n"
+    "...#.#..#..#............#.##..#.........#.....#.....#.#.#..........#............................\n"
+    ".####...#..#.....##.#...#.#...#.........#..##.#.....#...#..........#............................\n"
+    "...#...###.#####.##..###...###.........###.##.#####.#...#..........#............................\n"
+    "................................................................................................\n";
+
+static const char* const METER_DOWN_BIG =
+    "......#...#####....#..#####...........#####....#####.#...#.........#............................\n"
+    ".....####.....#...##..#...................#....#.....#..#..........#............................\n"
+    "....#.#......#...#.#..####................#....####..#.#...........#............................\n"
+    ".....###....##..#..#......#..............#.........#.##............#............................\n"
+    "......#.#.....#.#####.....#.............#..........#.#.#.........#.#.#..........................\n"
+    "....####..#...#....#..#...#............#....##.#...#.#..#.........###...........................\n"
+    "......#....###.....#...###............#.....##..###..#...#.........#............................\n"
+    "................................................................................................\n";
+
+static const char* const STATUS_ONLY =
+    ".....###..#...#.#...#..###......................................................................\n"
+    "....#...#.#...#.#...#.#...#.....................................................................\n"
+    "....#......#.#..##..#.#.........................................................................\n"
+    ".....###....#...#.#.#.#.........................................................................\n"
+    "........#...#...#..##.#.........................................................................\n"
+    "....#...#...#...#...#.#...#.....................................................................\n"
+    ".....###....#...#...#..###......................................................................\n"
+    "................................................................................................\n";
+
+static const char* const SPARKLINE =
+    "...#....#...###.....#####..###..........#......###..#...#..........#..........................#.\n"
+    "..####.##..#...#....#.....#...#........##.....#...#.##.##.........###.........................#.\n"
+    ".#.#....#......#....####..#..##.........#.........#.#.#.#........#.#.#........................#.\n"
+    "..###...#...###.........#.#.#.#.........#......###..#.#.#..........#.......................#..##\n"
+    "...#.#..#..#............#.##..#.........#.....#.....#.#.#..........#.......................#####\n"
+    ".####...#..#.....##.#...#.#...#.........#..##.#.....#...#..........#......................######\n"
+    "...#...###.#####.##..###...###.........###.##.#####.#...#..........#.....................#######\n"
+    "........................................................................................########\n";
+
+#elif DISPLAY_NUM_DEVICES == 16
+
+// ---------------------------------------------------------------------------
+// Zoned layout (16 modules: cost 5 | tokens 5 | trend 1 | sparkline 5)
+// ---------------------------------------------------------------------------
+
+static const char* const METER_UP =
+    ".......#....#...###.....#####..###..................#......###..#...#..............#............................................\n"
+    "......####.##..#...#....#.....#...#................##.....#...#.##.##.............###...........................................\n"
+    ".....#.#....#......#....####..#..##.................#.........#.#.#.#............#.#.#..........................................\n"
+    "......###...#...###.........#.#.#.#.................#......###..#.#.#..............#............................................\n"
+    ".......#.#..#..#............#.##..#.................#.....#.....#.#.#..............#............................................\n"
+    ".....####...#..#.....##.#...#.#...#.................#..##.#.....#...#..............#............................................\n"
+    ".......#...###.#####.##..###...###.................###.##.#####.#...#..............#............................................\n"
+    "................................................................................................................................\n";
+
+static const char* const METER_DOWN_BIG =
+    "..........#...#####....#..#####...................#####....#####.#...#.............#............................................\n"
+    ".........####.....#...##..#...........................#....#.....#..#..............#............................................\n"
+    "........#.#......#...#.#..####........................#....####..#.#...............#............................................\n"
+    ".........###....##..#..#......#......................#.........#.##................#............................................\n"
+    "..........#.#.....#.#####.....#.....................#..........#.#.#.............#.#.#..........................................\n"
+    "........####..#...#....#..#...#....................#....##.#...#.#..#.............###...........................................\n"
+    "..........#....###.....#...###....................#.....##..###..#...#.............#............................................\n"
+    "................................................................................................................................\n";
+
+static const char* const STATUS_ONLY =
+    ".........###..#...#.#...#..###..................................................................................................\n"
+    "........#...#.#...#.#...#.#...#.................................................................................................\n"
+    "........#......#.#..##..#.#.....................................................................................................\n"
+    ".........###....#...#.#.#.#.....................................................................................................\n"
+    "............#...#...#..##.#.....................................................................................................\n"
+    "........#...#...#...#...#.#...#.................................................................................................\n"
+    ".........###....#...#...#..###..................................................................................................\n"
+    "................................................................................................................................\n";
+
+static const char* const SPARKLINE =
+    ".......#....#...###.....#####..###..................#......###..#...#..............#..........................................#.\n"
+    "......####.##..#...#....#.....#...#................##.....#...#.##.##.............###.........................................#.\n"
+    ".....#.#....#......#....####..#..##.................#.........#.#.#.#............#.#.#........................................#.\n"
+    "......###...#...###.........#.#.#.#.................#......###..#.#.#..............#.......................................#..##\n"
+    ".......#.#..#..#............#.##..#.................#.....#.....#.#.#..............#.......................................#####\n"
+    ".....####...#..#.....##.#...#.#...#.................#..##.#.....#...#..............#......................................######\n"
+    ".......#...###.#####.##..###...###.................###.##.#####.#...#..............#.....................................#######\n"
+    "........................................................................................................................########\n";
+
+#endif
+
+void test_meter_layout() {
+    TEST_ASSERT_TRUE(display->isMultiZone());
+    display->showMeter(reading(12.5f, 1234567, TREND_UP));
+    ASSERT_FRAME(METER_UP);
+}
+
+void test_meter_updates_changed_zones() {
+    display->showMeter(reading(12.5f, 1234567, TREND_UP));
+    display->showMeter(reading(345.2f, 7500, TREND_DOWN));
+    ASSERT_FRAME(METER_DOWN_BIG);
+}
+
+void test_status_blanks_secondary_zones() {
+    display->showMeter(reading(12.5f, 1234567, TREND_UP));
+    display->showStatic("SYNC");
+    ASSERT_FRAME(STATUS_ONLY);
+}
+
+void test_carousel_defers_to_zones() {
+    display->showCarousel(reading(12.5f, 1234567, TREND_UP), PAGE_TREND);
+    ASSERT_FRAME(METER_UP);
+}
+
+#if DISPLAY_NUM_DEVICES >= 12
+void test_sparkline_zone() {
+    static const float costs[] = { 10.0f, 10.5f, 11.5f, 13.0f, 12.0f, 12.25f, 15.0f, 12.5f };
+    for (float cost : costs) display->addSparklinePoint(cost);
+    display->showMeter(reading(12.5f, 1234567, TREND_UP));
+    ASSERT_FRAME(SPARKLINE);
+}
+#endif
+
+#else
+#error "No golden frames for this DISPLAY_NUM_DEVICES; add them above"
+#endif
+
+int main() {
+    UNITY_BEGIN();
+#if DISPLAY_NUM_DEVICES == 4
+    RUN_TEST(test_cost_is_centered);
+    RUN_TEST(test_cost_over_100_drops_cents);
+    RUN_TEST(test_tokens_compact);
+    RUN_TEST(test_tokens_below_1000_are_exact);
+    RUN_TEST(test_compact_widths_fit_one_zone);
+    RUN_TEST(test_error_blinks);
+    RUN_TEST(test_boot_animation);
+    RUN_TEST(test_scrolling_text_enters_from_the_right);
+    RUN_TEST(test_carousel_pages);
+    RUN_TEST(test_carousel_stops_for_text);
+#else
+    RUN_TEST(test_meter_layout);
+    RUN_TEST(test_meter_updates_changed_zones);
+    RUN_TEST(test_status_blanks_secondary_zones);
+    RUN_TEST(test_carousel_defers_to_zones);
+#if DISPLAY_NUM_DEVICES >= 12
+    RUN_TEST(test_sparkline_zone);
+#endif
+#endif
+    return UNITY_END();
+}
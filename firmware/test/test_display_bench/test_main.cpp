@@ -0,0 +1,151 @@
+// ============================================================================
+// Display Frame Cost vs Chain Length
+// ============================================================================
+//
+// Host CPU time of DisplayManager::update() on the fake chain, for the
+// module count the env builds with. Run it across the chain lengths and
+// compare the per-module figures:
+//
+//   pio test -e native -e native_8 -e native_12 -e native_16
+//            -f test_display_bench -v
+//
+// Three workloads: an idle meter (zones finished, nothing dirty), a new
+// reading every frame (every zone re-rendered) and a status line scrolling
+// across the cost zone. Host microseconds are not ESP32 microseconds; the
+// point is how they grow with the chain. Animation still runs on the
+// simulated clock; only the measurement reads the host clock.
+//
+// The single-zone carousel is measured apart: a page switch against a full
+// re-render of every page. Switching copies a prerendered frame, so it must
+// stay cheaper than rendering even one page, however many pages there are.
+// Rotation needs DISPLAY_PAGE_MS: `pio test -e native_pages`.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "display.h"
+
+static const uint32_t FRAMES = 20000;
+
+static DisplayManager* display;
+
+static MeterData reading(uint32_t n) {
+    uint64_t tokens = 1000000 + n * 1237;
+    MeterData data = {};
+    data.valid = true;
+    data.costUsd = 10.0f + n * 0.37f;
+    data.trend = n % 2 ? TREND_UP : TREND_DOWN;
+    data.tokens.uncachedInputTokens = tokens / 2;
+    data.tokens.outputTokens = tokens / 4;
+    data.tokens.cacheReadTokens = tokens / 4;
+    data.tokens.totalTokens = tokens;
+    data.sourceCount = 1;
+    return data;
+}
+
+static void report(const char* workload, uint64_t us) {
+    char message[120];
+    snprintf(message, sizeof(message),
+             "%2u modules, %-8s %7.3f us/frame, %6.3f us/frame/module",
+             DISPLAY_NUM_DEVICES, workload, (double)us / FRAMES,
+             (double)us / FRAMES / DISPLAY_NUM_DEVICES);
+    TEST_MESSAGE(message);
+}
+
+void setUp() {
+    fake::resetClock();
+    display = new DisplayManager();
+    display->begin();
+    for (uint8_t i = 0; i < 32; i++) display->addSparklinePoint(i * 0.5f);
+}
+
+void tearDown() {
+    delete display;
+}
+
+static uint64_t idleMeter() {
+    display->showMeter(reading(0));
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        fake::advance(SCROLL_SPEED_MS);
+        display->update();
+    }
+    return fake::hostUs() - started;
+}
+
+static uint64_t changingMeter() {
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        display->showMeter(reading(i));
+        fake::advance(SCROLL_SPEED_MS);
+        display->update();
+    }
+    return fake::hostUs() - started;
+}
+
+void test_idle_meter() {
+    report("idle", idleMeter());
+}
+
+void test_new_reading_every_frame() {
+    uint64_t changing = changingMeter();
+    report("changing", changing);
+
+    // Finished zones are not redrawn, so idling is cheaper than redrawing
+    tearDown();
+    setUp();
+    TEST_ASSERT_LESS_THAN(changing, idleMeter());
+}
+
+void test_scrolling_status() {
+    display->showScrolling("CONNECTING TO WIFI");
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        fake::advance(SCROLL_SPEED_MS);
+        display->update();
+    }
+    report("scroll", fake::hostUs() - started);
+}
+
+void test_carousel_switch() {
+#if DISPLAY_PAGE_MS > 0
+    if (display->isMultiZone()) {
+        TEST_IGNORE_MESSAGE("the carousel is single-zone only");
+    }
+
+    // Page switches: update() swaps in the next prerendered frame
+    display->showCarousel(reading(0));
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        fake::advance(DISPLAY_PAGE_MS);
+        display->update();
+    }
+    uint64_t switching = fake::hostUs() - started;
+
+    // Full re-renders: a new reading renders all PAGE_COUNT pages
+    started = fake::hostUs();
+    for (uint32_t i = 0; i < FRAMES; i++) {
+        display->showCarousel(reading(i));
+    }
+    uint64_t rendering = fake::hostUs() - started;
+
+    double switchUs = (double)switching / FRAMES;
+    double renderUs = (double)rendering / FRAMES;
+    char message[120];
+    snprintf(message, sizeof(message),
+             "%u pages, %7.3f us/switch, %7.3f us/re-render (%6.3f us/page)",
+             PAGE_COUNT, switchUs, renderUs, renderUs / PAGE_COUNT);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE_MESSAGE(switchUs < renderUs / PAGE_COUNT, message);
+#else
+    TEST_IGNORE_MESSAGE("needs DISPLAY_PAGE_MS (pio test -e native_pages)");
+#endif
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_idle_meter);
+    RUN_TEST(test_new_reading_every_frame);
+    RUN_TEST(test_scrolling_status);
+    RUN_TEST(test_carousel_switch);
+    return UNITY_END();
+}
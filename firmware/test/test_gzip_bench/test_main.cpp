@@ -0,0 +1,227 @@
+// ============================================================================
+// Compressed Responses: Poll Time and Peak Heap
+// ============================================================================
+//
+// Serves the same usage report (8 and 24 hourly buckets; a day still fits
+// HTTP_PAYLOAD_MAX uncompressed) plain, gzip and deflate from the
+// mock webhook over a weak link: 40 ms to first byte, then 1 Mbit/s. Each
+// case runs one poll end to end, Source::fetchGroup then Parser::parse,
+// and reports
+//   - bytes on the wire,
+//   - fetch time on the simulated clock,
+//   - host decode time per parse (inflate included),
+//   - peak heap above the starting point while decoding.
+// Checks that every encoding decodes to the same reading, that compressed
+// bodies arrive sooner, and that inflating never touches the heap
+// (the decoder state and window are static). The fetch side's buffers are
+// static too; the in-memory network's own allocations would swamp the
+// figure, so heap is measured over the decode.
+//
+// Needs HTTP_ACCEPT_GZIP: `pio test -e native_gzip`. Peak heap interposes
+// the C allocator, which the linker allows on glibc.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <fake_webhook.h>
+#include <zlib.h>
+#include "parser.h"
+#include "source.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define COUNTS_HEAP 1
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+static void grew(void* block) {
+    if (block == nullptr) return;
+    liveBytes += malloc_usable_size(block);
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+}
+
+// operator new ends up here too
+extern "C" void* malloc(size_t size) {
+    void* block = __libc_malloc(size);
+    grew(block);
+    return block;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    void* block = __libc_calloc(count, size);
+    grew(block);
+    return block;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (ptr != nullptr) liveBytes -= malloc_usable_size(ptr);
+    void* block = __libc_realloc(ptr, size);
+    grew(block);
+    return block;
+}
+
+extern "C" void free(void* ptr) {
+    if (ptr != nullptr) liveBytes -= malloc_usable_size(ptr);
+    __libc_free(ptr);
+}
+#else
+#define COUNTS_HEAP 0
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+#endif
+
+static const uint32_t ROUNDS = 500;
+static const uint32_t LINK_US_PER_BYTE = 8;     // 1 Mbit/s
+static const uint32_t LINK_LATENCY_MS = 40;
+
+static const IPAddress SERVER_IP(10, 0, 0, 2);
+static const char* const URL = "http://meter.local:5678/webhook/usage-report";
+
+struct Poll {
+    size_t wireBytes;
+    unsigned long fetchMs;
+    double decodeUs;
+    size_t peakHeap;
+    MeterData data;
+};
+
+// --- Payloads ---
+
+static std::string usageReport(uint32_t hours) {
+    std::string json = "{\"data\":[";
+    for (uint32_t h = 0; h < hours; h++) {
+        char entry[320];
+        snprintf(entry, sizeof(entry),
+                 "%s{\"starting_at\":\"2025-06-01T%02u:00:00Z\","
+                 "\"ending_at\":\"2025-06-0%uT%02u:00:00Z\",\"results\":"
+                 "{\"uncached_input_tokens\":%u,\"output_tokens\":%u,"
+                 "\"cache_creation_input_tokens\":%u,\"cache_read_input_tokens\":%u,"
+                 "\"server_tool_use\":{\"web_search_requests\":0}}}",
+                 h > 0 ? "," : "", h, h + 1 < 24 ? 1 : 2, (h + 1) % 24,
+                 1000 + h * 137, 200 + h * 29, h * 11, 50000 + h * 1009);
+        json += entry;
+    }
+    json += "],\"has_more\":false,\"next_page\":null}";
+    return json;
+}
+
+// windowBits 15 + 16 frames as gzip, 15 as zlib ("deflate" in HTTP)
+static std::string compress(const std::string& text, int windowBits) {
+    z_stream s = {};
+    deflateInit2(&s, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&s, text.size()) + 32, '\0');
+    s.next_in = (Bytef*)text.data();
+    s.avail_in = text.size();
+    s.next_out = (Bytef*)&out[0];
+    s.avail_out = out.size();
+    deflate(&s, Z_FINISH);
+    out.resize(s.total_out);
+    deflateEnd(&s);
+    return out;
+}
+
+// --- Measurement ---
+
+static Poll poll(const std::string& body, const char* contentEncoding) {
+    fake::resetClock();
+    fake::resetNetwork();
+    fake::dns()["meter.local"] = SERVER_IP;
+    fake::Webhook server;
+    server.latencyMs = LINK_LATENCY_MS;
+    server.usPerByte = LINK_US_PER_BYTE;
+    server.contentEncoding = contentEncoding;
+    server.setBody(body);
+    fake::listen(SERVER_IP, 5678, &server);
+
+    Source source;
+    source.configure(URL, nullptr);
+    Source* group[] = { &source };
+    unsigned long now = millis();
+    Source::fetchGroup(group, 1, now, now + HTTP_TIMEOUT_MS);
+
+    const FetchResult& r = source.result();
+    TEST_ASSERT_TRUE_MESSAGE(r.success, r.errorMsg);
+    TEST_ASSERT_EQUAL_UINT32(body.size(), r.payloadLength);
+
+    Poll p;
+    p.wireBytes = r.payloadLength;
+    p.fetchMs = r.elapsedMs;
+
+    // Warm up: first-use setup in the C library
+    Parser::parse(r.payload, r.payloadLength, r.format, r.encoding);
+
+    size_t baseline = liveBytes;
+    peakBytes = liveBytes;
+    p.data = Parser::parse(r.payload, r.payloadLength, r.format, r.encoding);
+    p.peakHeap = peakBytes - baseline;
+
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        Parser::parse(r.payload, r.payloadLength, r.format, r.encoding);
+    }
+    p.decodeUs = (double)(fake::hostUs() - started) / ROUNDS;
+    return p;
+}
+
+static void report(const char* shape, const char* encoding, const Poll& p, const Poll& plain) {
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%-9s %-8s %5u B (%3.0f%%)  fetch %4lu ms  decode %7.2f us  peak heap %u B",
+             shape, encoding, (unsigned)p.wireBytes, 100.0 * p.wireBytes / plain.wireBytes,
+             p.fetchMs, p.decodeUs, (unsigned)p.peakHeap);
+    TEST_MESSAGE(message);
+}
+
+static void compare(const char* shape, uint32_t hours) {
+#if !HTTP_ACCEPT_GZIP
+    TEST_IGNORE_MESSAGE("needs HTTP_ACCEPT_GZIP (pio test -e native_gzip)");
+#else
+    std::string json = usageReport(hours);
+    Poll plain = poll(json, nullptr);
+    Poll gzip = poll(compress(json, 15 + 16), "gzip");
+    Poll deflate = poll(compress(json, 15), "deflate");
+
+    report(shape, "identity", plain, plain);
+    report(shape, "gzip", gzip, plain);
+    report(shape, "deflate", deflate, plain);
+
+    TEST_ASSERT_TRUE(plain.data.valid);
+    const Poll* compressed[] = { &gzip, &deflate };
+    for (const Poll* p : compressed) {
+        TEST_ASSERT_TRUE(p->data.valid);
+        TEST_ASSERT_EQUAL_FLOAT(plain.data.costUsd, p->data.costUsd);
+        TEST_ASSERT_EQUAL_UINT64(plain.data.tokens.totalTokens, p->data.tokens.totalTokens);
+        TEST_ASSERT_LESS_THAN(plain.wireBytes, p->wireBytes);
+        TEST_ASSERT_LESS_THAN(plain.fetchMs, p->fetchMs);
+#if COUNTS_HEAP
+        TEST_ASSERT_EQUAL_UINT32(0, p->peakHeap);
+#endif
+    }
+#endif
+}
+
+void setUp() {
+    fake::logLevel = fake::LOG_WARN;
+}
+
+void tearDown() {}
+
+void test_usage_report_8h() {
+    compare("usage 8h", 8);
+}
+
+void test_usage_report_24h() {
+    compare("usage 24h", 24);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_usage_report_8h);
+    RUN_TEST(test_usage_report_24h);
+    return UNITY_END();
+}
@@ -0,0 +1,180 @@
+// ============================================================================
+// MessagePack vs JSON: Wire Size and Decode Time
+// ============================================================================
+//
+// Encodes the same readings both ways, a webhook reply and a usage report
+// of 24 hourly buckets, and runs each through Parser::parse many times.
+// Reports bytes on the wire and host decode time per parse; checks that
+// both encodings decode to the same reading and that MessagePack is the
+// smaller one. Host microseconds only compare the two encodings with each
+// other, not with the ESP32.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "parser.h"
+
+static const uint32_t ROUNDS = 2000;
+static const uint32_t HOURS = 24;
+
+// --- Minimal MessagePack writer ---
+
+struct Packer {
+    std::string out;
+
+    void map(uint8_t n) { out += (char)(0x80 | n); }
+    void array(uint16_t n) {
+        if (n < 16) {
+            out += (char)(0x90 | n);
+        } else {
+            out += (char)0xDC;
+            out += (char)(n >> 8);
+            out += (char)n;
+        }
+    }
+    void str(const char* s) {
+        size_t len = strlen(s);
+        if (len < 32) {
+            out += (char)(0xA0 | len);
+        } else {
+            out += (char)0xD9;
+            out += (char)len;
+        }
+        out.append(s, len);
+    }
+    void f64(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, 8);
+        out += (char)0xCB;
+        for (int shift = 56; shift >= 0; shift -= 8) out += (char)(bits >> shift);
+    }
+    void uint(uint64_t value) {
+        if (value < 128) {
+            out += (char)value;
+        } else if (value <= 0xFFFF) {
+            out += (char)0xCD;
+            out += (char)(value >> 8);
+            out += (char)value;
+        } else if (value <= 0xFFFFFFFFULL) {
+            out += (char)0xCE;
+            for (int shift = 24; shift >= 0; shift -= 8) out += (char)(value >> shift);
+        } else {
+            out += (char)0xCF;
+            for (int shift = 56; shift >= 0; shift -= 8) out += (char)(value >> shift);
+        }
+    }
+};
+
+// --- Payloads ---
+
+static void webhook(std::string& json, std::string& msgpack) {
+    json = "{\"cost_usd\":12.5,\"trend\":\"up\",\"tokens_total\":1234567}";
+
+    Packer p;
+    p.map(3);
+    p.str("cost_usd"); p.f64(12.5);
+    p.str("trend"); p.str("up");
+    p.str("tokens_total"); p.uint(1234567);
+    msgpack = p.out;
+}
+
+static void usageReport(std::string& json, std::string& msgpack) {
+    Packer p;
+    p.map(3);
+    p.str("data");
+    p.array(HOURS);
+
+    json = "{\"data\":[";
+    for (uint32_t h = 0; h < HOURS; h++) {
+        char from[24];
+        char to[24];
+        snprintf(from, sizeof(from), "2025-06-01T%02u:00:00Z", h);
+        snprintf(to, sizeof(to), h + 1 < 24 ? "2025-06-01T%02u:00:00Z" : "2025-06-02T00:00:00Z",
+                 h + 1);
+        uint64_t input = 1000 + h * 137;
+        uint64_t output = 200 + h * 29;
+        uint64_t write = h * 11;
+        uint64_t read = 50000 + h * 1009;
+
+        char entry[320];
+        snprintf(entry, sizeof(entry),
+                 "%s{\"starting_at\":\"%s\",\"ending_at\":\"%s\",\"results\":"
+                 "{\"uncached_input_tokens\":%llu,\"output_tokens\":%llu,"
+                 "\"cache_creation_input_tokens\":%llu,\"cache_read_input_tokens\":%llu,"
+                 "\"server_tool_use\":{\"web_search_requests\":0}}}",
+                 h > 0 ? "," : "", from, to, (unsigned long long)input,
+                 (unsigned long long)output, (unsigned long long)write,
+                 (unsigned long long)read);
+        json += entry;
+
+        p.map(3);
+        p.str("starting_at"); p.str(from);
+        p.str("ending_at"); p.str(to);
+        p.str("results");
+        p.map(5);
+        p.str("uncached_input_tokens"); p.uint(input);
+        p.str("output_tokens"); p.uint(output);
+        p.str("cache_creation_input_tokens"); p.uint(write);
+        p.str("cache_read_input_tokens"); p.uint(read);
+        p.str("server_tool_use"); p.map(1); p.str("web_search_requests"); p.uint(0);
+    }
+    json += "],\"has_more\":false,\"next_page\":null}";
+
+    p.str("has_more"); p.out += (char)0xC2;
+    p.str("next_page"); p.out += (char)0xC0;
+    msgpack = p.out;
+}
+
+// --- Measurement ---
+
+static double decodeUs(const std::string& payload, PayloadFormat format, MeterData& data) {
+    uint64_t started = fake::hostUs();
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        data = Parser::parse(payload.data(), payload.size(), format);
+    }
+    return (double)(fake::hostUs() - started) / ROUNDS;
+}
+
+static void compare(const char* shape, const std::string& json, const std::string& msgpack) {
+    MeterData fromJson;
+    MeterData fromMsgpack;
+    double jsonUs = decodeUs(json, FORMAT_JSON, fromJson);
+    double msgpackUs = decodeUs(msgpack, FORMAT_MSGPACK, fromMsgpack);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%-12s JSON %5u B %7.2f us | MessagePack %5u B (%3.0f%%) %7.2f us (%3.0f%%)",
+             shape, (unsigned)json.size(), jsonUs, (unsigned)msgpack.size(),
+             100.0 * msgpack.size() / json.size(), msgpackUs, 100.0 * msgpackUs / jsonUs);
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_TRUE(fromJson.valid);
+    TEST_ASSERT_TRUE(fromMsgpack.valid);
+    TEST_ASSERT_EQUAL_FLOAT(fromJson.costUsd, fromMsgpack.costUsd);
+    TEST_ASSERT_EQUAL_UINT64(fromJson.tokens.totalTokens, fromMsgpack.tokens.totalTokens);
+    TEST_ASSERT_LESS_THAN(json.size(), msgpack.size());
+}
+
+void setUp() {
+    fake::logLevel = fake::LOG_WARN;
+}
+
+void tearDown() {}
+
+void test_webhook() {
+    std::string json, msgpack;
+    webhook(json, msgpack);
+    compare("webhook", json, msgpack);
+}
+
+void test_usage_report() {
+    std::string json, msgpack;
+    usageReport(json, msgpack);
+    compare("usage 24h", json, msgpack);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_webhook);
+    RUN_TEST(test_usage_report);
+    return UNITY_END();
+}
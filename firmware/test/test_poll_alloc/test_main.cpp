@@ -0,0 +1,254 @@
+// ============================================================================
+// Poll Path Heap Allocations
+// ============================================================================
+//
+// Runs 10,000 simulated polls through the whole poll path: Source::fetchGroup
+// against mock webhooks (webhook JSON and a usage report with hourly
+// buckets pipelined on one connection, webhook MessagePack on another),
+// parse, combine, the rollup windows and the display, and counts every
+// malloc/calloc/realloc on the way. Bodies change on different schedules,
+// so polls mix 200s with 304s that reuse the previous reading. The steady
+// state must not touch the heap at all.
+//
+// The in-memory network allocates on its own account; those allocations
+// (inside fake::InNetwork, see WiFiClient.h) are not counted, and neither
+// is the mock servers' body update. TLS is not simulated, so the sources
+// are plain http.
+//
+// Counting interposes the C allocator, which the linker allows on glibc;
+// elsewhere the test is skipped.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <fake_webhook.h>
+#include "display.h"
+#include "parser.h"
+#include "rollup.h"
+#include "source.h"
+
+#if defined(__GLIBC__)
+#define COUNTS_ALLOCATIONS 1
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool counting = false;
+static uint32_t allocations = 0;
+
+// operator new ends up here too
+extern "C" void* malloc(size_t size) {
+    if (counting && fake::inNetwork() == 0) allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (counting && fake::inNetwork() == 0) allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (counting && fake::inNetwork() == 0) allocations++;
+    return __libc_realloc(ptr, size);
+}
+#else
+#define COUNTS_ALLOCATIONS 0
+#endif
+
+static const uint32_t POLLS = 10000;
+static const uint32_t POLL_INTERVAL_S = 60;
+static const uint32_t START_TIME = 1748736000;   // 2025-06-01T00:00:00Z
+
+static const IPAddress JSON_IP(10, 0, 0, 2);
+static const IPAddress MSGPACK_IP(10, 0, 0, 3);
+
+static DisplayManager display;
+static Rollup rollup;
+static fake::Webhook jsonServer;
+static fake::Webhook msgpackServer;
+static Source sources[3];
+static Source* jsonGroup[2] = { &sources[0], &sources[1] };
+static Source* msgpackGroup[1] = { &sources[2] };
+static MeterData sourceData[3];
+
+static char webhookJson[128];
+static char usageJson[1024];
+static uint8_t webhookMsgpack[64];
+static size_t webhookMsgpackLength;
+
+static void isoHour(uint32_t unixTime, char* out, size_t size) {
+    time_t t = (time_t)(unixTime - unixTime % 3600);
+    struct tm parts;
+    gmtime_r(&t, &parts);
+    strftime(out, size, "%Y-%m-%dT%H:00:00Z", &parts);
+}
+
+// Three hourly buckets ending with the current hour
+static size_t buildUsageReport(uint32_t now, uint32_t poll) {
+    size_t len = snprintf(usageJson, sizeof(usageJson), "{\"data\":[");
+    for (uint32_t i = 0; i < 3; i++) {
+        uint32_t start = now - (2 - i) * 3600;
+        char from[24];
+        char to[24];
+        isoHour(start, from, sizeof(from));
+        isoHour(start + 3600, to, sizeof(to));
+        len += snprintf(usageJson + len, sizeof(usageJson) - len,
+                        "%s{\"starting_at\":\"%s\",\"ending_at\":\"%s\",\"results\":"
+                        "{\"uncached_input_tokens\":%u,\"output_tokens\":%u,"
+                        "\"cache_creation_input_tokens\":%u,\"cache_read_input_tokens\":%u,"
+                        "\"server_tool_use\":{\"web_search_requests\":0}}}",
+                        i > 0 ? "," : "", from, to, 1000 + poll, 200 + poll % 50,
+                        poll % 7, 5000 + poll * 3);
+    }
+    len += snprintf(usageJson + len, sizeof(usageJson) - len,
+                    "],\"has_more\":false,\"next_page\":null}");
+    return len;
+}
+
+static size_t buildWebhookJson(uint32_t poll) {
+    return snprintf(webhookJson, sizeof(webhookJson),
+                    "{\"cost_usd\":%.2f,\"trend\":\"%s\",\"tokens_total\":%u}",
+                    12.5 + poll * 0.01, poll % 3 == 0 ? "up" : "flat", 1234567 + poll);
+}
+
+// {"cost_usd": <float64>, "trend": "down", "tokens_total": <uint32>}
+static void buildWebhookMsgpack(uint32_t poll) {
+    uint8_t* p = webhookMsgpack;
+    *p++ = 0x83;
+    *p++ = 0xA8; memcpy(p, "cost_usd", 8); p += 8;
+    double cost = 3.25 + poll * 0.001;
+    uint64_t bits;
+    memcpy(&bits, &cost, 8);
+    *p++ = 0xCB;
+    for (int shift = 56; shift >= 0; shift -= 8) *p++ = (uint8_t)(bits >> shift);
+    *p++ = 0xA5; memcpy(p, "trend", 5); p += 5;
+    *p++ = 0xA4; memcpy(p, "down", 4); p += 4;
+    *p++ = 0xAC; memcpy(p, "tokens_total", 12); p += 12;
+    uint32_t tokens = 40000 + poll;
+    *p++ = 0xCE;
+    for (int shift = 24; shift >= 0; shift -= 8) *p++ = (uint8_t)(tokens >> shift);
+    webhookMsgpackLength = p - webhookMsgpack;
+}
+
+// Put the bodies for poll n on the servers. The webhook changes every other
+// poll, the usage report every third and the MessagePack webhook every
+// fifth; the rest are answered 304.
+static void serve(uint32_t n) {
+    fake::InNetwork scope;
+    uint32_t now = START_TIME + n * POLL_INTERVAL_S;
+    uint32_t webhookN = n / 2;
+    uint32_t usageN = n / 3;
+    uint32_t msgpackN = n / 5;
+
+    size_t length = buildWebhookJson(webhookN);
+    jsonServer.setBody("/webhook/claude-usage", std::string(webhookJson, length));
+    length = buildUsageReport(now, usageN);
+    jsonServer.setBody("/usage", std::string(usageJson, length));
+    buildWebhookMsgpack(msgpackN);
+    msgpackServer.setBody(std::string((const char*)webhookMsgpack, webhookMsgpackLength));
+}
+
+// One poll cycle as loop() runs it: fetch, then parse what changed
+static MeterData poll(uint32_t n) {
+    uint32_t now = START_TIME + n * POLL_INTERVAL_S;
+    serve(n);
+
+    unsigned long started = millis();
+    Source::fetchGroup(jsonGroup, 2, started, started + HTTP_TIMEOUT_MS);
+    Source::fetchGroup(msgpackGroup, 1, millis(), millis() + HTTP_TIMEOUT_MS);
+
+    rollup.advance(now);
+    rollup.beginCycle();
+
+    for (int i = 0; i < 3; i++) {
+        const FetchResult& fetched = sources[i].result();
+        if (!fetched.success) {
+            return MeterData{};
+        }
+        if (!fetched.notModified) {
+            sourceData[i] = Parser::parse(fetched.payload, fetched.payloadLength,
+                                          fetched.format, fetched.encoding, &rollup);
+        }
+    }
+
+    MeterData data = Parser::combine(sourceData, 3);
+    display.addSparklinePoint(data.costUsd);
+    if (display.isMultiZone()) {
+        display.showMeter(data);
+    } else if (n % 2 == 0) {
+        display.showCost(data.costUsd);
+    } else {
+        display.showTokens(data.tokens.totalTokens);
+    }
+
+    // Animation ticks until the next poll (a few are enough: nothing scrolls)
+    for (int i = 0; i < 10; i++) {
+        fake::advance(SCROLL_SPEED_MS);
+        display.update();
+    }
+    return data;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_polls_parse() {
+    MeterData data = poll(0);
+    TEST_ASSERT_TRUE(data.valid);
+    TEST_ASSERT_EQUAL(3, data.sourceCount);
+    TEST_ASSERT_EQUAL(1234567 + 40000 + 3 * (1000 + 200 + 5000), data.tokens.totalTokens);
+    TEST_ASSERT_TRUE(rollup.hasData());
+    TEST_ASSERT_EQUAL(FORMAT_MSGPACK, sources[2].result().format);
+
+    // Poll 1 serves the same bodies as poll 0: every source comes back 304
+    MeterData again = poll(1);
+    TEST_ASSERT_TRUE(sources[0].result().notModified);
+    TEST_ASSERT_TRUE(sources[1].result().notModified);
+    TEST_ASSERT_TRUE(sources[2].result().notModified);
+    TEST_ASSERT_EQUAL(data.tokens.totalTokens, again.tokens.totalTokens);
+}
+
+void test_steady_state_polls_do_not_allocate() {
+#if COUNTS_ALLOCATIONS
+    // Warm up: first-use setup in the C library and the display
+    for (uint32_t n = 1; n <= 10; n++) poll(n);
+
+    uint32_t valid = 0;
+    uint32_t notModified = jsonServer.notModified + msgpackServer.notModified;
+    allocations = 0;
+    counting = true;
+    for (uint32_t n = 11; n < 11 + POLLS; n++) {
+        if (poll(n).valid) valid++;
+    }
+    counting = false;
+    notModified = jsonServer.notModified + msgpackServer.notModified - notModified;
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u allocations in %u polls (%u responses 304)",
+             allocations, POLLS, notModified);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(POLLS, valid);
+    TEST_ASSERT_GREATER_THAN_UINT32(POLLS, notModified);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, allocations, message);
+#else
+    TEST_IGNORE_MESSAGE("needs glibc to interpose malloc");
+#endif
+}
+
+int main() {
+    fake::resetNetwork();
+    fake::dns()["meter.local"] = JSON_IP;
+    fake::dns()["msgpack.local"] = MSGPACK_IP;
+    fake::listen(JSON_IP, 5678, &jsonServer);
+    fake::listen(MSGPACK_IP, 5678, &msgpackServer);
+    msgpackServer.contentType = "application/msgpack";
+    sources[0].configure("http://meter.local:5678/webhook/claude-usage", nullptr);
+    sources[1].configure("http://meter.local:5678/usage", nullptr);
+    sources[2].configure("http://msgpack.local:5678/webhook/claude-usage", nullptr);
+
+    display.begin();
+    UNITY_BEGIN();
+    RUN_TEST(test_polls_parse);
+    RUN_TEST(test_steady_state_polls_do_not_allocate);
+    return UNITY_END();
+}
@@ -0,0 +1,317 @@
+// ============================================================================
+// Relay: Several Meters on One Multicast Bus
+// ============================================================================
+//
+// Five simulated meters, each a Relay with its own node ID and address,
+// share the in-memory multicast bus of test/shim/WiFiUdp.h. Each runs the
+// relay part of loop(): update(), and while leading, one upstream poll per
+// POLL_INTERVAL_MS that publishes what it got. Upstream is a counter with
+// a configurable response time. Checks that
+//   - the group settles on one leader, the lowest node ID, and upstream
+//     sees one poll per interval for the whole floor,
+//   - losing the leader promotes exactly one follower,
+//   - a promoted leader whose first poll is slow holds the group with its
+//     no-reading heartbeats instead of every follower taking over,
+//   - a meter joining a running group follows its leader, and after a
+//     partition heals the higher-ID leaders step down,
+//   - tampered, replayed and other-group datagrams are not accepted.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <WiFiUdp.h>
+#include <memory>
+#include "relay.h"
+
+static const uint8_t METERS = 5;
+static const unsigned long TICK_MS = 50;
+static const size_t COST_OFFSET = 32;    // Packet::costUsd
+
+static const char* const URLS[] = {
+    "https://n8n.example.com/webhook/claude-usage",
+    "https://n8n.example.com/webhook/team-usage",
+};
+
+struct Meter {
+    Relay relay;
+    IPAddress ip;
+    bool polling = false;
+    unsigned long pollDoneAt = 0;
+    unsigned long nextPoll = 0;
+    uint32_t promotions = 0;
+    uint32_t readings = 0;
+    MeterData last = {};
+};
+
+static std::unique_ptr<Meter> meters[METERS];
+static unsigned long upstreamMs;
+static uint32_t upstreamPolls;
+static uint32_t published;
+
+// Node IDs ascend with the index, and so do their takeover staggers
+static void powerOn(uint8_t i, const char* const urls[] = URLS) {
+    meters[i].reset(new Meter());
+    meters[i]->ip = IPAddress(192, 168, 1, 60 + i);
+    fake::efuseMac = 0x0000A1B2C3D40000ULL + 0x100 * (i + 1);
+    meters[i]->relay.configure(urls, 2);
+}
+
+static void powerOff(uint8_t i) {
+    meters[i].reset();
+}
+
+static MeterData upstreamReading() {
+    MeterData data = {};
+    data.valid = true;
+    data.costUsd = 10.0f + upstreamPolls * 0.25f;
+    data.trend = TREND_UP;
+    data.tokens.totalTokens = 1000000 + upstreamPolls;
+    data.sourceCount = 2;
+    return data;
+}
+
+static void step(Meter& m) {
+    fake::localIp = m.ip;
+    MeterData reading;
+    switch (m.relay.update(reading)) {
+        case RELAY_READING:
+            m.readings++;
+            m.last = reading;
+            break;
+        case RELAY_PROMOTED:
+            m.promotions++;
+            m.nextPoll = millis();
+            break;
+        default:
+            break;
+    }
+
+    if (!m.relay.isLeader()) {
+        m.polling = false;
+        return;
+    }
+    if (m.polling && millis() >= m.pollDoneAt) {
+        m.polling = false;
+        m.last = upstreamReading();
+        m.relay.publish(m.last);
+        published++;
+    }
+    if (!m.polling && millis() >= m.nextPoll) {
+        upstreamPolls++;
+        m.polling = true;
+        m.pollDoneAt = millis() + upstreamMs;
+        m.nextPoll += POLL_INTERVAL_MS;
+    }
+}
+
+static void run(unsigned long ms) {
+    for (unsigned long t = 0; t < ms; t += TICK_MS) {
+        for (auto& m : meters) {
+            if (m) step(*m);
+        }
+        fake::advance(TICK_MS);
+    }
+}
+
+static uint8_t leaders() {
+    uint8_t n = 0;
+    for (auto& m : meters) {
+        if (m && m->relay.isLeader()) n++;
+    }
+    return n;
+}
+
+static uint32_t promotions() {
+    uint32_t n = 0;
+    for (auto& m : meters) {
+        if (m) n += m->promotions;
+    }
+    return n;
+}
+
+// Start all meters and let them settle on meter 0
+static void settle() {
+    for (uint8_t i = 0; i < METERS; i++) powerOn(i);
+    run(RELAY_LEADER_TIMEOUT_MS + 5000);
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_TRUE(meters[0]->relay.isLeader());
+}
+
+void setUp() {
+    fake::resetClock();
+    fake::resetNetwork();
+    fake::resetMulticast();
+    fake::logLevel = fake::LOG_ERROR;
+    upstreamMs = 300;
+    upstreamPolls = 0;
+    published = 0;
+}
+
+void tearDown() {
+    for (auto& m : meters) m.reset();
+}
+
+void test_one_leader_polls_for_the_floor() {
+    settle();
+    TEST_ASSERT_EQUAL_UINT32(1, promotions());
+
+    uint32_t pollsBefore = upstreamPolls;
+    uint32_t publishedBefore = published;
+    uint32_t readingsBefore = meters[1]->readings;
+    const unsigned long minutes = 10;
+    run(minutes * 60000UL);
+
+    char message[128];
+    snprintf(message, sizeof(message),
+             "%u meters, %lu min: %u upstream polls, %u datagrams",
+             METERS, minutes, upstreamPolls - pollsBefore, fake::multicastSent());
+    TEST_MESSAGE(message);
+
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_EQUAL_UINT32(minutes, upstreamPolls - pollsBefore);
+    for (uint8_t i = 1; i < METERS; i++) {
+        TEST_ASSERT_EQUAL_UINT32(published - publishedBefore,
+                                 meters[i]->readings - readingsBefore);
+        TEST_ASSERT_EQUAL_FLOAT(meters[0]->last.costUsd, meters[i]->last.costUsd);
+        TEST_ASSERT_EQUAL_UINT64(meters[0]->last.tokens.totalTokens,
+                                 meters[i]->last.tokens.totalTokens);
+    }
+}
+
+void test_leader_loss_promotes_one_follower() {
+    settle();
+    run(60000);
+    powerOff(0);
+    uint32_t before = promotions();
+    run(RELAY_LEADER_TIMEOUT_MS + 10000);
+
+    TEST_ASSERT_EQUAL_UINT32(before + 1, promotions());
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_TRUE(meters[1]->relay.isLeader());
+
+    // The floor is served again
+    uint32_t readings = meters[2]->readings;
+    run(POLL_INTERVAL_MS);
+    TEST_ASSERT_GREATER_THAN(readings, meters[2]->readings);
+}
+
+void test_slow_first_poll_holds_the_group() {
+    settle();
+    run(60000);
+
+    // The new leader's first poll takes longer than the takeover timeout
+    upstreamMs = 2 * RELAY_LEADER_TIMEOUT_MS;
+    powerOff(0);
+    uint32_t before = promotions();
+    uint32_t pollsBefore = upstreamPolls;
+    run(3 * RELAY_LEADER_TIMEOUT_MS);
+
+    TEST_ASSERT_EQUAL_UINT32(before + 1, promotions());
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_LESS_OR_EQUAL(2, upstreamPolls - pollsBefore);
+}
+
+void test_joining_meter_follows_the_running_leader() {
+    for (uint8_t i = 1; i < METERS; i++) powerOn(i);
+    run(RELAY_LEADER_TIMEOUT_MS + 5000);
+    TEST_ASSERT_TRUE(meters[1]->relay.isLeader());
+
+    // A lower node ID joining does not churn the lead
+    powerOn(0);
+    run(RELAY_LEADER_TIMEOUT_MS + POLL_INTERVAL_MS);
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_TRUE(meters[1]->relay.isLeader());
+    TEST_ASSERT_EQUAL_UINT32(0, meters[0]->promotions);
+    TEST_ASSERT_GREATER_THAN(0, meters[0]->readings);
+}
+
+void test_partition_heals_to_one_leader() {
+    bool partitioned = true;
+    fake::onMulticast([&partitioned](fake::Datagram&) { return !partitioned; });
+
+    // Nobody hears anybody: every meter leads on its own
+    for (uint8_t i = 0; i < METERS; i++) powerOn(i);
+    run(RELAY_LEADER_TIMEOUT_MS + 5000);
+    TEST_ASSERT_EQUAL_UINT8(METERS, leaders());
+
+    // One heartbeat later the lowest node ID is left
+    partitioned = false;
+    run(RELAY_HEARTBEAT_MS + TICK_MS);
+    TEST_ASSERT_EQUAL_UINT8(1, leaders());
+    TEST_ASSERT_TRUE(meters[0]->relay.isLeader());
+    fake::onMulticast(nullptr);
+}
+
+void test_tampered_datagrams_are_rejected() {
+    // Everything meter 0 sends arrives with a forged cost
+    const IPAddress victim(192, 168, 1, 60);
+    fake::onMulticast([victim](fake::Datagram& d) {
+        if (d.from == victim && d.data.size() > COST_OFFSET + 4) {
+            float forged = 999.0f;
+            memcpy(&d.data[COST_OFFSET], &forged, sizeof(forged));
+        }
+        return true;
+    });
+
+    for (uint8_t i = 0; i < METERS; i++) powerOn(i);
+    run(RELAY_LEADER_TIMEOUT_MS + 5 * 60000UL);
+
+    // The others never heard meter 0 and elected meter 1 among themselves
+    TEST_ASSERT_TRUE(meters[1]->relay.isLeader());
+    for (uint8_t i = 2; i < METERS; i++) {
+        TEST_ASSERT_FALSE(meters[i]->relay.isLeader());
+        TEST_ASSERT_GREATER_THAN(0, meters[i]->readings);
+        TEST_ASSERT_TRUE(meters[i]->last.costUsd < 999.0f);
+    }
+}
+
+void test_replayed_datagrams_are_ignored() {
+    std::vector<fake::Datagram> captured;
+    fake::onMulticast([&captured](fake::Datagram& d) {
+        captured.push_back(d);
+        return true;
+    });
+    settle();
+    run(3 * POLL_INTERVAL_MS);
+
+    // Replay everything the leader has sent so far, from another address
+    uint32_t readings = meters[1]->readings;
+    float cost = meters[1]->last.costUsd;
+    std::vector<fake::Datagram> replay = captured;
+    for (const fake::Datagram& d : replay) {
+        fake::inject(RELAY_GROUP, RELAY_PORT, IPAddress(192, 168, 1, 99), d.data);
+    }
+    run(TICK_MS);
+
+    TEST_ASSERT_EQUAL_UINT32(readings, meters[1]->readings);
+    TEST_ASSERT_EQUAL_FLOAT(cost, meters[1]->last.costUsd);
+}
+
+void test_other_groups_are_ignored() {
+    // A meter of another team, with the lowest node ID of all
+    static const char* const otherUrls[] = {
+        "https://n8n.example.com/webhook/other-team",
+        "https://n8n.example.com/webhook/other-team-2",
+    };
+    powerOn(0, otherUrls);
+    for (uint8_t i = 1; i < METERS; i++) powerOn(i);
+    run(RELAY_LEADER_TIMEOUT_MS + 5 * 60000UL);
+
+    // Two groups, one leader each
+    TEST_ASSERT_TRUE(meters[0]->relay.isLeader());
+    TEST_ASSERT_TRUE(meters[1]->relay.isLeader());
+    TEST_ASSERT_EQUAL_UINT8(2, leaders());
+    TEST_ASSERT_EQUAL_UINT32(0, meters[0]->readings);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_leader_polls_for_the_floor);
+    RUN_TEST(test_leader_loss_promotes_one_follower);
+    RUN_TEST(test_slow_first_poll_holds_the_group);
+    RUN_TEST(test_joining_meter_follows_the_running_leader);
+    RUN_TEST(test_partition_heals_to_one_leader);
+    RUN_TEST(test_tampered_datagrams_are_rejected);
+    RUN_TEST(test_replayed_datagrams_are_ignored);
+    RUN_TEST(test_other_groups_are_ignored);
+    return UNITY_END();
+}
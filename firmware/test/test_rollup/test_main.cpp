@@ -0,0 +1,299 @@
+// ============================================================================
+// Rollup Window Totals
+// ============================================================================
+//
+// Drives Rollup through hand-picked clock moves (the hour leaving 1H and
+// 7D, midnight for DAY, month ends for MTD), checks that a bucket reported
+// twice in one poll cycle adds while a later cycle replaces it, and then
+// runs a long random sequence of records, cycles and clock jumps against a
+// brute-force re-sum of every hour recorded, window by window.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <map>
+#include "rollup.h"
+
+static const uint32_t RANDOM_STEPS = 20000;
+
+static Rollup* rollup;
+
+// Unix seconds of an ISO 8601 UTC time
+static uint32_t at(const char* text) {
+    uint32_t unixTime = 0;
+    TEST_ASSERT_TRUE_MESSAGE(Rollup::parseTime(text, unixTime), text);
+    return unixTime;
+}
+
+static TokenUsage usage(uint32_t uncached, uint32_t output = 0, uint32_t cacheCreation = 0,
+                        uint32_t cacheRead = 0) {
+    TokenUsage u = {};
+    u.uncachedInputTokens = uncached;
+    u.outputTokens = output;
+    u.cacheCreationTokens = cacheCreation;
+    u.cacheReadTokens = cacheRead;
+    return u;
+}
+
+static uint64_t total(RollupWindow window) {
+    return rollup->total(window).totalTokens;
+}
+
+void setUp() {
+    rollup = new Rollup();
+}
+
+void tearDown() {
+    delete rollup;
+}
+
+// ---------------------------------------------------------------------------
+// Fixed Cases
+// ---------------------------------------------------------------------------
+
+void test_record_fills_every_window() {
+    TEST_ASSERT_FALSE(rollup->hasData());
+    rollup->advance(at("2025-06-10T12:30:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T12:00:00Z"), usage(100, 20, 3, 4));
+
+    TEST_ASSERT_TRUE(rollup->hasData());
+    TokenUsage hour = rollup->total(WINDOW_HOUR);
+    TEST_ASSERT_EQUAL_UINT64(100, hour.uncachedInputTokens);
+    TEST_ASSERT_EQUAL_UINT64(20, hour.outputTokens);
+    TEST_ASSERT_EQUAL_UINT64(3, hour.cacheCreationTokens);
+    TEST_ASSERT_EQUAL_UINT64(4, hour.cacheReadTokens);
+    TEST_ASSERT_EQUAL_UINT64(127, hour.totalTokens);
+    for (uint8_t w = 0; w < WINDOW_COUNT; w++) {
+        TEST_ASSERT_EQUAL_UINT64(127, total((RollupWindow)w));
+    }
+}
+
+void test_hour_leaves_1h_on_the_hour() {
+    rollup->advance(at("2025-06-10T12:59:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T12:00:00Z"), usage(500));
+
+    rollup->advance(at("2025-06-10T12:59:59Z"));
+    TEST_ASSERT_EQUAL_UINT64(500, total(WINDOW_HOUR));
+    rollup->advance(at("2025-06-10T13:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_HOUR));
+    TEST_ASSERT_EQUAL_UINT64(500, total(WINDOW_TODAY));
+}
+
+void test_hour_leaves_7d_after_168_hours() {
+    rollup->advance(at("2025-06-10T12:00:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T11:00:00Z"), usage(300));
+    rollup->record(at("2025-06-10T12:00:00Z"), usage(200));
+
+    // 11:00 is the oldest hour of the week at 10:00 a week later
+    rollup->advance(at("2025-06-17T10:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(500, total(WINDOW_WEEK));
+    rollup->advance(at("2025-06-17T11:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(200, total(WINDOW_WEEK));
+    rollup->advance(at("2025-06-17T12:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_WEEK));
+    TEST_ASSERT_EQUAL_UINT64(500, total(WINDOW_MONTH));
+}
+
+void test_jump_past_the_week_empties_it() {
+    rollup->advance(at("2025-06-01T05:00:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-01T05:00:00Z"), usage(70));
+    rollup->advance(at("2025-06-20T05:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_WEEK));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_TODAY));
+    TEST_ASSERT_EQUAL_UINT64(70, total(WINDOW_MONTH));
+}
+
+void test_day_restarts_at_midnight_utc() {
+    rollup->advance(at("2025-06-10T23:10:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T22:00:00Z"), usage(40));
+    rollup->record(at("2025-06-10T23:00:00Z"), usage(60));
+    TEST_ASSERT_EQUAL_UINT64(100, total(WINDOW_TODAY));
+
+    rollup->advance(at("2025-06-11T00:05:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_TODAY));
+    TEST_ASSERT_EQUAL_UINT64(100, total(WINDOW_WEEK));
+    TEST_ASSERT_EQUAL_UINT64(100, total(WINDOW_MONTH));
+
+    // A late report of yesterday's last hour stays out of today
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T23:00:00Z"), usage(80));
+    rollup->record(at("2025-06-11T00:00:00Z"), usage(5));
+    TEST_ASSERT_EQUAL_UINT64(5, total(WINDOW_TODAY));
+    TEST_ASSERT_EQUAL_UINT64(125, total(WINDOW_WEEK));
+}
+
+void test_month_restarts_on_the_first() {
+    rollup->advance(at("2025-05-31T23:30:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-05-31T23:00:00Z"), usage(900));
+    TEST_ASSERT_EQUAL_UINT64(900, total(WINDOW_MONTH));
+
+    rollup->advance(at("2025-06-01T00:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_MONTH));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_TODAY));
+    TEST_ASSERT_EQUAL_UINT64(900, total(WINDOW_WEEK));
+
+    rollup->beginCycle();
+    rollup->record(at("2025-06-01T00:00:00Z"), usage(11));
+    rollup->advance(at("2025-06-30T23:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(11, total(WINDOW_MONTH));
+    rollup->advance(at("2025-07-01T00:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_MONTH));
+}
+
+void test_month_end_follows_the_calendar() {
+    // February of a leap year runs to the 29th
+    rollup->advance(at("2024-02-28T23:00:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2024-02-28T23:00:00Z"), usage(1));
+    rollup->advance(at("2024-02-29T00:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(1, total(WINDOW_MONTH));
+    rollup->advance(at("2024-03-01T00:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_MONTH));
+
+    // Across the year
+    rollup->beginCycle();
+    rollup->advance(at("2024-12-31T23:00:00Z"));
+    rollup->record(at("2024-12-31T23:00:00Z"), usage(2));
+    TEST_ASSERT_EQUAL_UINT64(2, total(WINDOW_MONTH));
+    rollup->advance(at("2025-01-01T00:00:00Z"));
+    TEST_ASSERT_EQUAL_UINT64(0, total(WINDOW_MONTH));
+}
+
+void test_same_hour_twice_in_a_cycle_adds() {
+    uint32_t hour = at("2025-06-10T12:00:00Z");
+    rollup->advance(hour + 60);
+
+    // Two sources report the same hour in one poll cycle
+    rollup->beginCycle();
+    rollup->record(hour, usage(100, 10));
+    rollup->record(hour, usage(50, 5));
+    TEST_ASSERT_EQUAL_UINT64(165, total(WINDOW_HOUR));
+    TEST_ASSERT_EQUAL_UINT64(165, total(WINDOW_MONTH));
+
+    // The next cycle's reports replace the hour
+    rollup->beginCycle();
+    rollup->record(hour, usage(120, 12));
+    TEST_ASSERT_EQUAL_UINT64(132, total(WINDOW_HOUR));
+    rollup->record(hour, usage(60, 6));
+    TEST_ASSERT_EQUAL_UINT64(198, total(WINDOW_HOUR));
+    TEST_ASSERT_EQUAL_UINT64(198, total(WINDOW_WEEK));
+}
+
+void test_future_hour_advances_and_old_hours_are_ignored() {
+    rollup->advance(at("2025-06-10T12:00:00Z"));
+    rollup->beginCycle();
+    rollup->record(at("2025-06-10T14:00:00Z"), usage(7));
+    TEST_ASSERT_EQUAL_UINT64(7, total(WINDOW_HOUR));
+
+    // Older than the ring: dropped without touching the totals
+    rollup->record(at("2025-06-10T14:00:00Z") - ROLLUP_HOURS * 3600UL, usage(1000));
+    TEST_ASSERT_EQUAL_UINT64(7, total(WINDOW_MONTH));
+
+    // Clock going backwards or not synced yet
+    rollup->advance(at("2025-06-10T13:00:00Z"));
+    rollup->advance(1000);
+    TEST_ASSERT_EQUAL_UINT64(7, total(WINDOW_HOUR));
+}
+
+// ---------------------------------------------------------------------------
+// Random Sequence Against a Brute-Force Re-Sum
+// ---------------------------------------------------------------------------
+
+struct Recorded {
+    uint32_t cycle;
+    uint64_t tokens;
+};
+
+static uint32_t monthStartHour(uint32_t hour) {
+    time_t t = (time_t)hour * 3600;
+    struct tm parts;
+    gmtime_r(&t, &parts);
+    return hour - (parts.tm_mday - 1) * 24 - parts.tm_hour;
+}
+
+static uint64_t resum(const std::map<uint32_t, Recorded>& hours, RollupWindow window,
+                      uint32_t now) {
+    uint64_t sum = 0;
+    for (const auto& entry : hours) {
+        uint32_t hour = entry.first;
+        bool in = false;
+        switch (window) {
+            case WINDOW_HOUR:  in = hour == now; break;
+            case WINDOW_TODAY: in = hour >= now - now % 24 && hour <= now; break;
+            case WINDOW_WEEK:  in = hour + 7 * 24 > now && hour <= now; break;
+            default:           in = hour >= monthStartHour(now) && hour <= now; break;
+        }
+        if (in) sum += entry.second.tokens;
+    }
+    return sum;
+}
+
+void test_random_sequence_matches_a_resum() {
+    std::map<uint32_t, Recorded> hours;
+    uint32_t cycle = 0;
+    uint32_t now = at("2025-01-25T00:00:00Z") / 3600;
+    rollup->advance(now * 3600);
+
+    for (uint32_t step = 0; step < RANDOM_STEPS; step++) {
+        uint32_t dice = esp_random() % 100;
+        if (dice < 10) {
+            // Clock: mostly small steps, sometimes a jump of weeks
+            uint32_t hoursAhead = dice < 1 ? 100 + esp_random() % 800 : esp_random() % 30;
+            now += hoursAhead;
+            rollup->advance(now * 3600 + esp_random() % 3600);
+        } else if (dice < 30) {
+            cycle++;
+            rollup->beginCycle();
+        } else {
+            // Mostly recent hours, a few future ones, a few beyond the ring
+            uint32_t hour = now + 2 - esp_random() % (ROLLUP_HOURS + 60);
+            uint32_t tokens = esp_random() % 100000;
+            rollup->record(hour * 3600, usage(tokens));
+
+            if (hour > now) now = hour;
+            if (hour + ROLLUP_HOURS > now) {
+                // Same cycle adds (another source), a new one replaces
+                Recorded& r = hours[hour];
+                r.tokens = (r.cycle == cycle ? r.tokens : 0) + tokens;
+                r.cycle = cycle;
+            }
+        }
+
+        // Hours that fell out of the ring can't be in any window any more
+        while (!hours.empty() && hours.begin()->first + ROLLUP_HOURS <= now) {
+            hours.erase(hours.begin());
+        }
+
+        for (uint8_t w = 0; w < WINDOW_COUNT; w++) {
+            uint64_t expected = resum(hours, (RollupWindow)w, now);
+            uint64_t actual = total((RollupWindow)w);
+            if (expected != actual) {
+                char message[96];
+                snprintf(message, sizeof(message), "step %u, window %s: %llu, re-sum %llu",
+                         step, Rollup::windowName((RollupWindow)w),
+                         (unsigned long long)actual, (unsigned long long)expected);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_record_fills_every_window);
+    RUN_TEST(test_hour_leaves_1h_on_the_hour);
+    RUN_TEST(test_hour_leaves_7d_after_168_hours);
+    RUN_TEST(test_jump_past_the_week_empties_it);
+    RUN_TEST(test_day_restarts_at_midnight_utc);
+    RUN_TEST(test_month_restarts_on_the_first);
+    RUN_TEST(test_month_end_follows_the_calendar);
+    RUN_TEST(test_same_hour_twice_in_a_cycle_adds);
+    RUN_TEST(test_future_hour_advances_and_old_hours_are_ignored);
+    RUN_TEST(test_random_sequence_matches_a_resum);
+    return UNITY_END();
+}
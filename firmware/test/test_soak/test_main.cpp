@@ -0,0 +1,308 @@
+// ============================================================================
+// Simulated-Time Soak: Polls Through Chaos
+// ============================================================================
+//
+// Three simulated days of polling, every POLL_INTERVAL_MS, against two mock
+// webhooks on the in-memory network: a local n8n serving two pipelined
+// URLs over http, and a second endpoint over https serving a webhook and a
+// raw usage report (hourly `data[]` buckets) on one pipelined connection.
+// Every 20 polls each server draws new "weather": mostly calm, otherwise
+// one of the chaos modes of test/shim/fake_webhook.h or a connection fault
+// (refused, blackholed, failing TLS). Bodies change every few polls.
+//
+// Each poll runs as loop() does once the worker is done: fetchGroup() per
+// endpoint, Parser::parse() on fresh bodies with the Rollup attached,
+// combine(), PollStats. The run checks that
+//   - no group outlives HTTP_TIMEOUT_MS,
+//   - a successful poll never holds a body the server no longer serves
+//     (no stale 304 after a broken transfer),
+//   - the first poll of a calm spell succeeds (recovery within one poll),
+//   - every body the server sent parses,
+//   - the DAY and 7D totals match a re-sum of the hours parsed so far,
+//   - heap use does not drift between the end of day one and the end of
+//     the run (glibc only).
+//
+// Scope: groups are fetched one after the other here rather than on
+// NetworkManager's parallel workers, each with its own deadline, and
+// loop()'s state machine (backoff, error screens, relay) is not driven.
+// Both need FreeRTOS tasks and are not part of the native build.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <fake_webhook.h>
+#include "rollup.h"
+#include "source.h"
+#include "stats.h"
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define MEASURES_HEAP 1
+#else
+#define MEASURES_HEAP 0
+#endif
+
+static const uint32_t DAYS = 3;
+static const uint32_t POLLS = DAYS * 24UL * 60UL * 60UL * 1000UL / POLL_INTERVAL_MS;
+static const uint32_t WEATHER_POLLS = 20;
+static const uint32_t BODY_POLLS = 7;
+static const uint32_t START_TIME = 1748736000;   // 2025-06-01T00:00:00Z
+static const uint32_t REPORT_HOURS = 6;          // Buckets per usage report
+static const size_t HEAP_DRIFT_MAX = 4096;
+
+static const IPAddress N8N_IP(192, 168, 1, 10);
+static const IPAddress API_IP(10, 20, 0, 5);
+
+static const char* const URLS[] = {
+    "http://n8n.lan:5678/webhook/claude-usage",
+    "http://n8n.lan:5678/webhook/team-usage",
+    "https://usage.example.com/webhook/claude-usage",
+    "https://usage.example.com/v1/organizations/usage_report/messages",
+};
+static const size_t USAGE_SOURCE = 3;
+static const size_t SOURCE_COUNT = sizeof(URLS) / sizeof(URLS[0]);
+
+struct Server {
+    fake::Webhook webhook;
+    bool calm;
+};
+
+static Server servers[2];        // n8n, https endpoint
+static Source sources[SOURCE_COUNT];
+static Server* serverOf[SOURCE_COUNT] = { &servers[0], &servers[0], &servers[1], &servers[1] };
+static std::string held[SOURCE_COUNT];   // Body each source's reading came from
+static PollStats stats;
+static Rollup rollup;
+
+// Hours in the usage report being served, and the totals parsed per hour
+// so far (ring by hour, deep enough for the whole run)
+struct HourTotal {
+    uint32_t hour;
+    uint64_t tokens;
+};
+static HourTotal reportHours[REPORT_HOURS];
+static HourTotal parsedHours[DAYS * 24 + REPORT_HOURS + 1];
+
+static uint32_t unixNow() {
+    return START_TIME + millis() / 1000;
+}
+
+static uint32_t random(uint32_t range) {
+    return esp_random() % range;
+}
+
+static std::string pathOf(const char* url) {
+    return strchr(strstr(url, "://") + 3, '/');
+}
+
+static void setWeather(Server& server) {
+    fake::Webhook& w = server.webhook;
+    w.chaos = fake::CHAOS_NONE;
+    w.refuse = w.blackhole = w.tlsFails = false;
+    w.latencyMs = 20 + random(400);
+    w.chunked = random(2) == 0;
+
+    server.calm = random(10) < 7;
+    if (server.calm) return;
+
+    uint32_t fault = random(fake::CHAOS_COUNT + 2);
+    if (fault < fake::CHAOS_COUNT) {
+        w.chaos = (fake::Chaos)(fault == fake::CHAOS_NONE ? (uint32_t)fake::CHAOS_STALL : fault);
+        const int codes[] = { 401, 403, 429, 500, 502, 503 };
+        w.status = codes[random(6)];
+        w.dripUs = 10000 + random(40000);
+    } else if (fault == fake::CHAOS_COUNT) {
+        w.refuse = true;
+    } else if (&server == &servers[1]) {
+        w.tlsFails = true;
+    } else {
+        w.blackhole = true;
+    }
+}
+
+// The last REPORT_HOURS hourly buckets up to the current hour. Past hours
+// keep their counts; the current one grows with every new body.
+static std::string usageReport(uint32_t poll) {
+    uint32_t hour = unixNow() / 3600;
+    std::string json = "{\"data\":[";
+    for (uint32_t i = 0; i < REPORT_HOURS; i++) {
+        uint32_t h = hour - (REPORT_HOURS - 1) + i;
+        uint32_t uncached = 1000 + (h % 97) * 13 + (h == hour ? poll : 0);
+        uint32_t output = 200 + h % 31;
+        uint32_t cacheRead = 5000 + (h % 11) * 101;
+        reportHours[i] = { h, (uint64_t)uncached + output + cacheRead };
+
+        time_t from = (time_t)h * 3600;
+        time_t to = from + 3600;
+        char fromText[24], toText[24], entry[320];
+        strftime(fromText, sizeof(fromText), "%Y-%m-%dT%H:00:00Z", gmtime(&from));
+        strftime(toText, sizeof(toText), "%Y-%m-%dT%H:00:00Z", gmtime(&to));
+        snprintf(entry, sizeof(entry),
+                 "%s{\"starting_at\":\"%s\",\"ending_at\":\"%s\",\"results\":"
+                 "{\"uncached_input_tokens\":%u,\"output_tokens\":%u,"
+                 "\"cache_creation_input_tokens\":0,\"cache_read_input_tokens\":%u,"
+                 "\"server_tool_use\":{\"web_search_requests\":0}}}",
+                 i > 0 ? "," : "", fromText, toText, uncached, output, cacheRead);
+        json += entry;
+    }
+    return json + "],\"has_more\":false,\"next_page\":null}";
+}
+
+// Re-sum the parsed hours that fall in [firstHour, lastHour]
+static uint64_t resum(uint32_t firstHour, uint32_t lastHour) {
+    uint64_t sum = 0;
+    for (const HourTotal& h : parsedHours) {
+        if (h.hour != 0 && h.hour >= firstHour && h.hour <= lastHour) sum += h.tokens;
+    }
+    return sum;
+}
+
+static size_t heapInUse() {
+#if MEASURES_HEAP
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+static void setBodies(uint32_t poll) {
+    serverOf[USAGE_SOURCE]->webhook.setBody(pathOf(URLS[USAGE_SOURCE]), usageReport(poll));
+    for (size_t i = 0; i < USAGE_SOURCE; i++) {
+        char body[96];
+        snprintf(body, sizeof(body),
+                 "{\"cost_usd\":%.2f,\"trend\":\"%s\",\"tokens_total\":%u}",
+                 1.0 + i + poll * 0.05, poll % 2 ? "up" : "flat", 10000 + (unsigned)(poll * 37 + i));
+        serverOf[i]->webhook.setBody(pathOf(URLS[i]), body);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_soak() {
+    fake::resetClock();
+    fake::resetNetwork();
+    fake::logLevel = fake::LOG_NONE;
+    fake::dns()["n8n.lan"] = N8N_IP;
+    fake::dns()["usage.example.com"] = API_IP;
+    fake::listen(N8N_IP, 5678, &servers[0].webhook);
+    fake::listen(API_IP, 443, &servers[1].webhook);
+    servers[1].webhook.handshakeMs = 350;
+
+    for (size_t i = 0; i < SOURCE_COUNT; i++) sources[i].configure(URLS[i], "CA");
+
+    Source* groups[2][SOURCE_COUNT] = { { &sources[0], &sources[1] },
+                                        { &sources[2], &sources[3] } };
+    const size_t groupSizes[2] = { 2, 2 };
+
+    uint32_t failedPolls = 0;
+    uint32_t fresh = 0;
+    uint32_t notModified = 0;
+    uint32_t parsed = 0;
+    uint32_t recoveries = 0;
+    uint32_t rollupChecks = 0;
+    size_t heapAfterDayOne = 0;
+    bool lastFailed = false;
+    MeterData readings[SOURCE_COUNT] = {};
+
+    for (uint32_t poll = 0; poll < POLLS; poll++) {
+        if (poll % WEATHER_POLLS == 0) {
+            for (Server& server : servers) setWeather(server);
+        }
+        if (poll % BODY_POLLS == 0) setBodies(poll);
+
+        unsigned long tick = millis();
+        const char* error = nullptr;
+        for (size_t g = 0; g < 2; g++) {
+            unsigned long started = millis();
+            Source::fetchGroup(groups[g], groupSizes[g], started, started + HTTP_TIMEOUT_MS);
+            TEST_ASSERT_LESS_OR_EQUAL(HTTP_TIMEOUT_MS, millis() - started);
+        }
+
+        bool allFetched = true;
+        for (const Source& source : sources) allFetched = allFetched && source.result().success;
+        if (allFetched) {
+            rollup.advance(unixNow());
+            rollup.beginCycle();
+        }
+
+        for (size_t i = 0; i < SOURCE_COUNT; i++) {
+            const FetchResult& r = sources[i].result();
+            const std::string& served = serverOf[i]->webhook.bodyFor(pathOf(URLS[i]));
+            if (!r.success) {
+                if (error == nullptr) error = r.errorMsg;
+                continue;
+            }
+            if (!r.notModified) {
+                fresh++;
+                held[i] = r.payload;
+                readings[i] = Parser::parse(r.payload, r.payloadLength, r.format, r.encoding,
+                                            allFetched ? &rollup : nullptr);
+                if (readings[i].valid) parsed++;
+                if (i == USAGE_SOURCE && allFetched) {
+                    for (const HourTotal& h : reportHours) {
+                        parsedHours[h.hour % (sizeof(parsedHours) / sizeof(parsedHours[0]))] = h;
+                    }
+                }
+            } else {
+                notModified++;
+            }
+            TEST_ASSERT_EQUAL_STRING_MESSAGE(served.c_str(), held[i].c_str(), URLS[i]);
+        }
+
+        bool calm = servers[0].calm && servers[1].calm;
+        if (calm && poll % WEATHER_POLLS == 0 && lastFailed) {
+            TEST_ASSERT_NULL_MESSAGE(error, "no recovery on the first calm poll");
+            recoveries++;
+        }
+        if (calm) TEST_ASSERT_NULL(error);
+
+        if (error == nullptr) {
+            MeterData data = Parser::combine(readings, SOURCE_COUNT);
+            TEST_ASSERT_TRUE(data.sourceCount == SOURCE_COUNT);
+
+            uint32_t hour = unixNow() / 3600;
+            TEST_ASSERT_EQUAL_UINT64(resum(hour - hour % 24, hour),
+                                     rollup.total(WINDOW_TODAY).totalTokens);
+            TEST_ASSERT_EQUAL_UINT64(resum(hour - (7 * 24 - 1), hour),
+                                     rollup.total(WINDOW_WEEK).totalTokens);
+            rollupChecks++;
+        } else {
+            failedPolls++;
+        }
+        stats.recordPoll(millis() - tick, error);
+        lastFailed = error != nullptr;
+
+        // Next tick
+        unsigned long next = tick + POLL_INTERVAL_MS;
+        if ((long)(next - millis()) > 0) fake::advance(next - millis());
+
+        if (poll + 1 == POLLS / DAYS) heapAfterDayOne = heapInUse();
+    }
+    long heapDrift = (long)heapInUse() - (long)heapAfterDayOne;
+
+    char message[224];
+    snprintf(message, sizeof(message),
+             "%u polls over %u days: %u failed, %u recoveries, %u bodies, %u not modified, "
+             "n8n requests %u, https requests %u, %u rollup checks, heap drift %ld bytes",
+             POLLS, DAYS, failedPolls, recoveries, fresh, notModified,
+             servers[0].webhook.requests, servers[1].webhook.requests, rollupChecks,
+             heapDrift);
+    TEST_MESSAGE(message);
+    fake::logLevel = fake::LOG_INFO;
+    stats.report();
+    fake::logLevel = fake::LOG_WARN;
+
+    TEST_ASSERT_GREATER_THAN(0, recoveries);
+    TEST_ASSERT_GREATER_THAN(0, notModified);
+    TEST_ASSERT_EQUAL_UINT32(fresh, parsed);
+    TEST_ASSERT_GREATER_THAN(0, rollupChecks);
+#if MEASURES_HEAP
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(HEAP_DRIFT_MAX, labs(heapDrift), "heap drift");
+#endif
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_soak);
+    return UNITY_END();
+}
@@ -0,0 +1,304 @@
+// ============================================================================
+// Source Against a Misbehaving Webhook
+// ============================================================================
+//
+// Fetches through Source::fetchGroup from the mock webhook of
+// test/shim/fake_webhook.h over the in-memory network, one chaos mode per
+// case, and checks what a poll would report: HTTP code, ERR_* code, the
+// phase a failure is pinned to, and that no fetch outlives its deadline.
+
+#include <Arduino.h>
+#include <unity.h>
+#include <fake_webhook.h>
+#include "source.h"
+
+static const IPAddress SERVER_IP(10, 0, 0, 2);
+static const char* const URL = "http://meter.local:5678/webhook/claude-usage";
+
+static fake::Webhook* server;
+static Source* sources[2];
+
+static const FetchResult& fetch(size_t count = 1, const volatile bool* cancel = nullptr) {
+    unsigned long now = millis();
+    Source::fetchGroup(sources, count, now, now + HTTP_TIMEOUT_MS, cancel);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_LESS_OR_EQUAL(HTTP_TIMEOUT_MS, sources[i]->result().elapsedMs);
+    }
+    return sources[0]->result();
+}
+
+static void assertFailed(int httpCode, const char* errorMsg, FetchPhase phase) {
+    const FetchResult& r = sources[0]->result();
+    TEST_ASSERT_FALSE(r.success);
+    TEST_ASSERT_EQUAL_INT(httpCode, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING(errorMsg, r.errorMsg);
+    TEST_ASSERT_EQUAL_INT(phase, r.failedPhase);
+}
+
+void setUp() {
+    fake::resetClock();
+    fake::resetNetwork();
+    fake::dns()["meter.local"] = SERVER_IP;
+    server = new fake::Webhook();
+    fake::listen(SERVER_IP, 5678, server);
+
+    for (Source*& source : sources) {
+        source = new Source();
+        source->configure(URL, nullptr);
+    }
+}
+
+void tearDown() {
+    for (Source* source : sources) delete source;
+    delete server;
+}
+
+void test_body_then_not_modified() {
+    const FetchResult& r = fetch();
+    TEST_ASSERT_TRUE(r.success);
+    TEST_ASSERT_EQUAL_INT(200, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING(server->bodyFor("/webhook/claude-usage").c_str(), r.payload);
+
+    fetch();
+    TEST_ASSERT_TRUE(r.success);
+    TEST_ASSERT_TRUE(r.notModified);
+    TEST_ASSERT_EQUAL(1, server->notModified);
+}
+
+void test_changed_body_is_fetched_again() {
+    fetch();
+    server->setBody("{\"cost_usd\":13.00,\"trend\":\"up\",\"tokens_total\":1300000}");
+    const FetchResult& r = fetch();
+    TEST_ASSERT_EQUAL_INT(200, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING("{\"cost_usd\":13.00,\"trend\":\"up\",\"tokens_total\":1300000}",
+                             r.payload);
+}
+
+void test_chunked_body() {
+    server->chunked = true;
+    const FetchResult& r = fetch();
+    TEST_ASSERT_EQUAL_INT(200, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING(server->bodyFor("/").c_str(), r.payload);
+}
+
+void test_msgpack_content_type() {
+    server->contentType = "application/msgpack";
+    TEST_ASSERT_EQUAL_INT(FORMAT_MSGPACK, fetch().format);
+}
+
+void test_pipelined_group_shares_a_connection() {
+    sources[1]->configure("http://meter.local:5678/webhook/team-usage", nullptr);
+    server->setBody("/webhook/team-usage", "{\"cost_usd\":1.00}");
+    fetch(2);
+
+    TEST_ASSERT_EQUAL(1, server->connections);
+    TEST_ASSERT_EQUAL_STRING(server->bodyFor("/").c_str(), sources[0]->result().payload);
+    TEST_ASSERT_EQUAL_STRING("{\"cost_usd\":1.00}", sources[1]->result().payload);
+}
+
+void test_close_early_resends_on_a_new_connection() {
+    sources[1]->configure("http://meter.local:5678/webhook/team-usage", nullptr);
+    server->chaos = fake::CHAOS_CLOSE_EARLY;
+    fetch(2);
+
+    TEST_ASSERT_EQUAL(2, server->connections);
+    TEST_ASSERT_TRUE(sources[0]->result().success);
+    TEST_ASSERT_TRUE(sources[1]->result().success);
+}
+
+void test_failed_resend_keeps_phase_timings() {
+    // Long enough into the run that a stale phase start would saturate
+    fake::advance(100000);
+    sources[1]->configure("http://meter.local:5678/webhook/team-usage", nullptr);
+    server->chaos = fake::CHAOS_CLOSE_EARLY;
+    fake::onTick([] { if (server->connections >= 1) server->refuse = true; });
+    fetch(2);
+
+    const FetchResult& r = sources[1]->result();
+    TEST_ASSERT_TRUE(sources[0]->result().success);
+    TEST_ASSERT_FALSE(r.success);
+    TEST_ASSERT_EQUAL_INT(PHASE_CONNECT, r.failedPhase);
+    for (uint8_t phase = 0; phase < PHASE_COUNT; phase++) {
+        TEST_ASSERT_LESS_OR_EQUAL(r.elapsedMs, r.phaseMs[phase]);
+    }
+}
+
+void test_slow_drip_times_out_in_body() {
+    server->chaos = fake::CHAOS_SLOW_DRIP;
+    server->dripUs = 50000;   // 20 bytes/s: headers alone take seconds
+    fetch();
+    assertFailed(HTTP_ERR_TIMEOUT, ERR_TLS, PHASE_BODY);
+}
+
+void test_truncated_body_drops_the_validator() {
+    fetch();
+    server->setBody("{\"cost_usd\":14.00,\"trend\":\"flat\",\"tokens_total\":1400000}");
+    server->chaos = fake::CHAOS_TRUNCATE;
+    fetch();
+    assertFailed(HTTP_ERR_CONNECTION_LOST, ERR_TLS, PHASE_BODY);
+
+    // A stale 304 here would keep showing the old value
+    server->chaos = fake::CHAOS_NONE;
+    const FetchResult& r = fetch();
+    TEST_ASSERT_EQUAL_INT(200, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING(server->bodyFor("/").c_str(), r.payload);
+}
+
+void test_reset_is_connection_lost() {
+    server->chaos = fake::CHAOS_RESET;
+    fetch();
+    assertFailed(HTTP_ERR_CONNECTION_LOST, ERR_TLS, PHASE_FIRST_BYTE);
+}
+
+void test_stall_times_out_waiting_for_first_byte() {
+    server->chaos = fake::CHAOS_STALL;
+    const FetchResult& r = fetch();
+    assertFailed(HTTP_ERR_TIMEOUT, ERR_TLS, PHASE_FIRST_BYTE);
+    TEST_ASSERT_GREATER_OR_EQUAL(HTTP_FIRST_BYTE_TIMEOUT_MS, r.phaseMs[PHASE_FIRST_BYTE]);
+}
+
+void test_stall_can_be_cancelled() {
+    static volatile bool cancel = false;
+    cancel = false;
+    server->chaos = fake::CHAOS_STALL;
+    unsigned long cancelAt = millis() + 300;
+    fake::onTick([cancelAt] { if (millis() >= cancelAt) cancel = true; });
+
+    const FetchResult& r = fetch(1, &cancel);
+    assertFailed(HTTP_ERR_CANCELLED, ERR_TLS, PHASE_FIRST_BYTE);
+    TEST_ASSERT_LESS_THAN(400, r.elapsedMs);
+}
+
+void test_auth_errors_are_api_errors() {
+    server->chaos = fake::CHAOS_STATUS;
+    const int codes[] = { 401, 403 };
+    for (int code : codes) {
+        server->status = code;
+        fetch();
+        assertFailed(code, ERR_API, PHASE_COUNT);
+    }
+}
+
+void test_server_errors_are_http_errors() {
+    server->chaos = fake::CHAOS_STATUS;
+    const int codes[] = { 429, 500, 502, 503 };
+    for (int code : codes) {
+        server->status = code;
+        fetch();
+        assertFailed(code, ERR_HTTP, PHASE_COUNT);
+    }
+}
+
+void test_error_status_keeps_the_pipeline_in_step() {
+    sources[1]->configure("http://meter.local:5678/webhook/team-usage", nullptr);
+    server->chaos = fake::CHAOS_STATUS;
+    server->status = 503;
+    fetch(2);
+    TEST_ASSERT_EQUAL(1, server->connections);
+    TEST_ASSERT_EQUAL_INT(503, sources[0]->result().httpCode);
+    TEST_ASSERT_EQUAL_INT(503, sources[1]->result().httpCode);
+}
+
+void test_garbage_is_a_protocol_error() {
+    server->chaos = fake::CHAOS_GARBAGE;
+    fetch();
+    assertFailed(HTTP_ERR_PROTOCOL, ERR_TLS, PHASE_FIRST_BYTE);
+}
+
+void test_oversized_body_is_a_json_error() {
+    server->setBody(std::string(HTTP_PAYLOAD_MAX + 1, ' '));
+    const FetchResult& r = fetch();
+    TEST_ASSERT_EQUAL_INT(HTTP_ERR_TOO_LARGE, r.httpCode);
+    TEST_ASSERT_EQUAL_STRING(ERR_JSON, r.errorMsg);
+}
+
+void test_unknown_host_fails_in_dns() {
+    fake::dns().clear();
+    fetch();
+    assertFailed(HTTP_ERR_CONNECT, ERR_TLS, PHASE_DNS);
+}
+
+void test_refused_connect() {
+    server->refuse = true;
+    fetch();
+    assertFailed(HTTP_ERR_CONNECT, ERR_TLS, PHASE_CONNECT);
+}
+
+void test_blackhole_connect_times_out() {
+    server->blackhole = true;
+    const FetchResult& r = fetch();
+    assertFailed(HTTP_ERR_TIMEOUT, ERR_TLS, PHASE_CONNECT);
+    TEST_ASSERT_LESS_OR_EQUAL(HTTP_CONNECT_TIMEOUT_MS + 10, r.elapsedMs);
+}
+
+void test_moved_host_is_re_resolved() {
+    fetch();
+    TEST_ASSERT_TRUE(sources[0]->hostIp() == SERVER_IP);
+
+    // The cached address stops answering; DNS has the new one
+    const IPAddress moved(10, 0, 0, 3);
+    server->refuse = true;
+    fake::Webhook other;
+    fake::listen(moved, 5678, &other);
+    fake::dns()["meter.local"] = moved;
+
+    TEST_ASSERT_TRUE(fetch().success);
+    TEST_ASSERT_TRUE(sources[0]->hostIp() == moved);
+}
+
+void test_tls_connect_is_bounded_by_the_phase() {
+    sources[0]->configure("https://meter.example.com/webhook/claude-usage", "CA");
+    fake::dns()["meter.example.com"] = SERVER_IP;
+    fake::Webhook secure;
+    secure.blackhole = true;
+    fake::listen(SERVER_IP, 443, &secure);
+
+    const FetchResult& r = fetch();
+    assertFailed(HTTP_ERR_TIMEOUT, ERR_TLS, PHASE_TLS);
+    TEST_ASSERT_LESS_OR_EQUAL(HTTP_TLS_TIMEOUT_MS + 10, r.elapsedMs);
+}
+
+void test_tls_handshake_failure() {
+    sources[0]->configure("https://meter.example.com/webhook/claude-usage", "CA");
+    fake::dns()["meter.example.com"] = SERVER_IP;
+    fake::Webhook secure;
+    secure.handshakeMs = 800;
+    secure.tlsFails = true;
+    fake::listen(SERVER_IP, 443, &secure);
+
+    fetch();
+    assertFailed(HTTP_ERR_CONNECT, ERR_TLS, PHASE_TLS);
+
+    secure.tlsFails = false;
+    const FetchResult& r = fetch();
+    TEST_ASSERT_TRUE(r.success);
+    TEST_ASSERT_GREATER_OR_EQUAL(800, r.phaseMs[PHASE_TLS]);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_body_then_not_modified);
+    RUN_TEST(test_changed_body_is_fetched_again);
+    RUN_TEST(test_chunked_body);
+    RUN_TEST(test_msgpack_content_type);
+    RUN_TEST(test_pipelined_group_shares_a_connection);
+    RUN_TEST(test_close_early_resends_on_a_new_connection);
+    RUN_TEST(test_failed_resend_keeps_phase_timings);
+    RUN_TEST(test_slow_drip_times_out_in_body);
+    RUN_TEST(test_truncated_body_drops_the_validator);
+    RUN_TEST(test_reset_is_connection_lost);
+    RUN_TEST(test_stall_times_out_waiting_for_first_byte);
+    RUN_TEST(test_stall_can_be_cancelled);
+    RUN_TEST(test_auth_errors_are_api_errors);
+    RUN_TEST(test_server_errors_are_http_errors);
+    RUN_TEST(test_error_status_keeps_the_pipeline_in_step);
+    RUN_TEST(test_garbage_is_a_protocol_error);
+    RUN_TEST(test_oversized_body_is_a_json_error);
+    RUN_TEST(test_unknown_host_fails_in_dns);
+    RUN_TEST(test_refused_connect);
+    RUN_TEST(test_blackhole_connect_times_out);
+    RUN_TEST(test_moved_host_is_re_resolved);
+    RUN_TEST(test_tls_connect_is_bounded_by_the_phase);
+    RUN_TEST(test_tls_handshake_failure);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+// ============================================================================
+// Last-Value Store Flash Wear
+// ============================================================================
+//
+// Drives MeterStore at the default poll rate (1,440 polls a day) against
+// the in-memory Preferences of test/shim, which counts every NVS write,
+// and checks the coalescing promised in store.h: unchanged readings are
+// never written, changed ones at most once per STORE_FLASH_INTERVAL_MS.
+
+#include <Arduino.h>
+#include <unity.h>
+#include "store.h"
+
+static const unsigned long POLL_MS = 60UL * 1000UL;
+static const uint32_t POLLS_PER_DAY = 24UL * 60UL * 60UL * 1000UL / POLL_MS;
+static const uint32_t MAX_WRITES_PER_DAY =
+    24UL * 60UL * 60UL * 1000UL / STORE_FLASH_INTERVAL_MS;
+
+static MeterData reading(float cost) {
+    MeterData data = {};
+    data.valid = true;
+    data.costUsd = cost;
+    data.trend = TREND_UP;
+    data.tokens.uncachedInputTokens = 100;
+    data.tokens.outputTokens = 20;
+    data.tokens.totalTokens = 120;
+    data.sourceCount = 1;
+    return data;
+}
+
+void setUp() {
+    fake::resetClock();
+    fake::nvsErase();
+}
+
+void tearDown() {}
+
+void test_reading_survives_reboot() {
+    MeterStore store;
+    store.save(reading(12.5f));
+
+    MeterStore rebooted;
+    MeterData data;
+    uint32_t timestamp;
+    TEST_ASSERT_TRUE(rebooted.load(data, timestamp));
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, data.costUsd);
+    TEST_ASSERT_EQUAL(120, data.tokens.totalTokens);
+}
+
+void test_unchanged_readings_are_not_written() {
+    MeterStore store;
+    for (uint32_t i = 0; i < POLLS_PER_DAY; i++) {
+        store.save(reading(12.5f));
+        fake::advance(POLL_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, fake::nvsWrites);
+    TEST_ASSERT_EQUAL_UINT32(1, store.flashWrites());
+}
+
+void test_flash_writes_per_day() {
+    // Worst case: the reading changes on every poll, for a week
+    MeterStore store;
+    uint32_t worstDay = 0;
+    for (uint32_t day = 0; day < 7; day++) {
+        uint32_t before = fake::nvsWrites;
+        for (uint32_t i = 0; i < POLLS_PER_DAY; i++) {
+            store.save(reading(0.01f * (day * POLLS_PER_DAY + i)));
+            fake::advance(POLL_MS);
+        }
+        uint32_t writes = fake::nvsWrites - before;
+        if (writes > worstDay) worstDay = writes;
+    }
+
+    char message[80];
+    snprintf(message, sizeof(message), "%u polls/day -> at most %u flash writes/day",
+             POLLS_PER_DAY, worstDay);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(MAX_WRITES_PER_DAY, worstDay);
+    TEST_ASSERT_EQUAL_UINT32(fake::nvsWrites, store.flashWrites());
+}
+
+void test_clear_forgets_the_reading() {
+    MeterStore store;
+    store.save(reading(12.5f));
+    store.clear();
+
+    MeterStore rebooted;
+    MeterData data;
+    uint32_t timestamp;
+    TEST_ASSERT_FALSE(rebooted.load(data, timestamp));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reading_survives_reboot);
+    RUN_TEST(test_unchanged_readings_are_not_written);
+    RUN_TEST(test_flash_writes_per_day);
+    RUN_TEST(test_clear_forgets_the_reading);
+    return UNITY_END();
+}
@@ -0,0 +1,56 @@
+// ============================================================================
+// Parser Fuzz Target
+// ============================================================================
+//
+// Input layout: one selector byte, then the response body.
+//
+//   selector bit 0      wire format    0 = JSON, 1 = MessagePack
+//   selector bits 1-2   Content-Encoding   0 = identity, 1 = gzip,
+//                                          2 = deflate (3 wraps to identity)
+//
+// The body is copied into a buffer of exactly its length, as Source hands
+// it over minus the NUL, so any read past the end trips ASan. On top of
+// the sanitizers, a reading the parser calls valid must be one the device
+// can show: a finite, non-negative cost, and a zero total only when every
+// part is zero (a missing total is the saturating sum of the parts).
+
+#include <Arduino.h>
+#include <math.h>
+#include <vector>
+#include "parser.h"
+#include "rollup.h"
+
+static Rollup rollup;
+
+extern "C" int LLVMFuzzerInitialize(int*, char***) {
+    // Parse errors are the common case here; logging them costs exec/s
+    fake::logLevel = fake::LOG_NONE;
+    return 0;
+}
+
+static uint64_t addSaturating(uint64_t a, uint64_t b) {
+    return a > UINT64_MAX - b ? UINT64_MAX : a + b;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) return 0;
+
+    PayloadFormat format = (data[0] & 1) ? FORMAT_MSGPACK : FORMAT_JSON;
+    PayloadEncoding encoding = (PayloadEncoding)(((data[0] >> 1) & 3) % 3);
+    std::vector<char> body(data + 1, data + size);
+
+    rollup.beginCycle();
+    MeterData meter = Parser::parse(body.data(), body.size(), format, encoding, &rollup);
+    if (!meter.valid) return 0;
+
+    if (!isfinite(meter.costUsd) || meter.costUsd < 0.0f) __builtin_trap();
+
+    // A webhook may state a total that differs from its parts; only a
+    // total of zero is known to be derived
+    const TokenUsage& t = meter.tokens;
+    uint64_t parts = addSaturating(addSaturating(t.uncachedInputTokens, t.outputTokens),
+                                   addSaturating(t.cacheCreationTokens, t.cacheReadTokens));
+    if (t.totalTokens == 0 && parts != 0) __builtin_trap();
+
+    return 0;
+}
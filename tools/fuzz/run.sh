@@ -0,0 +1,25 @@
+#!/bin/sh
+# Fuzz Parser::parse for a while and print libFuzzer's final stats
+# (exec/s, coverage, corpus size).
+#
+#   tools/fuzz/run.sh <build dir> [seconds, default 300] [extra libFuzzer flags]
+#
+# New inputs go to <build dir>/corpus, seeded from tools/fuzz/corpus; a
+# crash is written to <build dir>/crash-* and can be replayed by passing
+# the file to fuzz_parser.
+
+set -e
+
+here=$(cd "$(dirname "$0")" && pwd)
+build=${1:?usage: run.sh <build dir> [seconds] [libFuzzer flags]}
+seconds=${2:-300}
+[ $# -ge 2 ] && shift 2 || shift $#
+
+mkdir -p "$build/corpus"
+cd "$build"
+./fuzz_parser corpus "$here/corpus" \
+    -dict="$here/parser.dict" \
+    -max_len=8193 \
+    -max_total_time="$seconds" \
+    -print_final_stats=1 \
+    "$@"
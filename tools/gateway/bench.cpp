@@ -0,0 +1,188 @@
+// ============================================================================
+// gateway_bench — Meter Polls per Second and Latency Against the Gateway
+// ============================================================================
+//
+//   gateway_bench [seconds] [connections]        (default 5 s, 64)
+//
+// Starts a Gateway in-process on a loopback port, refreshed once from a
+// 24-hour usage report, and drives it from `connections` client threads,
+// each polling back to back over one keep-alive connection as a meter
+// would. Two runs:
+//
+//   fresh    no If-None-Match, every answer a 200 with the body
+//   cached   If-None-Match with the current ETag, every answer a 304
+//
+// Reports requests/s and p50/p99/max latency (request written to response
+// read) per run. Any answer other than the expected one, or a run with no
+// answers at all, fails the benchmark.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "gateway.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Run {
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    std::vector<uint32_t> latencyUs;
+};
+
+static std::string usageReport() {
+    std::string json = "{\"data\":[";
+    for (uint32_t h = 0; h < 24; h++) {
+        char entry[320];
+        snprintf(entry, sizeof(entry),
+                 "%s{\"starting_at\":\"2025-06-01T%02u:00:00Z\","
+                 "\"ending_at\":\"2025-06-0%uT%02u:00:00Z\",\"results\":"
+                 "{\"uncached_input_tokens\":%u,\"output_tokens\":%u,"
+                 "\"cache_creation_input_tokens\":%u,\"cache_read_input_tokens\":%u,"
+                 "\"server_tool_use\":{\"web_search_requests\":0}}}",
+                 h > 0 ? "," : "", h, h + 1 < 24 ? 1 : 2, (h + 1) % 24,
+                 1000 + h * 137, 200 + h * 29, h * 11, 50000 + h * 1009);
+        json += entry;
+    }
+    json += "],\"has_more\":false,\"next_page\":null}";
+    return json;
+}
+
+static int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+// Read one response; its status code, or -1 if the connection failed
+static int readResponse(int fd, std::string& in) {
+    char buffer[4096];
+    size_t end;
+    while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return -1;
+        in.append(buffer, n);
+    }
+
+    int status = atoi(in.c_str() + 9);   // "HTTP/1.1 200"
+    size_t length = 0;
+    size_t at = in.find("Content-Length:");
+    if (at != std::string::npos && at < end) length = strtoul(in.c_str() + at + 15, nullptr, 10);
+
+    size_t total = end + 4 + length;
+    while (in.size() < total) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) return -1;
+        in.append(buffer, n);
+    }
+    in.erase(0, total);
+    return status;
+}
+
+static void client(int port, const std::string& request, int expected,
+                   Clock::time_point deadline, Run& run) {
+    int fd = connectTo(port);
+    if (fd < 0) {
+        run.errors++;
+        return;
+    }
+
+    std::string in;
+    while (Clock::now() < deadline) {
+        Clock::time_point sent = Clock::now();
+        if (send(fd, request.data(), request.size(), MSG_NOSIGNAL) != (ssize_t)request.size()) {
+            run.errors++;
+            break;
+        }
+        int status = readResponse(fd, in);
+        uint32_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - sent).count();
+
+        if (status != expected) {
+            run.errors++;
+            if (status < 0) break;
+        }
+        run.requests++;
+        run.latencyUs.push_back(us);
+    }
+    close(fd);
+}
+
+static bool measure(const char* name, int port, const std::string& request, int expected,
+                    double seconds, int connections) {
+    std::vector<Run> runs(connections);
+    std::vector<std::thread> threads;
+    Clock::time_point started = Clock::now();
+    Clock::time_point deadline = started + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+
+    for (int i = 0; i < connections; i++) {
+        threads.emplace_back(client, port, std::cref(request), expected, deadline,
+                             std::ref(runs[i]));
+    }
+    for (std::thread& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+    Run total;
+    for (Run& run : runs) {
+        total.requests += run.requests;
+        total.errors += run.errors;
+        total.latencyUs.insert(total.latencyUs.end(), run.latencyUs.begin(), run.latencyUs.end());
+    }
+    if (total.latencyUs.empty()) {
+        printf("%-7s no responses\n", name);
+        return false;
+    }
+
+    std::sort(total.latencyUs.begin(), total.latencyUs.end());
+    auto percentile = [&total](double p) {
+        size_t index = (size_t)(p * (total.latencyUs.size() - 1));
+        return total.latencyUs[index] / 1000.0;
+    };
+    printf("%-7s %3d conns %5.1f s %9llu req %9.0f req/s  p50 %6.3f ms  p99 %6.3f ms  "
+           "max %7.3f ms  %llu errors\n",
+           name, connections, elapsed, (unsigned long long)total.requests,
+           total.requests / elapsed, percentile(0.50), percentile(0.99),
+           total.latencyUs.back() / 1000.0, (unsigned long long)total.errors);
+    return total.errors == 0;
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 5.0;
+    int connections = argc > 2 ? atoi(argv[2]) : 64;
+
+    fake::useRealClock();
+    fake::logLevel = fake::LOG_WARN;
+
+    Gateway gateway;
+    std::string report = usageReport();
+    if (!gateway.refresh(report.data(), report.size())) {
+        fprintf(stderr, "usage report does not parse\n");
+        return 1;
+    }
+    int port = gateway.listen(0, true);
+    if (port < 0) {
+        return 1;
+    }
+
+    const std::string path = "GET /webhook/claude-usage HTTP/1.1\r\nHost: gateway\r\n";
+    bool ok = measure("fresh", port, path + "\r\n", 200, seconds, connections);
+    ok = measure("cached", port, path + "If-None-Match: " + gateway.etag() + "\r\n\r\n", 304,
+                 seconds, connections) && ok;
+
+    gateway.stop();
+    return ok ? 0 : 1;
+}
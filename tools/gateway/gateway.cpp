@@ -0,0 +1,264 @@
+#include "gateway.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// ============================================================================
+// Gateway Implementation
+// ============================================================================
+
+// A request head larger than this is not a meter; drop the connection
+#define GATEWAY_MAX_REQUEST  8192
+
+Gateway::Gateway()
+    : _previousCost(0.0f)
+    , _hasPrevious(false)
+    , _listenFd(-1)
+    , _running(false)
+    , _requests(0)
+    , _notModified(0)
+{
+}
+
+Gateway::~Gateway() {
+    stop();
+}
+
+bool Gateway::refresh(const char* payload, size_t length) {
+    MeterData data = Parser::parse(payload, length);
+    if (!data.valid) {
+        return false;
+    }
+
+    // Cents, as the meters show them; the trend compares with the last
+    // refresh at that resolution
+    float cost = roundf(data.costUsd * 100.0f) / 100.0f;
+    const char* trend = "flat";
+    if (_hasPrevious && cost != _previousCost) {
+        trend = cost > _previousCost ? "up" : "down";
+    }
+
+    char body[384];
+    const TokenUsage& t = data.tokens;
+    snprintf(body, sizeof(body),
+             "{\"cost_usd\":%.2f,\"trend\":\"%s\",\"tokens_total\":%llu,"
+             "\"uncached_input_tokens\":%llu,\"output_tokens\":%llu,"
+             "\"cache_creation_input_tokens\":%llu,\"cache_read_input_tokens\":%llu}",
+             cost, trend, (unsigned long long)t.totalTokens,
+             (unsigned long long)t.uncachedInputTokens, (unsigned long long)t.outputTokens,
+             (unsigned long long)t.cacheCreationTokens, (unsigned long long)t.cacheReadTokens);
+
+    // An unchanged body keeps its ETag, so meters keep getting 304s
+    std::shared_ptr<const Snapshot> current = std::atomic_load(&_snapshot);
+    if (current == nullptr || current->body != body) {
+        auto next = std::make_shared<Snapshot>();
+        next->body = body;
+        next->etag = _etagOf(next->body);
+        std::atomic_store(&_snapshot, std::shared_ptr<const Snapshot>(next));
+        log_i("Gateway: %s %s", next->etag.c_str(), body);
+    }
+
+    _previousCost = cost;
+    _hasPrevious = true;
+    return true;
+}
+
+int Gateway::listen(uint16_t port, bool loopbackOnly) {
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenFd < 0) {
+        log_e("Gateway: socket: %s", strerror(errno));
+        return -1;
+    }
+    int on = 1;
+    setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(loopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+    socklen_t addrLength = sizeof(addr);
+
+    if (bind(_listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(_listenFd, SOMAXCONN) != 0 ||
+        getsockname(_listenFd, (sockaddr*)&addr, &addrLength) != 0) {
+        log_e("Gateway: cannot listen on port %u: %s", port, strerror(errno));
+        close(_listenFd);
+        _listenFd = -1;
+        return -1;
+    }
+
+    _running = true;
+    _acceptThread = std::thread(&Gateway::_acceptLoop, this);
+    return ntohs(addr.sin_port);
+}
+
+void Gateway::stop() {
+    if (!_running.exchange(false)) {
+        return;
+    }
+
+    // shutdown() wakes the threads blocked in accept() and recv()
+    shutdown(_listenFd, SHUT_RDWR);
+    _acceptThread.join();
+    close(_listenFd);
+    _listenFd = -1;
+
+    std::unique_lock<std::mutex> lock(_connMutex);
+    for (int fd : _connFds) shutdown(fd, SHUT_RDWR);
+    _connDone.wait(lock, [this] { return _connFds.empty(); });
+}
+
+std::string Gateway::body() const {
+    std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
+    return snapshot ? snapshot->body : "";
+}
+
+std::string Gateway::etag() const {
+    std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
+    return snapshot ? snapshot->etag : "";
+}
+
+uint64_t Gateway::requests() const {
+    return _requests;
+}
+
+uint64_t Gateway::notModified() const {
+    return _notModified;
+}
+
+// ---------------------------------------------------------------------------
+// Private Helpers
+// ---------------------------------------------------------------------------
+
+void Gateway::_acceptLoop() {
+    while (_running) {
+        int fd = accept(_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (!_running) break;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            log_e("Gateway: accept: %s", strerror(errno));
+            break;
+        }
+
+        // Replies are one small write; don't let Nagle hold them back
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        // Connections come and go with every poll; their threads are
+        // detached and stop() waits for _connFds to drain instead
+        std::lock_guard<std::mutex> lock(_connMutex);
+        _connFds.push_back(fd);
+        std::thread(&Gateway::_serve, this, fd).detach();
+    }
+}
+
+void Gateway::_serve(int fd) {
+    std::string in;
+    std::string out;
+    char buffer[4096];
+    bool open = true;
+
+    while (open && _running) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        in.append(buffer, n);
+
+        // Answer every complete request in the buffer, in one write
+        size_t end;
+        while (open && (end = in.find("\r\n\r\n")) != std::string::npos) {
+            open = _respond(in.substr(0, end + 2), out);
+            in.erase(0, end + 4);
+        }
+        if (in.size() > GATEWAY_MAX_REQUEST) break;
+
+        if (!out.empty()) {
+            if (send(fd, out.data(), out.size(), MSG_NOSIGNAL) != (ssize_t)out.size()) break;
+            out.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_connMutex);
+    for (size_t i = 0; i < _connFds.size(); i++) {
+        if (_connFds[i] == fd) {
+            _connFds.erase(_connFds.begin() + i);
+            break;
+        }
+    }
+    close(fd);
+    _connDone.notify_all();
+}
+
+bool Gateway::_respond(const std::string& request, std::string& out) {
+    _requests++;
+
+    // Request line: METHOD SP target SP version
+    size_t methodEnd = request.find(' ');
+    std::string method = request.substr(0, methodEnd);
+    size_t lineEnd = request.find("\r\n");
+    bool http10 = lineEnd >= 8 && request.compare(lineEnd - 8, 8, "HTTP/1.0") == 0;
+    std::string connection = _header(request, "Connection");
+    bool keepAlive = http10 ? strcasecmp(connection.c_str(), "keep-alive") == 0
+                            : strcasecmp(connection.c_str(), "close") != 0;
+
+    std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&_snapshot);
+    const char* status;
+    std::string headers;
+    const std::string* body = nullptr;
+
+    if (method != "GET" && method != "HEAD") {
+        status = "405 Method Not Allowed";
+        headers = "Allow: GET, HEAD\r\nContent-Length: 0\r\n";
+    } else if (snapshot == nullptr) {
+        status = "503 Service Unavailable";
+        headers = "Retry-After: 5\r\nContent-Length: 0\r\n";
+    } else if (_header(request, "If-None-Match") == snapshot->etag) {
+        _notModified++;
+        status = "304 Not Modified";
+        headers = "ETag: " + snapshot->etag + "\r\n";
+    } else {
+        status = "200 OK";
+        headers = "Content-Type: application/json\r\nETag: " + snapshot->etag +
+                  "\r\nContent-Length: " + std::to_string(snapshot->body.size()) + "\r\n";
+        if (method == "GET") body = &snapshot->body;
+    }
+
+    out += http10 ? "HTTP/1.0 " : "HTTP/1.1 ";
+    out += status;
+    out += "\r\n";
+    out += headers;
+    if (!keepAlive) out += "Connection: close\r\n";
+    else if (http10) out += "Connection: keep-alive\r\n";
+    out += "\r\n";
+    if (body != nullptr) out += *body;
+    return keepAlive;
+}
+
+std::string Gateway::_header(const std::string& request, const char* name) {
+    size_t nameLength = strlen(name);
+    size_t line = request.find("\r\n");
+
+    while (line != std::string::npos && line + 2 < request.size()) {
+        size_t start = line + 2;
+        line = request.find("\r\n", start);
+        if (line == std::string::npos) break;
+        if (line - start > nameLength && request[start + nameLength] == ':' &&
+            strncasecmp(request.c_str() + start, name, nameLength) == 0) {
+            size_t value = start + nameLength + 1;
+            while (value < line && request[value] == ' ') value++;
+            return request.substr(value, line - value);
+        }
+    }
+    return "";
+}
+
+std::string Gateway::_etagOf(const std::string& body) {
+    // FNV-1a over the exact body
+    uint32_t hash = 2166136261u;
+    for (char c : body) hash = (hash ^ (uint8_t)c) * 16777619u;
+    char etag[16];
+    snprintf(etag, sizeof(etag), "\"%08x\"", hash);
+    return etag;
+}
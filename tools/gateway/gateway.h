@@ -0,0 +1,85 @@
+#ifndef GATEWAY_H
+#define GATEWAY_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parser.h"
+
+// ============================================================================
+// Gateway — Compute Once, Serve Many Meters From Cache
+// ============================================================================
+//
+// A host-side stand-in for the n8n workflow. refresh() runs a usage report
+// through the firmware's own Parser (token sums, computeCost) once per
+// interval and caches the webhook reply the meters expect, with a strong
+// ETag over the exact body. The HTTP server then answers every meter poll
+// from that cache: 200 with the body, or an empty 304 when the meter's
+// If-None-Match still matches. Before the first successful refresh it
+// answers 503.
+//
+// Parser is not reentrant, so only the refreshing thread calls it; server
+// threads see a snapshot that is swapped whole. One thread per connection,
+// keep-alive and pipelining supported, GET and HEAD only.
+
+class Gateway {
+public:
+    Gateway();
+    ~Gateway();
+
+    // Recompute the cached reply from a usage report (or webhook) body.
+    // False if it does not parse; the previous reply keeps being served.
+    bool refresh(const char* payload, size_t length);
+
+    // Serve on 127.0.0.1 (loopbackOnly) or every interface. Port 0 picks a
+    // free one. Returns the bound port, or -1.
+    int listen(uint16_t port, bool loopbackOnly = false);
+
+    // Close the listener and every connection, and wait for their threads
+    void stop();
+
+    // Cached reply (empty before the first refresh)
+    std::string body() const;
+    std::string etag() const;
+
+    // Counters since start
+    uint64_t requests() const;
+    uint64_t notModified() const;
+
+private:
+    struct Snapshot {
+        std::string body;
+        std::string etag;
+    };
+
+    std::shared_ptr<const Snapshot> _snapshot;   // std::atomic_load/store
+    float _previousCost;
+    bool _hasPrevious;
+
+    int _listenFd;
+    std::atomic<bool> _running;
+    std::thread _acceptThread;
+    std::mutex _connMutex;
+    std::condition_variable _connDone;
+    std::vector<int> _connFds;          // Open connections, one thread each
+
+    std::atomic<uint64_t> _requests;
+    std::atomic<uint64_t> _notModified;
+
+    void _acceptLoop();
+    void _serve(int fd);
+
+    // Append the response to one request; false if the connection closes
+    // after it
+    bool _respond(const std::string& request, std::string& out);
+
+    static std::string _header(const std::string& request, const char* name);
+    static std::string _etagOf(const std::string& body);
+};
+
+#endif // GATEWAY_H
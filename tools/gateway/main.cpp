@@ -0,0 +1,114 @@
+// ============================================================================
+// meter_gateway — Serve a Floor of Meters From One Upstream Poll
+// ============================================================================
+//
+//   ANTHROPIC_ADMIN_KEY=sk-ant-admin... meter_gateway [port] [url]
+//
+// Fetches the usage report once per POLL_INTERVAL_MS and serves the
+// computed reading to every meter that polls http://<host>:<port>/<any
+// path> (default port 8080). Without a url, the last 24 hourly buckets of
+// the Admin API usage report are requested; a url with a query string (or
+// a file:// url, handy for testing) is used as given. Point each meter's
+// webhook URL at the gateway instead of n8n.
+
+#include <Arduino.h>
+#include <curl/curl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "gateway.h"
+
+#define USAGE_REPORT_URL  "https://api.anthropic.com/v1/organizations/usage_report/messages"
+
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int) {
+    stopping = 1;
+}
+
+static size_t append(char* data, size_t size, size_t count, void* body) {
+    ((std::string*)body)->append(data, size * count);
+    return size * count;
+}
+
+// The last 24 hourly buckets, up to and including the current hour
+static std::string reportUrl(const char* url) {
+    if (strchr(url, '?') != nullptr || strncmp(url, "file://", 7) == 0) {
+        return url;
+    }
+    time_t from = time(nullptr) / 3600 * 3600 - 23 * 3600;
+    char startingAt[24];
+    strftime(startingAt, sizeof(startingAt), "%Y-%m-%dT%H:00:00Z", gmtime(&from));
+    return std::string(url) + "?bucket_width=1h&limit=24&starting_at=" + startingAt;
+}
+
+static bool fetch(CURL* curl, const std::string& url, const char* apiKey, std::string& body) {
+    std::string keyHeader = std::string("x-api-key: ") + apiKey;
+    curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, keyHeader.c_str());
+    headers = curl_slist_append(headers, "anthropic-version: 2023-06-01");
+
+    body.clear();
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");   // Whatever curl can inflate
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, (long)HTTP_TIMEOUT_MS);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, append);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &body);
+
+    CURLcode rc = curl_easy_perform(curl);
+    curl_slist_free_all(headers);
+    if (rc != CURLE_OK) {
+        log_e("Upstream: %s", curl_easy_strerror(rc));
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint16_t port = argc > 1 ? (uint16_t)atoi(argv[1]) : 8080;
+    const char* url = argc > 2 ? argv[2] : USAGE_REPORT_URL;
+    const char* apiKey = getenv("ANTHROPIC_ADMIN_KEY");
+    if (apiKey == nullptr && strncmp(url, "file://", 7) != 0) {
+        fprintf(stderr, "usage: ANTHROPIC_ADMIN_KEY=... %s [port] [url]\n", argv[0]);
+        return 2;
+    }
+
+    fake::useRealClock();
+    fake::logLevel = fake::LOG_INFO;
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    CURL* curl = curl_easy_init();
+
+    Gateway gateway;
+    if (gateway.listen(port) < 0) {
+        return 1;
+    }
+    log_i("Gateway: serving on port %u, refreshing every %lu s", port,
+          (unsigned long)(POLL_INTERVAL_MS / 1000));
+
+    std::string body;
+    unsigned long nextRefresh = millis();
+    while (!stopping) {
+        if ((long)(millis() - nextRefresh) >= 0) {
+            nextRefresh += POLL_INTERVAL_MS;
+            if (!fetch(curl, reportUrl(url), apiKey ? apiKey : "", body)) {
+                // Keep serving the last reading
+            } else if (!gateway.refresh(body.data(), body.size())) {
+                log_e("Upstream: %u-byte body does not parse", (unsigned)body.size());
+            }
+            log_i("Gateway: %llu requests, %llu not modified",
+                  (unsigned long long)gateway.requests(),
+                  (unsigned long long)gateway.notModified());
+        }
+        usleep(100000);   // The shim's delay() only advances simulated time
+    }
+
+    gateway.stop();
+    curl_easy_cleanup(curl);
+    curl_global_cleanup();
+    return 0;
+}
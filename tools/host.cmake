@@ -0,0 +1,16 @@
+# Claude Code Meter — Settings Shared by the Host Builds in tools/
+#
+#   include(${CMAKE_CURRENT_SOURCE_DIR}/../host.cmake)
+#
+# The firmware's ArduinoJson options, as [env:native] in platformio.ini
+# sets them. JSON_ARENA_SIZE follows that env's value (see the comment
+# there) so every 64-bit build runs out of arena at the same point.
+
+set(FIRMWARE ${CMAKE_CURRENT_LIST_DIR}/../firmware)
+
+set(HOST_JSON_ARENA_SIZE 32768)
+
+set(HOST_JSON_DEFINITIONS
+    ARDUINOJSON_ENABLE_COMMENTS=0
+    ARDUINOJSON_ENABLE_NAN=0
+    JSON_ARENA_SIZE=${HOST_JSON_ARENA_SIZE})